@@ -4,11 +4,11 @@ mkdir -p out
 make clean
 make
 
-./the_game --config 1p_config.txt > out/1p_simulation.out
-./the_game --config 2p_config.txt > out/2p_simulation.out
-./the_game --config 3p_config.txt > out/3p_simulation.out
-./the_game --config 4p_config.txt > out/4p_simulation.out
-./the_game --config 5p_config.txt > out/5p_simulation.out
+./the_game --config 1p_config.txt --summary out/1p_summary.txt --seed 1 --cache results.cache > out/1p_simulation.out
+./the_game --config 2p_config.txt --summary out/2p_summary.txt --seed 1 --cache results.cache > out/2p_simulation.out
+./the_game --config 3p_config.txt --summary out/3p_summary.txt --seed 1 --cache results.cache > out/3p_simulation.out
+./the_game --config 4p_config.txt --summary out/4p_summary.txt --seed 1 --cache results.cache > out/4p_simulation.out
+./the_game --config 5p_config.txt --summary out/5p_summary.txt --seed 1 --cache results.cache > out/5p_simulation.out
 
 sed -n '/Game Results/,$p' out/1p_simulation.out > out/1p_game_results.out
 sed -n '/Game Results/,$p' out/2p_simulation.out > out/2p_game_results.out
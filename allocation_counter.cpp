@@ -0,0 +1,153 @@
+#include "allocation_counter.h"
+#include "game_logic.h"
+#include "game_arena.h"
+#include "helper_functions.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace {
+
+// Calls of the global operator new made by this thread (constant-initialised, no TLS guard)
+thread_local long long thread_allocations = 0;
+
+void *counted_malloc(std::size_t size)
+{
+    ++thread_allocations;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+} // namespace
+
+// Replacements of the global allocation functions: the same as the default
+// ones, plus a per-thread count. The aligned overloads are left to the
+// library (nothing in the simulator over-aligns).
+void *operator new(std::size_t size)
+{
+    void *p = counted_malloc(size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_malloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_malloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Returns how many times the calling thread called the global operator new so far.
+ */
+long long thread_allocation_count()
+{
+    return thread_allocations;
+}
+
+/**
+ * @brief Plays the same decks with every strategy and prints the heap allocations made per game.
+ *
+ * The setups are dealt before counting and the output vectors are reused, so
+ * the count covers exactly what simulate_game_multiplayer and the strategies
+ * allocate. The first games grow the arena and the per-thread caches; the
+ * steady state is measured over the second half of the games and should be 0.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param num_players The number of players at the table.
+ * @param num_games The number of decks to play per strategy.
+ */
+void run_allocation_report(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games)
+{
+    if (num_games < 2)
+    {
+        std::cerr << "Error: The allocation report needs at least 2 games\n";
+        return;
+    }
+
+    std::vector<int> initial_deck = create_deck(config);
+    std::vector<GameSetup> setups;
+    setups.reserve(num_games);
+    for (int game = 0; game < num_games; ++game)
+    {
+        std::vector<int> game_deck = initial_deck;
+        shuffle(game_deck);
+        setups.push_back(setup_game(config, num_players, game_deck));
+    }
+
+    StrategyParams params = default_strategy_params(config);
+    // Outputs sized for the longest possible game, so that only the engine is measured
+    std::vector<std::vector<int>> final_playing_rows(config.number_of_rows);
+    std::vector<std::vector<int>> final_hand(num_players);
+    for (auto &row : final_playing_rows)
+    {
+        row.reserve(config.card_max_number);
+    }
+    for (auto &hand : final_hand)
+    {
+        hand.reserve(config.card_in_hands);
+    }
+
+    std::cout << num_players << " Players, allocations per game over " << num_games << " decks:\n";
+    for (auto const &[strategy_name, strategy_func] : strategies)
+    {
+        std::vector<StrategyFunction> seat_strategies(num_players, strategy_func);
+        long long first_game = 0, steady_total = 0, steady_max = 0;
+        for (int game = 0; game < num_games; ++game)
+        {
+            int turns = 0;
+            long long before = thread_allocation_count();
+            simulate_game_multiplayer(config, seat_strategies, setups[game], params, turns, final_playing_rows, final_hand);
+            long long allocations = thread_allocation_count() - before;
+
+            if (game == 0)
+            {
+                first_game = allocations;
+            }
+            if (game >= num_games / 2)
+            {
+                steady_total += allocations;
+                steady_max = std::max(steady_max, allocations);
+            }
+        }
+        int steady_games = num_games - num_games / 2;
+        std::cout << strategy_name << ": " << first_game << " allocations in the first game, "
+                  << static_cast<double>(steady_total) / steady_games << " per game in steady state (max "
+                  << steady_max << " over the last " << steady_games << " games)\n";
+    }
+    std::cout << "Game arena: " << thread_game_arena().capacity() / 1024 << " KiB per thread\n";
+}
@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+long long thread_allocation_count();
+void run_allocation_report(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games);
+
+#endif
@@ -0,0 +1,85 @@
+// Strategies A1, A2, E1, E2, H1 and H2 as a plugin (libthegame_builtin.so).
+// Built from the same player_strategies.cpp as the simulator, so a plugin run
+// plays exactly like the in-binary strategies.
+
+#include "strategy_plugin.h"
+#include "game_config.h"
+#include "player_strategies.h"
+
+#include <memory_resource>
+
+namespace {
+
+GameConfig rules_config; // Rules of the run, set once by init
+
+const char *const STRATEGY_NAMES[] = {"A1", "A2", "E1", "E2", "H1", "H2"};
+const StrategyFunction STRATEGIES[] = {get_player_move_A1, get_player_move_A2, get_player_move_E1,
+                                       get_player_move_E2, get_player_move_H1, get_player_move_H2};
+const int32_t NUM_STRATEGIES = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+
+int32_t init(const thegame_rules *rules)
+{
+    GameConfig config;
+    config.card_max_number = rules->card_max_number;
+    config.reverse_move_diff = rules->reverse_move_diff;
+    config.card_in_hands = rules->card_in_hands;
+    config.num_cards_to_play = rules->num_cards_to_play;
+    config.number_of_rows = rules->number_of_rows;
+    config.good_move_window = rules->good_move_window;
+    config.number_of_players = 1; // Not part of the rules
+    std::string error;
+    if (!validate_game_config(config, error))
+    {
+        return 1;
+    }
+    rules_config = config;
+    return 0;
+}
+
+void decide_batch(int32_t strategy, const thegame_params *params, const thegame_decision_request *requests,
+                  int32_t count, thegame_decision *decisions)
+{
+    // State handed to the strategies, reused across the batch
+    static thread_local std::byte buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource memory(buffer, sizeof(buffer));
+    // Scratch of the strategies, released after every decision
+    static thread_local std::byte scratch_buffer[16 * 1024];
+
+    StrategyParams strategy_params{params->claimed_row_penalty, params->panic_threshold, params->good_move_window};
+    Hand hand(&memory);
+    PlayingRows playing_rows(rules_config.number_of_rows, &memory);
+    Communications communications(&memory);
+    for (auto &row : playing_rows)
+    {
+        row.resize(1); // Strategies only look at the top of a row
+    }
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const thegame_decision_request &request = requests[i];
+        hand.assign(request.hand, request.hand + request.hand_size);
+        for (int r = 0; r < rules_config.number_of_rows; ++r)
+        {
+            playing_rows[r][0] = request.row_tops[r];
+        }
+        communications.clear();
+        for (int32_t c = 0; c < request.num_communications; ++c)
+        {
+            const thegame_communication &comm = request.communications[c];
+            communications.push_back({comm.player_id, comm.row_index, static_cast<Communication::CommType>(comm.type), comm.relative_value});
+        }
+        std::pmr::monotonic_buffer_resource scratch(scratch_buffer, sizeof(scratch_buffer));
+        StrategyContext context{rules_config, strategy_params, nullptr, &scratch};
+        std::pair<int, int> move = STRATEGIES[strategy](hand, playing_rows, communications, request.player_id, context);
+        decisions[i] = {move.first, move.second};
+    }
+}
+
+const thegame_plugin PLUGIN = {THEGAME_PLUGIN_ABI_VERSION, "builtin", NUM_STRATEGIES, STRATEGY_NAMES, init, decide_batch};
+
+} // namespace
+
+extern "C" __attribute__((visibility("default"))) const thegame_plugin *thegame_get_plugin(void)
+{
+    return &PLUGIN;
+}
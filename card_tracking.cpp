@@ -0,0 +1,204 @@
+#include "card_tracking.h"
+#include "game_config.h"
+
+#include <algorithm>
+#include <utility> // std::swap
+
+namespace {
+
+inline void clear_bit(uint64_t *bits, int card)
+{
+    bits[card >> 6] &= ~(uint64_t{1} << (card & 63));
+}
+
+inline bool test_bit(const uint64_t *bits, int card)
+{
+    return (bits[card >> 6] >> (card & 63)) & 1u;
+}
+
+} // namespace
+
+CardTracker::CardTracker(std::pmr::memory_resource *memory)
+    : unseen_(memory), unseen_counts_(memory), unseen_before_(memory), played_(memory)
+{
+}
+
+/**
+ * @brief Starts tracking a freshly dealt game: each player has seen its own hand only.
+ *
+ * @param config The config of the game (kept for the queries).
+ * @param hands The dealt hands, indexed by player id.
+ * @param deck_size The number of cards in the draw pile.
+ */
+void CardTracker::start_game(const GameConfig &config, const std::vector<std::vector<int>> &hands, int deck_size)
+{
+    int num_players = hands.size();
+    config_ = &config;
+    words_ = config.card_max_number / 64 + 1;
+    deck_size_ = deck_size;
+    played_.assign(words_, 0);
+    unseen_.assign(static_cast<size_t>(num_players) * words_, 0);
+    unseen_counts_.assign(num_players, 0);
+    unseen_before_.assign(static_cast<size_t>(num_players) * (words_ + 1), 0);
+
+    for (int p = 0; p < num_players; ++p)
+    {
+        uint64_t *bits = &unseen_[static_cast<size_t>(p) * words_];
+        for (int card = 2; card < config.card_max_number; ++card)
+        {
+            bits[card >> 6] |= uint64_t{1} << (card & 63);
+        }
+        for (int card : hands[p])
+        {
+            clear_bit(bits, card);
+        }
+        unseen_counts_[p] = config.card_max_number - 2 - static_cast<int>(hands[p].size());
+        int *before = &unseen_before_[static_cast<size_t>(p) * (words_ + 1)];
+        for (int w = 0; w < words_; ++w)
+        {
+            before[w + 1] = before[w] + __builtin_popcountll(bits[w]);
+        }
+    }
+}
+
+// Clears an unseen card of a player, and its count in the words after it
+void CardTracker::mark_seen(int player, int card)
+{
+    uint64_t *bits = &unseen_[static_cast<size_t>(player) * words_];
+    if (!test_bit(bits, card))
+    {
+        return;
+    }
+    clear_bit(bits, card);
+    unseen_counts_[player]--;
+    int *before = &unseen_before_[static_cast<size_t>(player) * (words_ + 1)];
+    for (int w = (card >> 6) + 1; w <= words_; ++w)
+    {
+        before[w]--;
+    }
+}
+
+/**
+ * @brief Records a card played on a row: every player has now seen it.
+ *
+ * @param card The card played.
+ */
+void CardTracker::card_played(int card)
+{
+    played_[card >> 6] |= uint64_t{1} << (card & 63);
+    for (size_t p = 0; p < unseen_counts_.size(); ++p)
+    {
+        mark_seen(static_cast<int>(p), card);
+    }
+}
+
+/**
+ * @brief Records a card drawn from the pile: only the drawing player has seen it.
+ *
+ * @param player The player who drew the card.
+ * @param card The card drawn.
+ */
+void CardTracker::card_drawn(int player, int card)
+{
+    mark_seen(player, card);
+    deck_size_--;
+}
+
+bool CardTracker::is_unseen(int player, int card) const
+{
+    if (card < 2 || card >= config_->card_max_number)
+    {
+        return false;
+    }
+    return test_bit(&unseen_[static_cast<size_t>(player) * words_], card);
+}
+
+bool CardTracker::is_played(int card) const
+{
+    if (card < 2 || card >= config_->card_max_number)
+    {
+        return false;
+    }
+    return test_bit(played_.data(), card);
+}
+
+int CardTracker::unseen_count(int player) const
+{
+    return unseen_counts_[player];
+}
+
+int CardTracker::deck_size() const
+{
+    return deck_size_;
+}
+
+/**
+ * @brief Counts the cards strictly between two values that the player has not seen yet.
+ *
+ * @param player The player whose knowledge is queried.
+ * @param low The lower bound (excluded), in either order with high.
+ * @param high The upper bound (excluded).
+ * @return The number of unseen cards in the open interval.
+ */
+int CardTracker::count_unseen_between(int player, int low, int high) const
+{
+    if (low > high)
+    {
+        std::swap(low, high);
+    }
+    int first = std::max(low + 1, 0), end = std::min(high, words_ * 64); // [first, end)
+    return first < end ? unseen_below(player, end) - unseen_below(player, first) : 0;
+}
+
+/**
+ * @brief Returns the card that would make a reverse trick on a row, or -1 if no such card exists.
+ *
+ * @param row The row index (the first half of the rows ascends).
+ * @param row_top The current top card of the row.
+ * @return The card reverse_move_diff behind the top, or -1.
+ */
+int CardTracker::reverse_card(int row, int row_top) const
+{
+    int card = row < config_->number_of_rows / 2 ? row_top - config_->reverse_move_diff : row_top + config_->reverse_move_diff;
+    return card >= 2 && card < config_->card_max_number ? card : -1;
+}
+
+/**
+ * @brief Probability, for one player, that the reverse card of a row is in a hand right now.
+ *
+ * The card is certainly there if the player holds it and certainly gone if it
+ * was played. An unseen card is equally likely to be any of the unseen
+ * positions, so it sits in another player's hand (and can still rescue the
+ * row this round) with probability (unseen - draw pile) / unseen.
+ *
+ * @param player The player whose knowledge is used.
+ * @param row The row index.
+ * @param row_top The current top card of the row.
+ * @return The probability, between 0 and 1.
+ */
+double CardTracker::reverse_card_live_probability(int player, int row, int row_top) const
+{
+    int card = reverse_card(row, row_top);
+    if (card == -1 || is_played(card))
+    {
+        return 0.0;
+    }
+    if (!is_unseen(player, card))
+    {
+        return 1.0; // In the player's own hand
+    }
+    int unseen = unseen_counts_[player];
+    return unseen > 0 ? static_cast<double>(unseen - deck_size_) / unseen : 0.0;
+}
+
+// Unseen cards of a player below a card (0 <= card <= words_ * 64)
+int CardTracker::unseen_below(int player, int card) const
+{
+    int word = card >> 6;
+    int count = unseen_before_[static_cast<size_t>(player) * (words_ + 1) + word];
+    if (word < words_ && (card & 63) != 0)
+    {
+        count += __builtin_popcountll(unseen_[static_cast<size_t>(player) * words_ + word] & (~uint64_t{0} >> (64 - (card & 63))));
+    }
+    return count;
+}
@@ -0,0 +1,52 @@
+#ifndef CARD_TRACKING_H
+#define CARD_TRACKING_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+struct GameConfig;
+
+/**
+ * @brief What every player knows about the cards, kept up to date by the engine.
+ *
+ * Plays are public, so a card a player has not seen is either in another
+ * player's hand or in the draw pile. The tracker keeps one "unseen" bitset
+ * per player plus a bitset of the played cards: a play clears one bit per
+ * player, a draw clears one bit of the drawing player, and no query ever
+ * rescans the rows. Each player also keeps the unseen count below every
+ * 64-bit word, so a range count is two lookups and two masked popcounts
+ * whatever the number of cards.
+ */
+class CardTracker
+{
+public:
+    explicit CardTracker(std::pmr::memory_resource *memory = std::pmr::get_default_resource());
+
+    void start_game(const GameConfig &config, const std::vector<std::vector<int>> &hands, int deck_size);
+    void card_played(int card);
+    void card_drawn(int player, int card);
+
+    bool is_unseen(int player, int card) const;
+    bool is_played(int card) const;
+    int unseen_count(int player) const;
+    int count_unseen_between(int player, int low, int high) const;
+    int deck_size() const;
+
+    int reverse_card(int row, int row_top) const;
+    double reverse_card_live_probability(int player, int row, int row_top) const;
+
+private:
+    const GameConfig *config_ = nullptr;
+    int words_ = 0;                      // 64-bit words per bitset
+    int deck_size_ = 0;                  // Cards left in the draw pile
+    std::pmr::vector<uint64_t> unseen_;  // [player * words_ + word], bit set = not seen by the player
+    std::pmr::vector<int> unseen_counts_;
+    std::pmr::vector<int> unseen_before_; // [player * (words_ + 1) + word], unseen cards in the words before
+    std::pmr::vector<uint64_t> played_;   // Bit set = played on a row
+
+    void mark_seen(int player, int card);
+    int unseen_below(int player, int card) const;
+};
+
+#endif
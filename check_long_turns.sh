@@ -0,0 +1,26 @@
+# Regression check: with NUM_CARDS_TO_PLAY 5 a turn is longer than the
+# sequences the whole-turn planners search (MAX_TURN_SEQUENCE), yet every
+# strategy must still play its turns in full. A strategy whose lost games
+# end within the first turn fails the check.
+set -e
+
+config=$(mktemp)
+summary=$(mktemp)
+trap 'rm -f "$config" "$summary"' EXIT
+
+cat > "$config" <<END
+CARD_MAX_NUMBER 100
+REVERSE_MOVE_DIFF 10
+CARD_IN_HANDS 8
+NUM_CARDS_TO_PLAY 5
+NUMBER_OF_ROWS 4
+NUMBER_OF_PLAYERS 1
+GOOD_MOVE_WINDOW 5
+NUM_SIMULATIONS 200
+END
+
+./the_game --config "$config" --seed 1 --output /dev/null --progress 0 --summary "$summary" > /dev/null
+
+# strategy <name> <wins> <lost games> <average cards played when losing> <average deck size when losing>
+awk '$1 == "strategy" && $4 > 0 && $5 <= 5 { print "FAIL: strategy " $2 " loses on its first turn"; failed = 1 }
+     END { if (!failed) print "OK: every strategy plays turns of 5 cards"; exit failed }' "$summary"
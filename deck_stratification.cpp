@@ -0,0 +1,422 @@
+#include "deck_stratification.h"
+#include "game_logic.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+const int NUM_FEATURES = 3;
+const double CI_Z = 1.96; // 95% confidence intervals
+
+// Win and cards-played outcome of every strategy on a list of decks ([deck * strategies + strategy]).
+struct DeckOutcomes
+{
+    std::vector<char> wins;
+    std::vector<int> cards;
+};
+
+// Plays every strategy (all seats) on every deck, sharing the deal and seat order per deck.
+void play_decks(const GameConfig &config, const std::vector<StrategyFunction> &functions, int num_players, const std::vector<std::vector<int>> &decks, int num_threads, DeckOutcomes &outcomes)
+{
+    const int num_strategies = functions.size();
+    outcomes.wins.assign(decks.size() * num_strategies, 0);
+    outcomes.cards.assign(decks.size() * num_strategies, 0);
+    StrategyParams params = default_strategy_params(config);
+
+    parallel_for_chunks(decks.size(), num_threads, [&](int begin, int end, int) {
+        std::vector<std::vector<int>> final_playing_rows;
+        std::vector<std::vector<int>> final_hand;
+        for (int d = begin; d < end; ++d)
+        {
+            GameSetup setup = setup_game(config, num_players, decks[d]);
+            for (int s = 0; s < num_strategies; ++s)
+            {
+                std::vector<StrategyFunction> seat_strategies(num_players, functions[s]);
+                int turns = 0;
+                outcomes.wins[d * num_strategies + s] = simulate_game_multiplayer(config, seat_strategies, setup, params, turns, final_playing_rows, final_hand);
+                outcomes.cards[d * num_strategies + s] = turns;
+            }
+        }
+    });
+}
+
+// Solves the least-squares fit y ~ b0 + b . x with the normal equations (Gaussian elimination).
+std::vector<double> fit_linear(const std::vector<DeckFeatures> &features, const std::vector<double> &targets)
+{
+    const int n = NUM_FEATURES + 1;
+    std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+    for (size_t d = 0; d < features.size(); ++d)
+    {
+        double x[NUM_FEATURES + 1] = {1.0, features[d].early_spread, features[d].hand_clustering, features[d].reverse_pairs};
+        for (int r = 0; r < n; ++r)
+        {
+            for (int c = 0; c < n; ++c)
+            {
+                a[r][c] += x[r] * x[c];
+            }
+            a[r][n] += x[r] * targets[d];
+        }
+    }
+    for (int r = 0; r < n; ++r)
+    {
+        a[r][r] += 1e-9; // Keeps the system solvable when a feature is constant
+    }
+    for (int col = 0; col < n; ++col)
+    {
+        int pivot = col;
+        for (int r = col + 1; r < n; ++r)
+        {
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col]))
+            {
+                pivot = r;
+            }
+        }
+        std::swap(a[col], a[pivot]);
+        for (int r = 0; r < n; ++r)
+        {
+            if (r != col && a[col][col] != 0.0)
+            {
+                double factor = a[r][col] / a[col][col];
+                for (int c = col; c <= n; ++c)
+                {
+                    a[r][c] -= factor * a[col][c];
+                }
+            }
+        }
+    }
+    std::vector<double> coefficients(n, 0.0);
+    for (int r = 0; r < n; ++r)
+    {
+        coefficients[r] = a[r][r] != 0.0 ? a[r][n] / a[r][r] : 0.0;
+    }
+    return coefficients;
+}
+
+double predict(const std::vector<double> &coefficients, const DeckFeatures &features)
+{
+    return coefficients[0] + coefficients[1] * features.early_spread + coefficients[2] * features.hand_clustering +
+           coefficients[3] * features.reverse_pairs;
+}
+
+// Index of the stratum of a predicted score, given the ascending upper boundaries of all strata but the last.
+int stratum_of(double score, const std::vector<double> &boundaries)
+{
+    return std::upper_bound(boundaries.begin(), boundaries.end(), score) - boundaries.begin();
+}
+
+std::vector<int> new_shuffled_deck(const std::vector<int> &initial_deck)
+{
+    std::vector<int> deck = initial_deck;
+    shuffle(deck);
+    return deck;
+}
+
+// Per-stratum sample mean and variance of one outcome.
+struct StratumMoments
+{
+    int count = 0;
+    double mean = 0.0;
+    double variance = 0.0;
+};
+
+StratumMoments moments_of(const std::vector<double> &values)
+{
+    StratumMoments m;
+    m.count = values.size();
+    for (double v : values)
+    {
+        m.mean += v;
+    }
+    m.mean = m.count > 0 ? m.mean / m.count : 0.0;
+    for (double v : values)
+    {
+        m.variance += (v - m.mean) * (v - m.mean);
+    }
+    m.variance = m.count > 1 ? m.variance / (m.count - 1) : 0.0;
+    return m;
+}
+
+// Stratified estimate of a mean and its variance, plus the variance plain sampling would have with the same n.
+struct StratifiedEstimate
+{
+    double mean = 0.0;
+    double variance = 0.0;
+    double plain_variance = 0.0;
+};
+
+StratifiedEstimate estimate(const std::vector<StratumMoments> &strata, const std::vector<double> &weights, int total)
+{
+    StratifiedEstimate e;
+    for (size_t h = 0; h < strata.size(); ++h)
+    {
+        e.mean += weights[h] * strata[h].mean;
+        if (strata[h].count > 0)
+        {
+            e.variance += weights[h] * weights[h] * strata[h].variance / strata[h].count;
+        }
+    }
+    // Population variance = within-strata + between-strata parts
+    double population_variance = 0.0;
+    for (size_t h = 0; h < strata.size(); ++h)
+    {
+        population_variance += weights[h] * (strata[h].variance + (strata[h].mean - e.mean) * (strata[h].mean - e.mean));
+    }
+    e.plain_variance = population_variance / total;
+    return e;
+}
+
+} // namespace
+
+/**
+ * @brief Computes the hardness features of a deck from the cards dealt and drawn first.
+ *
+ * Only the back of the deck is looked at: the cards setup_game deals to the
+ * players and the first round of draws.
+ *
+ * @param config The game config (hand size, cards per turn, reverse difference).
+ * @param deck The shuffled deck (dealt from the back).
+ * @param num_players The number of players at the table.
+ * @return The deck's features.
+ */
+DeckFeatures compute_deck_features(const GameConfig &config, const std::vector<int> &deck, int num_players)
+{
+    DeckFeatures features = {0.0, 0.0, 0.0};
+    int dealt = std::min<int>(deck.size(), num_players * config.card_in_hands);
+    int early = std::min<int>(deck.size(), dealt + num_players * config.num_cards_to_play);
+    if (dealt == 0)
+    {
+        return features;
+    }
+
+    // Spread of the dealt cards
+    double mean = 0.0;
+    for (int k = 0; k < dealt; ++k)
+    {
+        mean += deck[deck.size() - 1 - k];
+    }
+    mean /= dealt;
+    for (int k = 0; k < dealt; ++k)
+    {
+        double diff = deck[deck.size() - 1 - k] - mean;
+        features.early_spread += diff * diff;
+    }
+    features.early_spread = std::sqrt(features.early_spread / dealt);
+
+    // Clustering: average gap between neighbouring cards of each dealt hand
+    int gaps = 0;
+    for (int p = 0; p * config.card_in_hands < dealt; ++p)
+    {
+        std::vector<int> hand;
+        for (int k = p * config.card_in_hands; k < std::min(dealt, (p + 1) * config.card_in_hands); ++k)
+        {
+            hand.push_back(deck[deck.size() - 1 - k]);
+        }
+        std::sort(hand.begin(), hand.end());
+        for (size_t k = 1; k < hand.size(); ++k)
+        {
+            features.hand_clustering += hand[k] - hand[k - 1];
+            gaps++;
+        }
+    }
+    features.hand_clustering = gaps > 0 ? features.hand_clustering / gaps : 0.0;
+
+    // Reverse-trick pairs among the early cards
+    for (int a = 0; a < early; ++a)
+    {
+        for (int b = a + 1; b < early; ++b)
+        {
+            if (std::abs(deck[deck.size() - 1 - a] - deck[deck.size() - 1 - b]) == config.reverse_move_diff)
+            {
+                features.reverse_pairs += 1.0;
+            }
+        }
+    }
+    return features;
+}
+
+/**
+ * @brief Estimates win rates with decks stratified by a predicted hardness score.
+ *
+ * 1. A plain pilot sample is played and the mean number of cards played is
+ *    regressed on the deck features, giving a hardness score per deck.
+ * 2. The score quantiles of feature_samples fresh decks (no game played) give
+ *    the strata boundaries and their weights W_h.
+ * 3. The remaining decks are allocated to strata in proportion to W_h times
+ *    the outcome standard deviation seen in the pilot (Neyman allocation;
+ *    cards played is used when the pilot had no win) and drawn by rejection.
+ * The estimate sum_h W_h * mean_h is unbiased for any allocation; the report
+ * compares its variance with plain sampling of the same number of decks.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param options The sampling settings.
+ */
+void run_stratified_sampling(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const StratificationOptions &options)
+{
+    std::vector<std::string> names;
+    std::vector<StrategyFunction> functions;
+    for (auto const &[name, func] : strategies)
+    {
+        names.push_back(name);
+        functions.push_back(func);
+    }
+    const int num_strategies = functions.size();
+    const int num_strata = std::max(1, options.num_strata);
+    std::vector<int> initial_deck = create_deck(config);
+
+    // --- 1. Pilot sample and hardness model ---
+    int pilot_size = std::max(num_strata * 20, static_cast<int>(options.num_games * options.pilot_share));
+    pilot_size = std::min(pilot_size, options.num_games);
+    std::vector<std::vector<int>> decks;
+    for (int d = 0; d < pilot_size; ++d)
+    {
+        decks.push_back(new_shuffled_deck(initial_deck));
+    }
+    DeckOutcomes outcomes;
+    play_decks(config, functions, options.num_players, decks, options.num_threads, outcomes);
+
+    std::vector<DeckFeatures> features;
+    std::vector<double> mean_cards;
+    for (int d = 0; d < pilot_size; ++d)
+    {
+        features.push_back(compute_deck_features(config, decks[d], options.num_players));
+        double sum = 0.0;
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            sum += outcomes.cards[d * num_strategies + s];
+        }
+        mean_cards.push_back(sum / num_strategies);
+    }
+    std::vector<double> coefficients = fit_linear(features, mean_cards);
+
+    // --- 2. Strata boundaries and weights from feature-only decks ---
+    std::vector<double> scores;
+    for (int d = 0; d < options.feature_samples; ++d)
+    {
+        scores.push_back(predict(coefficients, compute_deck_features(config, new_shuffled_deck(initial_deck), options.num_players)));
+    }
+    std::sort(scores.begin(), scores.end());
+    std::vector<double> boundaries;
+    for (int h = 1; h < num_strata; ++h)
+    {
+        boundaries.push_back(scores[scores.size() * h / num_strata]);
+    }
+    std::vector<double> weights(num_strata, 0.0);
+    for (double score : scores)
+    {
+        weights[stratum_of(score, boundaries)] += 1.0 / scores.size();
+    }
+
+    std::vector<int> deck_stratum;
+    std::vector<int> stratum_count(num_strata, 0);
+    for (int d = 0; d < pilot_size; ++d)
+    {
+        deck_stratum.push_back(stratum_of(predict(coefficients, features[d]), boundaries));
+        stratum_count[deck_stratum.back()]++;
+    }
+
+    // --- 3. Neyman allocation of the remaining decks ---
+    bool pilot_has_wins = std::find(outcomes.wins.begin(), outcomes.wins.end(), 1) != outcomes.wins.end();
+    std::vector<double> stratum_sd(num_strata, 0.0);
+    for (int h = 0; h < num_strata; ++h)
+    {
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            std::vector<double> values;
+            for (int d = 0; d < pilot_size; ++d)
+            {
+                if (deck_stratum[d] == h)
+                {
+                    values.push_back(pilot_has_wins ? outcomes.wins[d * num_strategies + s] : outcomes.cards[d * num_strategies + s]);
+                }
+            }
+            stratum_sd[h] += std::sqrt(moments_of(values).variance) / num_strategies;
+        }
+    }
+    double total_allocation_weight = 0.0;
+    for (int h = 0; h < num_strata; ++h)
+    {
+        total_allocation_weight += weights[h] * stratum_sd[h];
+    }
+    std::vector<int> still_needed(num_strata, 0);
+    int to_draw = 0;
+    for (int h = 0; h < num_strata; ++h)
+    {
+        double share = total_allocation_weight > 0.0 ? weights[h] * stratum_sd[h] / total_allocation_weight : weights[h];
+        int target = weights[h] > 0.0 ? std::max(2, static_cast<int>(std::lround(share * options.num_games))) : 0;
+        still_needed[h] = std::max(0, target - stratum_count[h]);
+        to_draw += still_needed[h];
+    }
+
+    std::vector<std::vector<int>> new_decks;
+    long long rejected = 0;
+    while (static_cast<int>(new_decks.size()) < to_draw)
+    {
+        std::vector<int> deck = new_shuffled_deck(initial_deck);
+        int h = stratum_of(predict(coefficients, compute_deck_features(config, deck, options.num_players)), boundaries);
+        if (still_needed[h] == 0)
+        {
+            rejected++;
+            continue;
+        }
+        still_needed[h]--;
+        stratum_count[h]++;
+        deck_stratum.push_back(h);
+        new_decks.push_back(deck);
+    }
+    DeckOutcomes new_outcomes;
+    play_decks(config, functions, options.num_players, new_decks, options.num_threads, new_outcomes);
+    outcomes.wins.insert(outcomes.wins.end(), new_outcomes.wins.begin(), new_outcomes.wins.end());
+    outcomes.cards.insert(outcomes.cards.end(), new_outcomes.cards.begin(), new_outcomes.cards.end());
+    const int total_decks = deck_stratum.size();
+
+    // --- 4. Report ---
+    std::cout << options.num_players << " Players, stratified sampling: " << num_strata << " strata by predicted cards played, "
+              << pilot_size << " pilot decks, " << total_decks << " decks in total, " << rejected << " decks rejected, "
+              << options.feature_samples << " feature-only decks\n";
+    std::cout << "  Hardness model: cards = " << coefficients[0] << " + " << coefficients[1] << " x spread + "
+              << coefficients[2] << " x clustering + " << coefficients[3] << " x reverse pairs\n";
+    for (int h = 0; h < num_strata; ++h)
+    {
+        std::cout << "  Stratum " << h + 1 << ": weight " << weights[h] << ", " << stratum_count[h] << " decks\n";
+    }
+
+    for (int s = 0; s < num_strategies; ++s)
+    {
+        std::vector<StratumMoments> win_moments, card_moments;
+        for (int h = 0; h < num_strata; ++h)
+        {
+            std::vector<double> wins, cards;
+            for (int d = 0; d < total_decks; ++d)
+            {
+                if (deck_stratum[d] == h)
+                {
+                    wins.push_back(outcomes.wins[d * num_strategies + s]);
+                    cards.push_back(outcomes.cards[d * num_strategies + s]);
+                }
+            }
+            win_moments.push_back(moments_of(wins));
+            card_moments.push_back(moments_of(cards));
+        }
+        StratifiedEstimate win = estimate(win_moments, weights, total_decks);
+        StratifiedEstimate card = estimate(card_moments, weights, total_decks);
+        double half_width = CI_Z * std::sqrt(win.variance);
+
+        std::cout << names[s] << " win rate: " << win.mean * 100 << " % (95% CI " << std::max(0.0, win.mean - half_width) * 100
+                  << " - " << (win.mean + half_width) * 100 << " %), variance reduction ";
+        if (win.variance > 0.0)
+            std::cout << "x" << win.plain_variance / win.variance;
+        else
+            std::cout << "n/a";
+        std::cout << "; cards played " << card.mean << ", variance reduction ";
+        if (card.variance > 0.0)
+            std::cout << "x" << card.plain_variance / card.variance << "\n";
+        else
+            std::cout << "n/a\n";
+    }
+}
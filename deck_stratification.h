@@ -0,0 +1,33 @@
+#ifndef DECK_STRATIFICATION_H
+#define DECK_STRATIFICATION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+// Cheap per-deck statistics computed before any game is played on the deck.
+struct DeckFeatures
+{
+    double early_spread;    // Standard deviation of the cards dealt at the start
+    double hand_clustering; // Average gap between consecutive sorted cards of the dealt hands
+    double reverse_pairs;   // Pairs reverse_move_diff apart among the dealt and first drawn cards
+};
+
+// Settings of the `stratified` mode.
+struct StratificationOptions
+{
+    int num_players;     // Players at the table, all using the same strategy
+    int num_games;       // Total number of decks to simulate (pilot included)
+    double pilot_share;  // Share of num_games played as a plain pilot sample
+    int num_strata;      // Number of hardness strata
+    int feature_samples; // Decks used (features only, no game) to measure the stratum weights
+    int num_threads;     // Worker threads
+};
+
+DeckFeatures compute_deck_features(const GameConfig &config, const std::vector<int> &deck, int num_players);
+void run_stratified_sampling(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const StratificationOptions &options);
+
+#endif
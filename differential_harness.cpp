@@ -0,0 +1,459 @@
+#include "differential_harness.h"
+#include "card_tracking.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "helper_functions.h"
+#include "large_variant.h"
+#include "lockstep_engine.h"
+#include "parallel.h"
+#include "reference_engine.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// The engines compared with the reference (play_baseline_game, else play_reference_game)
+enum class Engine
+{
+    REFERENCE,
+    SIMULATE,
+    SNAPSHOT,
+    LOCKSTEP,
+    LARGE
+};
+
+const Engine CANDIDATE_ENGINES[] = {Engine::SIMULATE, Engine::SNAPSHOT, Engine::LOCKSTEP, Engine::LARGE};
+
+const char *engine_name(Engine engine)
+{
+    switch (engine)
+    {
+    case Engine::REFERENCE: return "reference";
+    case Engine::SIMULATE: return "simulate";
+    case Engine::SNAPSHOT: return "snapshot";
+    case Engine::LOCKSTEP: return "lockstep";
+    case Engine::LARGE: return "large";
+    }
+    return "";
+}
+
+// Strategies that need the card tracker or whole-turn plans, which the plugin interface of the lockstep engine does not carry
+bool needs_tracker_or_plan(const std::string &strategy_name)
+{
+    return strategy_name == "J" || strategy_name == "K" || strategy_name == "T";
+}
+
+// The large engine has A1 and A2 built in, the lockstep engine plays what the plugin interface can express; the others play any strategy
+bool engine_plays(Engine engine, const std::string &strategy_name, const StrategyParams &params)
+{
+    switch (engine)
+    {
+    case Engine::LARGE: return (strategy_name == "A1" || strategy_name == "A2") && params.claimed_row_penalty >= 1;
+    case Engine::LOCKSTEP: return !needs_tracker_or_plan(strategy_name);
+    default: return true;
+    }
+}
+
+// Plays a snapshot game with the card tracker and whole-turn plans, as the reference engine does; true if won
+bool play_snapshot_game(const GameConfig &config, const GameSetup &setup, StrategyFunction strategy, const StrategyParams &params, GameRecord *record)
+{
+    GameSnapshot game;
+    start_snapshot(config, setup, game);
+    CardTracker cards;
+    cards.start_game(config, setup.hands, setup.deck.size());
+    SnapshotTurnPlan plan;
+    if (record != nullptr)
+    {
+        record->moves.clear();
+    }
+    while (!game.finished)
+    {
+        std::pair<int, int> move = decide_snapshot_move(config, game, strategy, params, &cards, plan);
+        if (record != nullptr && move.first != -1)
+        {
+            int player = current_snapshot_player(game);
+            record->moves.push_back({player, game.hands[player][move.first], move.second});
+        }
+        apply_snapshot_move(config, game, move, &cards);
+    }
+    if (record == nullptr)
+    {
+        return game.won;
+    }
+    record->hands.resize(game.num_players);
+    for (int p = 0; p < game.num_players; ++p)
+    {
+        record->hands[p].assign(game.hands[p], game.hands[p] + game.hand_sizes[p]);
+    }
+    if (!game.won)
+    {
+        // Only a failed turn loses: its player is still the current one
+        record->hands[current_snapshot_player(game)].assign(game.turn_start_hand, game.turn_start_hand + game.turn_start_hand_size);
+    }
+    record->row_tops.assign(game.row_tops, game.row_tops + config.number_of_rows);
+    record->turns = game.turns;
+    record->deck_size = game.deck_size;
+    record->won = game.won;
+    return game.won;
+}
+
+/**
+ * @brief Plays setups[begin, end) with one engine, every seat using the strategy.
+ *
+ * @param records (Output, optional) The full record of every game, indexed from begin.
+ * @return The number of games won.
+ */
+int play_games(Engine engine, const GameConfig &config, StrategyFunction strategy, const std::string &strategy_name, const StrategyParams &params,
+               const std::vector<GameSetup> &setups, int begin, int end, std::vector<GameRecord> *records)
+{
+    int wins = 0;
+    if (records != nullptr)
+    {
+        records->resize(end - begin);
+    }
+    if (engine == Engine::LOCKSTEP)
+    {
+        std::vector<GameSetup> batch(setups.begin() + begin, setups.begin() + end);
+        std::vector<LockstepOutcome> outcomes;
+        FunctionDecider decider(config, strategy);
+        play_lockstep(config, batch, decider, params, outcomes, records);
+        for (const auto &outcome : outcomes)
+        {
+            wins += outcome.won;
+        }
+        return wins;
+    }
+
+    std::vector<StrategyFunction> seats(config.number_of_players, strategy);
+    std::vector<std::vector<int>> final_rows, final_hands;
+    for (int game = begin; game < end; ++game)
+    {
+        GameRecord *record = records != nullptr ? &(*records)[game - begin] : nullptr;
+        int turns = 0;
+        switch (engine)
+        {
+        case Engine::REFERENCE:
+        {
+            GameRecord scratch;
+            GameRecord &reference = record != nullptr ? *record : scratch;
+            wins += has_baseline_strategy(strategy_name, params) ? play_baseline_game(config, strategy_name, setups[game], reference)
+                                                                 : play_reference_game(config, strategy, setups[game], params, reference);
+            break;
+        }
+        case Engine::SIMULATE:
+            wins += simulate_game_multiplayer(config, seats, setups[game], params, turns, final_rows, final_hands, nullptr, record);
+            break;
+        case Engine::LARGE:
+            wins += simulate_game_large(config, setups[game], params, strategy_name == "A1", turns, nullptr, record);
+            break;
+        case Engine::SNAPSHOT:
+            wins += play_snapshot_game(config, setups[game], strategy, params, record);
+            break;
+        case Engine::LOCKSTEP:
+            break;
+        }
+    }
+    return wins;
+}
+
+std::string describe_move(const PlayedMove &move)
+{
+    return "player " + std::to_string(move.player + 1) + " plays " + std::to_string(move.card) + " on row " + std::to_string(move.row);
+}
+
+std::string describe_cards(const std::vector<int> &cards)
+{
+    std::string text;
+    for (int card : cards)
+    {
+        text += (text.empty() ? "" : " ") + std::to_string(card);
+    }
+    return "[" + text + "]";
+}
+
+/**
+ * @brief Compares two records: every move in order, then the final row tops, hands, cards played, draw pile and outcome.
+ *
+ * @return The first difference, or an empty string if the games are identical.
+ */
+std::string first_difference(const GameRecord &reference, const GameRecord &candidate, const char *candidate_name)
+{
+    size_t common = std::min(reference.moves.size(), candidate.moves.size());
+    for (size_t m = 0; m < common; ++m)
+    {
+        const PlayedMove &a = reference.moves[m], &b = candidate.moves[m];
+        if (a.player != b.player || a.card != b.card || a.row != b.row)
+        {
+            return "card " + std::to_string(m + 1) + ": reference " + describe_move(a) + ", " + candidate_name + " " + describe_move(b);
+        }
+    }
+    if (reference.moves.size() != candidate.moves.size())
+    {
+        return "reference plays " + std::to_string(reference.moves.size()) + " cards, " + candidate_name + " " + std::to_string(candidate.moves.size());
+    }
+    if (reference.row_tops != candidate.row_tops)
+    {
+        return "final row tops: reference " + describe_cards(reference.row_tops) + ", " + candidate_name + " " + describe_cards(candidate.row_tops);
+    }
+    for (size_t p = 0; p < reference.hands.size() || p < candidate.hands.size(); ++p)
+    {
+        if (p >= reference.hands.size() || p >= candidate.hands.size() || reference.hands[p] != candidate.hands[p])
+        {
+            return "final hand of player " + std::to_string(p + 1) + ": reference " + (p < reference.hands.size() ? describe_cards(reference.hands[p]) : "none") +
+                   ", " + candidate_name + " " + (p < candidate.hands.size() ? describe_cards(candidate.hands[p]) : "none");
+        }
+    }
+    if (reference.turns != candidate.turns)
+    {
+        return "cards played: reference " + std::to_string(reference.turns) + ", " + candidate_name + " " + std::to_string(candidate.turns);
+    }
+    if (reference.deck_size != candidate.deck_size)
+    {
+        return "draw pile left: reference " + std::to_string(reference.deck_size) + ", " + candidate_name + " " + std::to_string(candidate.deck_size);
+    }
+    if (reference.won != candidate.won)
+    {
+        return std::string("win flag: reference ") + (reference.won ? "won" : "lost") + ", " + candidate_name + " " + (candidate.won ? "won" : "lost");
+    }
+    return "";
+}
+
+// Deals a deck with a fixed seat order
+GameSetup deal_fixed_order(const GameConfig &config, const std::vector<int> &deck, const std::vector<int> &player_order)
+{
+    std::mt19937_64 unused_rng(0);
+    GameSetup setup = setup_game(config, player_order.size(), deck, unused_rng);
+    setup.player_order = player_order;
+    return setup;
+}
+
+// Difference between the reference and the engine on one deck, or an empty string
+std::string compare_on_deck(Engine engine, const GameConfig &config, StrategyFunction strategy, const std::string &strategy_name, const StrategyParams &params,
+                            const std::vector<int> &deck, const std::vector<int> &player_order)
+{
+    std::vector<GameSetup> setups{deal_fixed_order(config, deck, player_order)};
+    std::vector<GameRecord> reference, candidate;
+    play_games(Engine::REFERENCE, config, strategy, strategy_name, params, setups, 0, 1, &reference);
+    play_games(engine, config, strategy, strategy_name, params, setups, 0, 1, &candidate);
+    return first_difference(reference[0], candidate[0], engine_name(engine));
+}
+
+/**
+ * @brief Shrinks a deck on which two engines differ to a locally minimal one (delta debugging, ddmin).
+ *
+ * The deck is cut in n parts; if the engines still differ without one of
+ * them, that part is dropped for good and n shrinks by one, otherwise n
+ * doubles, until every single card is needed. The remaining cards keep
+ * their order and the seat order is unchanged. A deck keeps at least enough
+ * cards for the first deal.
+ *
+ * @return The smallest deck found (the input if nothing could be dropped).
+ */
+std::vector<int> shrink_deck(Engine engine, const GameConfig &config, StrategyFunction strategy, const std::string &strategy_name, const StrategyParams &params,
+                             std::vector<int> deck, const std::vector<int> &player_order, int &tests)
+{
+    const size_t min_cards = player_order.size() * config.card_in_hands;
+    size_t parts = 2;
+    while (deck.size() > min_cards && parts <= deck.size())
+    {
+        bool dropped = false;
+        for (size_t part = 0; part < parts; ++part)
+        {
+            size_t begin = deck.size() * part / parts;
+            size_t end = deck.size() * (part + 1) / parts;
+            if (deck.size() - (end - begin) < min_cards)
+            {
+                continue;
+            }
+            std::vector<int> smaller(deck.begin(), deck.begin() + begin);
+            smaller.insert(smaller.end(), deck.begin() + end, deck.end());
+            tests++;
+            if (!compare_on_deck(engine, config, strategy, strategy_name, params, smaller, player_order).empty())
+            {
+                deck.swap(smaller);
+                parts = std::max<size_t>(parts - 1, 2);
+                dropped = true;
+                break;
+            }
+        }
+        if (!dropped)
+        {
+            if (parts >= deck.size())
+            {
+                break;
+            }
+            parts = std::min(parts * 2, deck.size());
+        }
+    }
+    return deck;
+}
+
+// Result of one engine and one strategy
+struct EngineResult
+{
+    bool played = false;
+    int mismatches = 0;
+    double games_per_second = 0.0;
+};
+
+} // namespace
+
+/**
+ * @brief Checks the optimised engines against the reference engine, move by move, and compares their speed.
+ *
+ * Every engine plays the same seeded decks and seat orders with each
+ * strategy at every seat: the reference, the engine of the simulate mode (simulate_game_multiplayer), the snapshot
+ * engine (with card tracker and whole-turn plans), the lockstep engine for
+ * the strategies that need neither and, for A1 and A2, the large-variant
+ * engine. The reference of A1, A2, E1, E2, H1 and H2 is the verbatim copy
+ * of the first engine and strategies (play_baseline_game), so it checks the
+ * optimised strategies too; the later strategies have no first version and
+ * are played by the frozen rules of play_reference_game. Every move, the final
+ * row tops and hands, the cards played, the draw pile left and the win flag
+ * must be identical. The first mismatching deck of each engine and strategy
+ * is shrunk to a minimal deck that still shows a difference. A table of
+ * games per second (games played again without records) ends the report.
+ *
+ * @param config The game config.
+ * @param strategies The strategies to check, by name.
+ * @param num_games The number of decks.
+ * @param seed The seed of the decks and seat orders.
+ * @param num_threads The number of worker threads.
+ * @return 0 if every engine matches the reference, 1 otherwise.
+ */
+int run_differential_harness(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, uint64_t seed, int num_threads)
+{
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    StrategyParams params = default_strategy_params(config);
+    std::vector<std::vector<int>> decks(num_games);
+    std::vector<GameSetup> setups(num_games);
+    for (int game = 0; game < num_games; ++game)
+    {
+        std::mt19937_64 order_rng = seat_order_rng(seed, game);
+        decks[game] = seeded_deck(config.card_max_number, seed, game);
+        setups[game] = setup_game(config, config.number_of_players, decks[game], order_rng);
+    }
+    std::cout << "Differential check, " << config.number_of_players << " Players, " << num_games << " decks, seed " << seed << ":\n";
+
+    int num_candidates = std::size(CANDIDATE_ENGINES);
+    std::vector<std::string> names;
+    std::vector<std::vector<EngineResult>> results; // [strategy][candidate]
+    std::vector<double> reference_speed;
+    bool all_identical = true;
+    for (auto const &[name, strategy] : strategies)
+    {
+        names.push_back(name);
+        results.emplace_back(num_candidates);
+
+        // --- Move-by-move comparison ---
+        std::vector<std::vector<std::string>> differences(num_candidates, std::vector<std::string>(num_games));
+        parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+            std::vector<GameRecord> reference_records, candidate_records;
+            play_games(Engine::REFERENCE, config, strategy, name, params, setups, begin, end, &reference_records);
+            for (int c = 0; c < num_candidates; ++c)
+            {
+                if (!engine_plays(CANDIDATE_ENGINES[c], name, params))
+                {
+                    continue;
+                }
+                play_games(CANDIDATE_ENGINES[c], config, strategy, name, params, setups, begin, end, &candidate_records);
+                for (int game = begin; game < end; ++game)
+                {
+                    differences[c][game] = first_difference(reference_records[game - begin], candidate_records[game - begin], engine_name(CANDIDATE_ENGINES[c]));
+                }
+            }
+        });
+
+        for (int c = 0; c < num_candidates; ++c)
+        {
+            Engine engine = CANDIDATE_ENGINES[c];
+            EngineResult &result = results.back()[c];
+            if (!engine_plays(engine, name, params))
+            {
+                continue;
+            }
+            result.played = true;
+            int first_mismatch = -1;
+            for (int game = 0; game < num_games; ++game)
+            {
+                if (!differences[c][game].empty())
+                {
+                    result.mismatches++;
+                    first_mismatch = first_mismatch == -1 ? game : first_mismatch;
+                }
+            }
+            if (first_mismatch == -1)
+            {
+                continue;
+            }
+            all_identical = false;
+            std::cout << name << " on the " << engine_name(engine) << " engine: " << result.mismatches << " of " << num_games
+                      << " decks differ, first on deck " << first_mismatch << " (" << differences[c][first_mismatch] << ")\n";
+            int tests = 0;
+            std::vector<int> minimal = shrink_deck(engine, config, strategy, name, params, decks[first_mismatch], setups[first_mismatch].player_order, tests);
+            std::cout << "  shrunk to " << minimal.size() << " cards in " << tests << " tries, dealt from the back: " << describe_cards(minimal)
+                      << ", seat order " << describe_cards(setups[first_mismatch].player_order) << "\n  "
+                      << compare_on_deck(engine, config, strategy, name, params, minimal, setups[first_mismatch].player_order) << "\n";
+        }
+
+        // --- Throughput, without records ---
+        auto time_engine = [&](Engine engine) {
+            auto start = std::chrono::steady_clock::now();
+            parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+                play_games(engine, config, strategy, name, params, setups, begin, end, nullptr);
+            });
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return seconds > 0 ? num_games / seconds : 0.0;
+        };
+        reference_speed.push_back(time_engine(Engine::REFERENCE));
+        for (int c = 0; c < num_candidates; ++c)
+        {
+            if (results.back()[c].played)
+            {
+                results.back()[c].games_per_second = time_engine(CANDIDATE_ENGINES[c]);
+            }
+        }
+    }
+
+    std::cout << "\nGames per second (" << num_threads << " threads), speed-up over the reference, decks differing:\n";
+    std::cout << std::left << std::setw(10) << "Strategy" << std::right << std::setw(12) << engine_name(Engine::REFERENCE);
+    for (Engine engine : CANDIDATE_ENGINES)
+    {
+        std::cout << std::setw(28) << engine_name(engine);
+    }
+    std::cout << "\n";
+    for (size_t s = 0; s < names.size(); ++s)
+    {
+        std::cout << std::left << std::setw(10) << names[s] << std::right << std::setw(12) << std::fixed << std::setprecision(0) << reference_speed[s];
+        for (int c = 0; c < num_candidates; ++c)
+        {
+            const EngineResult &result = results[s][c];
+            std::ostringstream cell;
+            if (result.played)
+            {
+                cell << std::fixed << std::setprecision(0) << result.games_per_second << " x" << std::setprecision(2)
+                     << (reference_speed[s] > 0 ? result.games_per_second / reference_speed[s] : 0.0) << " " << result.mismatches;
+            }
+            else
+            {
+                cell << "-";
+            }
+            std::cout << std::setw(28) << cell.str();
+        }
+        std::cout << "\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    std::cout << (all_identical ? "Every engine matches the reference on every deck\n" : "Some engines differ from the reference, see above\n");
+    return all_identical ? 0 : 1;
+}
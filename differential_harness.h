@@ -0,0 +1,13 @@
+#ifndef DIFFERENTIAL_HARNESS_H
+#define DIFFERENTIAL_HARNESS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+int run_differential_harness(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, uint64_t seed, int num_threads);
+
+#endif
@@ -0,0 +1,296 @@
+#include "endgame_analysis.h"
+#include "card_tracking.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Endgame outcomes of one strategy
+struct EndgameCounts
+{
+    long long games = 0;
+    long long reached = 0;   // Games that got to an endgame of at most max_cards cards
+    long long lost_on_entry = 0; // ... already lost with perfect play when they got there
+    long long won = 0;
+    long long thrown = 0;    // ... winnable, lost by a move of the strategy
+    long long probes = 0;
+    long long misses = 0;    // Probes not in the tablebase, solved on the spot
+};
+
+/**
+ * @brief The endgame position of a snapshot waiting for a decision.
+ *
+ * @return False if the game is over or the draw pile is not empty yet.
+ */
+bool snapshot_endgame(const GameConfig &config, const GameSnapshot &game, EndgamePosition &position)
+{
+    if (game.finished || game.deck_size != 0)
+    {
+        return false;
+    }
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        position.row_tops[r] = game.row_tops[r];
+    }
+    position.num_hands = 0;
+    for (int i = 0; i < game.num_players; ++i)
+    {
+        int player = game.player_order[(game.current_player_index + i) % game.num_players];
+        if (game.hand_sizes[player] > 0)
+        {
+            std::copy(game.hands[player], game.hands[player] + game.hand_sizes[player], position.hands[position.num_hands]);
+            position.hand_sizes[position.num_hands++] = game.hand_sizes[player];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Plays a game until the draw pile is empty and at most max_cards cards are left in the hands.
+ *
+ * @param position (Output) The endgame position reached.
+ * @return False if the game ended before.
+ */
+bool play_to_endgame(const GameConfig &config, TrackedGame &tracked, StrategyFunction strategy, const StrategyParams &params, int max_cards, EndgamePosition &position)
+{
+    while (!tracked.game.finished)
+    {
+        if (snapshot_endgame(config, tracked.game, position) && endgame_cards(position) <= max_cards)
+        {
+            return true;
+        }
+        apply_snapshot_move(config, tracked.game, decide_snapshot_move(config, tracked.game, strategy, params, &tracked.cards, tracked.plan), &tracked.cards);
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Builds an endgame tablebase from the endgames of seeded deals and writes it to a file.
+ *
+ * Every normalised position of up to max_cards cards is too many to list
+ * beyond a handful of cards, so the roots are the endgames games actually
+ * get to: every strategy plays every deal until the draw pile is empty and at
+ * most max_cards cards are left. Each root is then solved with every move
+ * searched, so the tablebase holds every position reachable from the roots.
+ *
+ * @param config The game config.
+ * @param strategies The strategies playing the deals to their endgames.
+ * @param max_cards The most cards left in the positions stored (at most ENDGAME_MAX_CARDS).
+ * @param num_games The number of deals.
+ * @param seed Seed of the deals (as in the differential mode).
+ * @param filename The tablebase file to write.
+ * @param num_threads The number of worker threads.
+ * @return 0 on success, 1 on error.
+ */
+int run_tablebase_build(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int max_cards, int num_games, uint64_t seed,
+                        const std::string &filename, int num_threads)
+{
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    if (max_cards < 1 || max_cards > ENDGAME_MAX_CARDS)
+    {
+        std::cerr << "Error: --endgame-cards must be between 1 and " << ENDGAME_MAX_CARDS << "\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    StrategyParams params = default_strategy_params(config);
+    std::vector<StrategyFunction> functions;
+    for (const auto &[name, strategy] : strategies)
+    {
+        functions.push_back(strategy);
+    }
+
+    // Roots, one list per worker
+    int workers = std::max(1, std::min(num_threads, num_games));
+    std::vector<std::vector<EndgamePosition>> roots(workers);
+    parallel_for_chunks(num_games, workers, [&](int begin, int end, int worker) {
+        TrackedGame tracked;
+        EndgamePosition position;
+        for (int game = begin; game < end; ++game)
+        {
+            std::vector<int> deck = seeded_deck(config.card_max_number, seed, game);
+            std::mt19937_64 order_rng = seat_order_rng(seed, game);
+            GameSetup setup = setup_game(config, config.number_of_players, deck, order_rng);
+            for (StrategyFunction strategy : functions)
+            {
+                tracked.start(config, setup);
+                if (play_to_endgame(config, tracked, strategy, params, max_cards, position))
+                {
+                    roots[worker].push_back(position);
+                }
+            }
+        }
+    });
+
+    // Distinct roots, solved in parallel; positions shared by roots of different workers are solved twice
+    std::vector<EndgamePosition> distinct;
+    std::unordered_map<uint64_t, bool> seen;
+    for (const auto &list : roots)
+    {
+        for (const auto &position : list)
+        {
+            if (seen.emplace(endgame_key(config, position), false).second)
+            {
+                distinct.push_back(position);
+            }
+        }
+    }
+    std::vector<EndgameSolver> solvers(workers, EndgameSolver(config));
+    std::vector<long long> winnable_roots(workers, 0);
+    parallel_for_chunks(distinct.size(), workers, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; ++i)
+        {
+            winnable_roots[worker] += solvers[worker].solve(distinct[i]);
+        }
+    });
+    std::unordered_map<uint64_t, bool> table;
+    long long winnable = 0;
+    for (int w = 0; w < workers; ++w)
+    {
+        table.insert(solvers[w].table().begin(), solvers[w].table().end());
+        winnable += winnable_roots[w];
+    }
+    long long won_positions = 0;
+    for (const auto &entry : table)
+    {
+        won_positions += entry.second;
+    }
+
+    if (!write_endgame_tablebase(filename, config, max_cards, table, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long endgames = 0;
+    for (const auto &list : roots)
+    {
+        endgames += list.size();
+    }
+
+    std::cout << "\n--- Endgame tablebase (at most " << max_cards << " cards left, seed " << seed << ") ---\n";
+    std::cout << "Deals played by " << functions.size() << " strategies: " << num_games << ", endgames reached: " << endgames
+              << ", distinct: " << distinct.size() << " (" << winnable << " winnable)\n";
+    std::cout << "Positions solved: " << table.size() << " (" << std::fixed << std::setprecision(1)
+              << (table.empty() ? 0.0 : 100.0 * won_positions / table.size()) << "% won with perfect play)\n";
+    std::cout << "Written to " << filename << " in " << std::setprecision(2) << seconds << " s\n";
+    return 0;
+}
+
+/**
+ * @brief Labels the endgames of every strategy exactly: already lost when reached, or winnable and then won or thrown away.
+ *
+ * Every strategy plays the same seeded deals. Once the draw pile is empty and
+ * at most the tablebase's number of cards are left, the position is looked up
+ * before every move; a position missing from the tablebase is solved on the
+ * spot, so every label is exact and the miss rate says how well the
+ * tablebase covers these games.
+ *
+ * @param config The game config.
+ * @param strategies The strategies to label.
+ * @param tablebase The tablebase, open for the config.
+ * @param num_games The number of deals.
+ * @param seed Seed of the deals.
+ * @param num_threads The number of worker threads.
+ * @return 0 on success, 1 on error.
+ */
+int run_endgame_analysis(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const EndgameTablebase &tablebase, int num_games,
+                         uint64_t seed, int num_threads)
+{
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    StrategyParams params = default_strategy_params(config);
+    std::vector<std::pair<std::string, StrategyFunction>> list(strategies.begin(), strategies.end());
+    int workers = std::max(1, std::min(num_threads, num_games));
+    std::vector<std::vector<EndgameCounts>> counts(workers, std::vector<EndgameCounts>(list.size()));
+
+    parallel_for_chunks(num_games, workers, [&](int begin, int end, int worker) {
+        TrackedGame tracked;
+        EndgamePosition position;
+        EndgameSolver solver(config); // Positions the tablebase misses
+        for (int game = begin; game < end; ++game)
+        {
+            std::vector<int> deck = seeded_deck(config.card_max_number, seed, game);
+            std::mt19937_64 order_rng = seat_order_rng(seed, game);
+            GameSetup setup = setup_game(config, config.number_of_players, deck, order_rng);
+            for (size_t s = 0; s < list.size(); ++s)
+            {
+                EndgameCounts &c = counts[worker][s];
+                auto winnable = [&](const EndgamePosition &p) {
+                    c.probes++;
+                    EndgameTablebase::Probe probe = tablebase.probe(config, p);
+                    if (probe == EndgameTablebase::Probe::MISS)
+                    {
+                        c.misses++;
+                        return solver.solve(p);
+                    }
+                    return probe == EndgameTablebase::Probe::WON;
+                };
+
+                c.games++;
+                tracked.start(config, setup);
+                if (!play_to_endgame(config, tracked, list[s].second, params, tablebase.max_cards(), position))
+                {
+                    continue;
+                }
+                c.reached++;
+                bool won_position = winnable(position);
+                c.lost_on_entry += !won_position;
+                while (!tracked.game.finished)
+                {
+                    snapshot_endgame(config, tracked.game, position);
+                    std::pair<int, int> move = decide_snapshot_move(config, tracked.game, list[s].second, params, &tracked.cards, tracked.plan);
+                    if (won_position && (move.first == -1 || !winnable(endgame_after_move(position, move.first, move.second))))
+                    {
+                        c.thrown++;
+                        won_position = false;
+                    }
+                    apply_snapshot_move(config, tracked.game, move, &tracked.cards);
+                }
+                c.won += tracked.game.won;
+            }
+        }
+    });
+
+    long long probes = 0, misses = 0;
+    std::cout << "\n--- Endgames with at most " << tablebase.max_cards() << " cards left (" << num_games << " deals, seed " << seed
+              << ", tablebase of " << tablebase.size() << " positions) ---\n";
+    std::cout << std::left << std::setw(12) << "Strategy" << std::right << std::setw(10) << "Reached" << std::setw(15) << "Lost on entry"
+              << std::setw(10) << "Winnable" << std::setw(10) << "Won" << std::setw(13) << "Thrown away" << "\n";
+    for (size_t s = 0; s < list.size(); ++s)
+    {
+        EndgameCounts total;
+        for (int w = 0; w < workers; ++w)
+        {
+            const EndgameCounts &c = counts[w][s];
+            total.reached += c.reached;
+            total.lost_on_entry += c.lost_on_entry;
+            total.won += c.won;
+            total.thrown += c.thrown;
+            probes += c.probes;
+            misses += c.misses;
+        }
+        std::cout << std::left << std::setw(12) << list[s].first << std::right << std::setw(10) << total.reached << std::setw(15) << total.lost_on_entry
+                  << std::setw(10) << total.reached - total.lost_on_entry << std::setw(10) << total.won << std::setw(13) << total.thrown << "\n";
+    }
+    std::cout << "Probes: " << probes << ", answered by the tablebase: " << std::fixed << std::setprecision(1)
+              << (probes == 0 ? 0.0 : 100.0 * (probes - misses) / probes) << "% (the others were solved on the spot)\n";
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef ENDGAME_ANALYSIS_H
+#define ENDGAME_ANALYSIS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "endgame_tablebase.h"
+#include "game_config.h"
+#include "player_strategies.h"
+
+int run_tablebase_build(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int max_cards, int num_games, uint64_t seed,
+                        const std::string &filename, int num_threads);
+int run_endgame_analysis(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const EndgameTablebase &tablebase, int num_games,
+                         uint64_t seed, int num_threads);
+
+#endif
@@ -0,0 +1,523 @@
+#include "endgame_tablebase.h"
+#include "card_tracking.h"
+#include "helper_functions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char TABLEBASE_MAGIC[8] = {'T', 'G', 'E', 'N', 'D', 'G', 'M', '1'};
+const uint32_t TABLEBASE_VERSION = 2;
+
+// First bytes of a tablebase file, followed by the slots
+struct TablebaseHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t number_of_rows;    // Rules the keys were built for
+    int32_t reverse_move_diff;
+    int32_t max_cards;         // Positions with at most this many cards left
+    uint64_t capacity;         // Slots, a power of two
+    uint64_t entries;          // Used slots
+    uint64_t checksum;         // slots_checksum of the slots
+};
+
+// Tablebase probed by strategy T, set once before any game
+const EndgameTablebase *strategy_tablebase = nullptr;
+
+uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+bool legal_endgame_move(const GameConfig &config, int card, int row, int row_top)
+{
+    return is_valid_move(config, card, row_top, row < config.number_of_rows / 2) != ValidMove::NO;
+}
+
+// Normalised description of a position, hashed into its key
+struct EndgameDescription
+{
+    uint8_t bytes[2 * MAX_CONFIG_ROWS + ENDGAME_MAX_HANDS + 3 * ENDGAME_MAX_CARDS];
+    int length = 0;
+};
+
+// Hash of every slot in order: two files with the same checksum hold the same table
+uint64_t slots_checksum(const std::vector<uint64_t> &slots)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint64_t slot : slots)
+    {
+        hash = mix64(hash ^ slot);
+    }
+    return hash;
+}
+
+uint64_t slot_index(uint64_t key, uint64_t mask)
+{
+    return (key >> 2) & mask;
+}
+
+} // namespace
+
+/**
+ * @brief Counts the cards still to play in an endgame position.
+ *
+ * @param position The position.
+ * @return The cards left in all hands.
+ */
+int endgame_cards(const EndgamePosition &position)
+{
+    int cards = 0;
+    for (int h = 0; h < position.num_hands; ++h)
+    {
+        cards += position.hand_sizes[h];
+    }
+    return cards;
+}
+
+/**
+ * @brief Normalised key of an endgame position.
+ *
+ * Whether a card can go on a row only depends on how many cards of the
+ * position lie below the row top, and on whether the card is exactly
+ * REVERSE_MOVE_DIFF from the top; every later row top is one of the cards.
+ * So the cards are replaced by their ranks, each row top by the number of
+ * cards below it and the rank of its reverse card, and the pairs of cards
+ * REVERSE_MOVE_DIFF apart are listed by rank: two positions with the same
+ * description have the same outcome whatever their actual card values. Rows
+ * of the same direction are interchangeable and are sorted, and so are the
+ * cards within a hand. With as many ascending as descending rows, a position
+ * and its mirror image (values reversed, directions swapped) share the
+ * smaller of their two descriptions.
+ *
+ * The key is a 64-bit hash of the description; bit 1 is always set so that
+ * a key is never zero, and bit 0 is left for the result in the file.
+ *
+ * @param config The game config.
+ * @param position The position (at most ENDGAME_MAX_CARDS cards).
+ * @return The key.
+ */
+uint64_t endgame_key(const GameConfig &config, const EndgamePosition &position)
+{
+    uint8_t cards[ENDGAME_MAX_CARDS];
+    int num_cards = 0;
+    for (int h = 0; h < position.num_hands; ++h)
+    {
+        for (int k = 0; k < position.hand_sizes[h]; ++k)
+        {
+            cards[num_cards++] = position.hands[h][k];
+        }
+    }
+    std::sort(cards, cards + num_cards);
+    int16_t rank[256];
+    std::fill(rank, rank + 256, -1);
+    for (int i = 0; i < num_cards; ++i)
+    {
+        rank[cards[i]] = i;
+    }
+    auto card_rank = [&](int value) { return value >= 0 && value < 256 ? rank[value] : -1; };
+
+    EndgameDescription descriptions[2];
+    bool mirrors = config.number_of_rows % 2 == 0;
+    for (int mirrored = 0; mirrored <= mirrors; ++mirrored)
+    {
+        EndgameDescription &d = descriptions[mirrored];
+        auto mapped = [&](int r) { return mirrored ? num_cards - 1 - r : r; };
+
+        // Rows: {cards below the top, rank of the reverse card + 1 or 0}, ascending rows first
+        uint16_t rows[2][MAX_CONFIG_ROWS];
+        int group_sizes[2] = {0, 0};
+        for (int r = 0; r < config.number_of_rows; ++r)
+        {
+            int top = position.row_tops[r];
+            bool ascending = r < config.number_of_rows / 2;
+            int below = std::lower_bound(cards, cards + num_cards, top) - cards;
+            int reverse = card_rank(ascending ? top - config.reverse_move_diff : top + config.reverse_move_diff);
+            int group = ascending != static_cast<bool>(mirrored) ? 0 : 1;
+            rows[group][group_sizes[group]++] = ((mirrored ? num_cards - below : below) << 8) | (reverse < 0 ? 0 : mapped(reverse) + 1);
+        }
+        for (int group = 0; group < 2; ++group)
+        {
+            std::sort(rows[group], rows[group] + group_sizes[group]);
+            for (int i = 0; i < group_sizes[group]; ++i)
+            {
+                d.bytes[d.length++] = rows[group][i] >> 8;
+                d.bytes[d.length++] = rows[group][i] & 0xFF;
+            }
+        }
+
+        for (int h = 0; h < position.num_hands; ++h)
+        {
+            d.bytes[d.length++] = 0x80 | position.hand_sizes[h];
+            int begin = d.length;
+            for (int k = 0; k < position.hand_sizes[h]; ++k)
+            {
+                d.bytes[d.length++] = mapped(rank[position.hands[h][k]]);
+            }
+            std::sort(d.bytes + begin, d.bytes + d.length);
+        }
+
+        // Pairs of cards a reverse trick apart, {lower, higher}
+        uint16_t pairs[ENDGAME_MAX_CARDS];
+        int num_pairs = 0;
+        for (int i = 0; i < num_cards; ++i)
+        {
+            int j = card_rank(cards[i] + config.reverse_move_diff);
+            if (config.reverse_move_diff > 0 && j >= 0)
+            {
+                pairs[num_pairs++] = mirrored ? (mapped(j) << 8) | mapped(i) : (i << 8) | j;
+            }
+        }
+        std::sort(pairs, pairs + num_pairs);
+        for (int i = 0; i < num_pairs; ++i)
+        {
+            d.bytes[d.length++] = pairs[i] >> 8;
+            d.bytes[d.length++] = pairs[i] & 0xFF;
+        }
+    }
+
+    const EndgameDescription *chosen = &descriptions[0];
+    if (mirrors && std::lexicographical_compare(descriptions[1].bytes, descriptions[1].bytes + descriptions[1].length,
+                                                descriptions[0].bytes, descriptions[0].bytes + descriptions[0].length))
+    {
+        chosen = &descriptions[1];
+    }
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a, then mixed so that every bit depends on every byte
+    for (int i = 0; i < chosen->length; ++i)
+    {
+        hash = (hash ^ chosen->bytes[i]) * 0x100000001b3ULL;
+    }
+    return mix64(hash ^ chosen->length) | 2;
+}
+
+/**
+ * @brief Plays one card of the player to move.
+ *
+ * @param position The position before the move.
+ * @param card_index The card, as an index into the hand of the player to move.
+ * @param row The row it goes on (the move must be legal).
+ * @return The position after the move, with the next player to move.
+ */
+EndgamePosition endgame_after_move(const EndgamePosition &position, int card_index, int row)
+{
+    EndgamePosition next;
+    std::memcpy(next.row_tops, position.row_tops, sizeof(next.row_tops));
+    next.row_tops[row] = position.hands[0][card_index];
+
+    for (int h = 1; h < position.num_hands; ++h)
+    {
+        std::memcpy(next.hands[next.num_hands], position.hands[h], position.hand_sizes[h]);
+        next.hand_sizes[next.num_hands++] = position.hand_sizes[h];
+    }
+    if (position.hand_sizes[0] > 1)
+    {
+        // The player keeps cards and comes last in the turn order; an empty hand leaves the game
+        uint8_t *hand = next.hands[next.num_hands];
+        int size = 0;
+        for (int k = 0; k < position.hand_sizes[0]; ++k)
+        {
+            if (k != card_index)
+            {
+                hand[size++] = position.hands[0][k];
+            }
+        }
+        next.hand_sizes[next.num_hands++] = size;
+    }
+    return next;
+}
+
+EndgameSolver::EndgameSolver(const GameConfig &config) : config_(config) {}
+
+/**
+ * @brief Solves an endgame position exactly.
+ *
+ * @param position The position (at most ENDGAME_MAX_CARDS cards).
+ * @return True if the players win it with perfect play.
+ */
+bool EndgameSolver::solve(const EndgamePosition &position)
+{
+    if (position.num_hands == 0)
+    {
+        return true;
+    }
+    uint64_t key = endgame_key(config_, position);
+    auto found = table_.find(key);
+    if (found != table_.end())
+    {
+        return found->second;
+    }
+
+    bool won = false;
+    for (int k = 0; k < position.hand_sizes[0]; ++k)
+    {
+        for (int r = 0; r < config_.number_of_rows; ++r)
+        {
+            if (legal_endgame_move(config_, position.hands[0][k], r, position.row_tops[r]))
+            {
+                won |= solve(endgame_after_move(position, k, r));
+            }
+        }
+    }
+    table_[key] = won;
+    return won;
+}
+
+EndgameTablebase::~EndgameTablebase()
+{
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, mapping_size_);
+    }
+}
+
+/**
+ * @brief Maps a tablebase file built by write_endgame_tablebase.
+ *
+ * @param filename The tablebase file.
+ * @param config The rules of the games it will be probed for.
+ * @param error (Output) Why the file cannot be used.
+ * @return True if the tablebase is ready to probe.
+ */
+bool EndgameTablebase::open(const std::string &filename, const GameConfig &config, std::string &error)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open tablebase " + filename;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(TablebaseHeader))
+    {
+        ::close(fd);
+        error = filename + " is not a tablebase";
+        return false;
+    }
+    void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        error = "cannot map tablebase " + filename;
+        return false;
+    }
+
+    const TablebaseHeader *header = static_cast<const TablebaseHeader *>(mapping);
+    std::string problem;
+    if (std::memcmp(header->magic, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC)) != 0 || header->version != TABLEBASE_VERSION)
+        problem = " is not a tablebase of this version";
+    else if (header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 ||
+             static_cast<size_t>(info.st_size) != sizeof(TablebaseHeader) + header->capacity * sizeof(uint64_t))
+        problem = " is truncated or corrupt";
+    else if (header->number_of_rows != config.number_of_rows || header->reverse_move_diff != config.reverse_move_diff)
+        problem = " was built for " + std::to_string(header->number_of_rows) + " rows and REVERSE_MOVE_DIFF " + std::to_string(header->reverse_move_diff);
+    if (!problem.empty())
+    {
+        munmap(mapping, info.st_size);
+        error = filename + problem;
+        return false;
+    }
+
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, mapping_size_);
+    }
+    mapping_ = mapping;
+    mapping_size_ = info.st_size;
+    slots_ = reinterpret_cast<const uint64_t *>(static_cast<const char *>(mapping) + sizeof(TablebaseHeader));
+    mask_ = header->capacity - 1;
+    entries_ = header->entries;
+    max_cards_ = header->max_cards;
+    checksum_ = header->checksum;
+    return true;
+}
+
+/**
+ * @brief Looks a position key up.
+ *
+ * @param key The key (endgame_key).
+ * @return WON or LOST with perfect play, or MISS if the position is not in the tablebase.
+ */
+EndgameTablebase::Probe EndgameTablebase::probe(uint64_t key) const
+{
+    if (slots_ == nullptr)
+    {
+        return Probe::MISS;
+    }
+    for (uint64_t i = slot_index(key, mask_);; i = (i + 1) & mask_)
+    {
+        uint64_t slot = slots_[i];
+        if (slot == 0)
+        {
+            return Probe::MISS;
+        }
+        if ((slot | 1) == (key | 1))
+        {
+            return (slot & 1) ? Probe::WON : Probe::LOST;
+        }
+    }
+}
+
+EndgameTablebase::Probe EndgameTablebase::probe(const GameConfig &config, const EndgamePosition &position) const
+{
+    if (position.num_hands == 0)
+    {
+        return Probe::WON;
+    }
+    if (endgame_cards(position) > max_cards_)
+    {
+        return Probe::MISS;
+    }
+    return probe(endgame_key(config, position));
+}
+
+/**
+ * @brief Writes solved positions as a tablebase file (see EndgameTablebase).
+ *
+ * The table is at most half full, so a probe rarely looks past its first slot.
+ *
+ * @param filename The file to write.
+ * @param config The rules the positions were solved for.
+ * @param max_cards The most cards left in the positions stored.
+ * @param table Solved positions: key -> won.
+ * @param error (Output) Why the file could not be written.
+ * @return True if the file was written.
+ */
+bool write_endgame_tablebase(const std::string &filename, const GameConfig &config, int max_cards, const std::unordered_map<uint64_t, bool> &table, std::string &error)
+{
+    TablebaseHeader header = {};
+    std::memcpy(header.magic, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC));
+    header.version = TABLEBASE_VERSION;
+    header.number_of_rows = config.number_of_rows;
+    header.reverse_move_diff = config.reverse_move_diff;
+    header.max_cards = max_cards;
+    header.capacity = 1;
+    while (header.capacity < 2 * table.size() + 2)
+    {
+        header.capacity <<= 1;
+    }
+    header.entries = table.size();
+
+    std::vector<uint64_t> slots(header.capacity, 0);
+    uint64_t mask = header.capacity - 1;
+    for (const auto &[key, won] : table)
+    {
+        uint64_t i = slot_index(key, mask);
+        while (slots[i] != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        slots[i] = (key & ~uint64_t{1}) | (won ? 1 : 0);
+    }
+    header.checksum = slots_checksum(slots);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(slots.data()), slots.size() * sizeof(uint64_t));
+    if (!file)
+    {
+        error = "cannot write tablebase " + filename;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sets the tablebase strategy T probes (nullptr: T plays as J).
+ *
+ * @param tablebase The tablebase, kept open for as long as games are played.
+ */
+void set_strategy_tablebase(const EndgameTablebase *tablebase)
+{
+    strategy_tablebase = tablebase;
+}
+
+/**
+ * @brief The tablebase strategy T probes (nullptr if none).
+ */
+const EndgameTablebase *get_strategy_tablebase()
+{
+    return strategy_tablebase;
+}
+
+/**
+ * @brief Strategy T: Perfect Endgame from the Tablebase
+ *
+ * Once the draw pile is empty, a player who knows every hand left plays a
+ * move that keeps the game won, read from the tablebase. With the card
+ * tracker, the cards a player has not seen are the other hands; they are
+ * known exactly when at most one other player holds them, i.e. in two-player
+ * games or when everybody else is done. Otherwise (hands not known, more
+ * cards than the tablebase holds, a lost position or a miss) T plays as J.
+ *
+ * @param hand The player's hand.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications The list of communications from other players.
+ * @param player_id The ID of the current player.
+ * @param context The strategy context handed over by the engine.
+ * @return A pair containing the best card index and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_T(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    const CardTracker *cards = context.cards;
+    const EndgameTablebase *tablebase = strategy_tablebase;
+    if (tablebase == nullptr || cards == nullptr || cards->deck_size() != 0 || hand.size() > ENDGAME_MAX_HAND)
+    {
+        return get_player_move_J(hand, playing_rows, communications, player_id, context);
+    }
+    int unseen = cards->unseen_count(player_id);
+    if ((unseen > 0 && context.config.number_of_players != 2) || static_cast<int>(hand.size()) + unseen > tablebase->max_cards())
+    {
+        return get_player_move_J(hand, playing_rows, communications, player_id, context);
+    }
+
+    EndgamePosition position;
+    for (int r = 0; r < context.config.number_of_rows; ++r)
+    {
+        position.row_tops[r] = playing_rows[r].back();
+    }
+    position.hand_sizes[0] = hand.size();
+    for (size_t k = 0; k < hand.size(); ++k)
+    {
+        position.hands[0][k] = hand[k];
+    }
+    position.num_hands = 1;
+    if (unseen > 0)
+    {
+        position.hand_sizes[1] = 0;
+        for (int card = 2; card < context.config.card_max_number; ++card)
+        {
+            if (cards->is_unseen(player_id, card))
+            {
+                position.hands[1][position.hand_sizes[1]++] = card;
+            }
+        }
+        position.num_hands = 2;
+    }
+
+    for (size_t k = 0; k < hand.size(); ++k)
+    {
+        for (int r = 0; r < context.config.number_of_rows; ++r)
+        {
+            if (evaluate_move(context, hand[k], r, playing_rows[r].back()) != ValidMove::NO &&
+                tablebase->probe(context.config, endgame_after_move(position, k, r)) == EndgameTablebase::Probe::WON)
+            {
+                return {static_cast<int>(k), r};
+            }
+        }
+    }
+    return get_player_move_J(hand, playing_rows, communications, player_id, context);
+}
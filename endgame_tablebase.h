@@ -0,0 +1,100 @@
+#ifndef ENDGAME_TABLEBASE_H
+#define ENDGAME_TABLEBASE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+const int ENDGAME_MAX_CARDS = 16;  // Most cards left in all hands that a tablebase can hold
+const int ENDGAME_MAX_HANDS = 8;   // Most players still holding cards
+const int ENDGAME_MAX_HAND = 16;   // Most cards in one hand
+
+/**
+ * @brief A position once the draw pile is empty: every turn is one card, and the rest of the game is fully determined.
+ *
+ * Only the players still holding cards are kept, in turn order from the
+ * player to move. The order of the cards within a hand does not matter.
+ */
+struct EndgamePosition
+{
+    uint8_t row_tops[MAX_CONFIG_ROWS];
+    uint8_t hands[ENDGAME_MAX_HANDS][ENDGAME_MAX_HAND];
+    uint8_t hand_sizes[ENDGAME_MAX_HANDS];
+    uint8_t num_hands = 0;
+};
+
+int endgame_cards(const EndgamePosition &position);
+uint64_t endgame_key(const GameConfig &config, const EndgamePosition &position);
+EndgamePosition endgame_after_move(const EndgamePosition &position, int card_index, int row);
+
+/**
+ * @brief Exact solver of endgame positions by memoised search over the normalised keys.
+ *
+ * Every move of every position reached is searched (no cut-off after the
+ * first winning move), so the table also holds every position a probe can
+ * reach from the positions solved.
+ */
+class EndgameSolver
+{
+public:
+    explicit EndgameSolver(const GameConfig &config);
+
+    bool solve(const EndgamePosition &position);
+    const std::unordered_map<uint64_t, bool> &table() const { return table_; }
+
+private:
+    const GameConfig &config_;
+    std::unordered_map<uint64_t, bool> table_; // Key -> won with perfect play
+};
+
+/**
+ * @brief A tablebase file mapped read-only into memory: one probe is one hash slot, plus a few on collisions.
+ *
+ * The file is an open-addressed table of 64-bit slots (key with the low bit
+ * holding the result) behind a header giving the rules it was built for
+ * and a checksum of the slots, which tells cached outcomes of T apart.
+ * Several processes opening the same file share its pages.
+ */
+class EndgameTablebase
+{
+public:
+    enum class Probe
+    {
+        MISS, // Not in the tablebase
+        LOST,
+        WON
+    };
+
+    EndgameTablebase() = default;
+    ~EndgameTablebase();
+    EndgameTablebase(const EndgameTablebase &) = delete;
+    EndgameTablebase &operator=(const EndgameTablebase &) = delete;
+
+    bool open(const std::string &filename, const GameConfig &config, std::string &error);
+    Probe probe(uint64_t key) const;
+    Probe probe(const GameConfig &config, const EndgamePosition &position) const;
+    int max_cards() const { return max_cards_; }
+    uint64_t size() const { return entries_; }
+    uint64_t checksum() const { return checksum_; }
+
+private:
+    void *mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    const uint64_t *slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t entries_ = 0;
+    int max_cards_ = 0;
+    uint64_t checksum_ = 0; // Of the slots, from the header
+};
+
+bool write_endgame_tablebase(const std::string &filename, const GameConfig &config, int max_cards, const std::unordered_map<uint64_t, bool> &table, std::string &error);
+
+void set_strategy_tablebase(const EndgameTablebase *tablebase);
+const EndgameTablebase *get_strategy_tablebase();
+std::pair<int, int> get_player_move_T(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+
+#endif
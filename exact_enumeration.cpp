@@ -0,0 +1,466 @@
+#include "exact_enumeration.h"
+#include "card_tracking.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const int EXACT_KEY_BYTES = 64;
+const size_t MEMO_LIMIT = 1 << 20; // States memoised per worker before half of them are evicted (about 100 MB)
+const double PROGRESS_SECONDS = 10.0; // Between two progress lines of a strategy
+
+// Everything the rest of a game depends on at the start of a turn
+//
+// The card tracker needs no bytes of its own: a player has seen exactly the
+// played cards and their own hand, and the played cards are the cards that
+// are neither undrawn nor in a hand. Whole-turn plans start afresh at every
+// turn. Cards played so far do not change the outcome.
+struct ExactStateKey
+{
+    uint8_t bytes[EXACT_KEY_BYTES];
+    int length = 0;
+
+    void add(uint8_t byte) { bytes[length++] = byte; }
+    bool operator==(const ExactStateKey &other) const { return length == other.length && std::memcmp(bytes, other.bytes, length) == 0; }
+};
+
+struct ExactStateKeyHash
+{
+    size_t operator()(const ExactStateKey &key) const
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (int i = 0; i < key.length; ++i)
+        {
+            hash = (hash ^ key.bytes[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+int key_length(const GameConfig &config)
+{
+    int players = config.number_of_players;
+    return 4 + 1 + 2 * players + config.number_of_rows + players * (1 + config.card_in_hands);
+}
+
+uint64_t factorial(int n)
+{
+    uint64_t result = 1;
+    for (int k = 2; k <= n; ++k)
+    {
+        result *= k;
+    }
+    return result;
+}
+
+// Counts the winning orders of the undrawn cards from a turn start, one strategy at every seat
+class ExactSearch
+{
+public:
+    ExactSearch(const GameConfig &config, StrategyFunction strategy, const StrategyParams &params) : config_(config), strategy_(strategy), params_(params) {}
+
+    uint64_t wins_from_turn(const GameSnapshot &game, const CardTracker &cards, uint32_t undrawn);
+
+    long long states = 0;    // Turn starts searched
+    long long memo_hits = 0; // Turn starts found in the memo
+    long long evicted = 0;   // Turn starts dropped from the full memo
+
+private:
+    const GameConfig &config_;
+    StrategyFunction strategy_;
+    const StrategyParams &params_;
+    std::unordered_map<ExactStateKey, uint64_t, ExactStateKeyHash> memo_;
+
+    ExactStateKey state_key(const GameSnapshot &game, uint32_t undrawn) const;
+    void evict();
+    uint64_t wins_after(const GameSnapshot &game, const CardTracker &cards, uint32_t undrawn);
+    uint64_t wins_over_draws(const GameSnapshot &game, const CardTracker &cards, std::pair<int, int> move, uint32_t undrawn, int draws);
+};
+
+ExactStateKey ExactSearch::state_key(const GameSnapshot &game, uint32_t undrawn) const
+{
+    ExactStateKey key;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        key.add(undrawn >> shift);
+    }
+    key.add(game.current_player_index);
+    for (int p = 0; p < game.num_players; ++p)
+    {
+        key.add(game.player_order[p]);
+        key.add(game.active[p]);
+    }
+    for (int r = 0; r < config_.number_of_rows; ++r)
+    {
+        key.add(game.row_tops[r]);
+    }
+    for (int p = 0; p < game.num_players; ++p)
+    {
+        key.add(game.hand_sizes[p]);
+        for (int k = 0; k < game.hand_sizes[p]; ++k)
+        {
+            key.add(game.hands[p][k]); // In hand order: strategies break ties by position
+        }
+    }
+    return key;
+}
+
+// Undrawn cards of a memoised state (its first four key bytes)
+int undrawn_count(const ExactStateKey &key)
+{
+    uint32_t undrawn = key.bytes[0] | key.bytes[1] << 8 | key.bytes[2] << 16 | static_cast<uint32_t>(key.bytes[3]) << 24;
+    return __builtin_popcount(undrawn);
+}
+
+/**
+ * @brief Makes room in the full memo by dropping at least half of it, the states with the fewest undrawn cards first.
+ *
+ * A state with few undrawn cards has a small subtree, so searching it again
+ * is cheap; the states near the roots, whose subtrees hold most of the work,
+ * are kept.
+ */
+void ExactSearch::evict()
+{
+    size_t by_undrawn[33] = {};
+    for (const auto &entry : memo_)
+    {
+        by_undrawn[undrawn_count(entry.first)]++;
+    }
+    int highest_dropped = 0;
+    size_t dropped = by_undrawn[0];
+    while (dropped < memo_.size() / 2 && highest_dropped < 32)
+    {
+        dropped += by_undrawn[++highest_dropped];
+    }
+    for (auto it = memo_.begin(); it != memo_.end();)
+    {
+        it = undrawn_count(it->first) <= highest_dropped ? memo_.erase(it) : std::next(it);
+    }
+    evicted += dropped;
+}
+
+// Finished games count once if won; unfinished ones wait at the start of a turn
+uint64_t ExactSearch::wins_after(const GameSnapshot &game, const CardTracker &cards, uint32_t undrawn)
+{
+    if (game.finished)
+    {
+        return game.won ? 1 : 0;
+    }
+    return wins_from_turn(game, cards, undrawn);
+}
+
+/**
+ * @brief Plays the last move of a turn once for every ordered choice of the cards it draws.
+ */
+uint64_t ExactSearch::wins_over_draws(const GameSnapshot &game, const CardTracker &cards, std::pair<int, int> move, uint32_t undrawn, int draws)
+{
+    uint64_t wins = 0;
+    std::vector<int> sequence(draws);
+    // Fills the draw pile from its top: sequence[0] is the first card drawn
+    auto choose = [&](auto &&self, int depth, uint32_t left) -> void {
+        if (depth == draws)
+        {
+            GameSnapshot next = game;
+            for (int d = 0; d < draws; ++d)
+            {
+                next.deck[next.deck_size - 1 - d] = sequence[d];
+            }
+            CardTracker next_cards = cards;
+            apply_snapshot_move(config_, next, move, &next_cards);
+            wins += wins_after(next, next_cards, left);
+            return;
+        }
+        for (uint32_t bits = left; bits != 0; bits &= bits - 1)
+        {
+            int bit = __builtin_ctz(bits);
+            sequence[depth] = bit + 2;
+            self(self, depth + 1, left & ~(1u << bit));
+        }
+    };
+    choose(choose, 0, undrawn);
+    return wins;
+}
+
+/**
+ * @brief Number of orders of the undrawn cards that win, from the start of a turn.
+ *
+ * The turn is played move by move; only its last move draws, and it is
+ * played once per ordered choice of the cards drawn. A lost game stops
+ * there, whatever the order of the cards left in the draw pile.
+ *
+ * @param game The game, at the start of a turn.
+ * @param cards The card tracker of the game.
+ * @param undrawn Bit c - 2 set: card c is still in the draw pile.
+ * @return The winning orders, out of (number of undrawn cards)!.
+ */
+uint64_t ExactSearch::wins_from_turn(const GameSnapshot &game, const CardTracker &cards, uint32_t undrawn)
+{
+    ExactStateKey key = state_key(game, undrawn);
+    auto found = memo_.find(key);
+    if (found != memo_.end())
+    {
+        memo_hits++;
+        return found->second;
+    }
+    states++;
+
+    GameSnapshot turn = game;
+    CardTracker turn_cards = cards;
+    SnapshotTurnPlan plan;
+    uint64_t wins = 0;
+    while (true)
+    {
+        std::pair<int, int> move = decide_snapshot_move(config_, turn, strategy_, params_, &turn_cards, plan);
+        int player = current_snapshot_player(turn);
+        int draws = std::min<int>(config_.card_in_hands - (turn.hand_sizes[player] - 1), turn.deck_size);
+        if (move.first == -1 || turn.cards_left > 1 || draws <= 0)
+        {
+            bool last_move = move.first == -1 || turn.cards_left == 1;
+            apply_snapshot_move(config_, turn, move, &turn_cards);
+            if (last_move)
+            {
+                wins = wins_after(turn, turn_cards, undrawn);
+                break;
+            }
+            continue;
+        }
+        wins = wins_over_draws(turn, turn_cards, move, undrawn, draws);
+        break;
+    }
+
+    if (memo_.size() >= MEMO_LIMIT)
+    {
+        evict();
+    }
+    memo_.emplace(key, wins);
+    return wins;
+}
+
+// The ranked part of a deal: the dealt cards in order, then the seat order
+struct ExactRoot
+{
+    std::vector<int> dealt;
+    std::vector<int> player_order;
+};
+
+/**
+ * @brief Decodes root number rank: the seat order is the Lehmer code rank % players!, the dealt
+ *        cards the Lehmer code of a partial permutation (first digit base N, then N - 1, ...).
+ */
+ExactRoot decode_root(uint64_t rank, int num_cards, int num_dealt, int num_players)
+{
+    ExactRoot root;
+    uint64_t seat_orders = factorial(num_players);
+    uint64_t seat_rank = rank % seat_orders;
+    rank /= seat_orders;
+
+    std::vector<int> players(num_players);
+    std::iota(players.begin(), players.end(), 0);
+    for (int p = num_players; p > 0; --p)
+    {
+        uint64_t digit_weight = factorial(p - 1);
+        int digit = seat_rank / digit_weight;
+        seat_rank %= digit_weight;
+        root.player_order.push_back(players[digit]);
+        players.erase(players.begin() + digit);
+    }
+
+    std::vector<int> cards(num_cards);
+    std::iota(cards.begin(), cards.end(), 2);
+    std::vector<int> digits(num_dealt);
+    for (int k = num_dealt - 1; k >= 0; --k)
+    {
+        int base = num_cards - k;
+        digits[k] = rank % base;
+        rank /= base;
+    }
+    for (int k = 0; k < num_dealt; ++k)
+    {
+        root.dealt.push_back(cards[digits[k]]);
+        cards.erase(cards.begin() + digits[k]);
+    }
+    return root;
+}
+
+std::string format_rate(double rate)
+{
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(4) << 100.0 * rate << " %";
+    return text.str();
+}
+
+} // namespace
+
+/**
+ * @brief Exact win probability of every strategy on a small variant, over every deck order and seat order.
+ *
+ * The deals (the ordered cards of the starting hands) and seat orders are
+ * numbered by Lehmer rank and split in contiguous chunks between the
+ * workers. From each deal the game is played on the snapshot engine and
+ * branches only where a card is drawn, once per undrawn card: a lost game
+ * counts for none of the orders of the cards it never drew, and the
+ * outcomes are memoised per turn start (hands, row tops, undrawn cards),
+ * so deck orders that lead to the same position are only played once.
+ * A full memo drops its deepest states (see ExactSearch::evict). Each
+ * win rate is printed, and flushed, as a reduced fraction of the N! x players!
+ * equally likely deals, next to a Monte Carlo estimate of the reference
+ * engine on num_games seeded deals and its z-score, to check that engine
+ * against the exact value. While a strategy is enumerated, a progress line
+ * goes to standard error every PROGRESS_SECONDS.
+ *
+ * @param config The game config (at most EXACT_MAX_CARDS cards).
+ * @param strategies The strategies to enumerate.
+ * @param num_games Seeded deals of the Monte Carlo check (0: none).
+ * @param seed Seed of the Monte Carlo deals.
+ * @param num_threads Worker threads.
+ * @return 0 on success, 1 if the variant is too large.
+ */
+int run_exact_enumeration(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, uint64_t seed, int num_threads)
+{
+    int num_cards = config.card_max_number - 2;
+    int num_players = config.number_of_players;
+    int num_dealt = num_players * config.card_in_hands;
+    std::string error;
+    if (num_cards > EXACT_MAX_CARDS || num_dealt > num_cards)
+    {
+        std::cerr << "Error: Exact enumeration needs at most " << EXACT_MAX_CARDS << " cards (CARD_MAX_NUMBER " << EXACT_MAX_CARDS + 2
+                  << ") and enough of them for the starting hands\n";
+        return 1;
+    }
+    if (!check_snapshot_capacity(config, num_players, error) || key_length(config) > EXACT_KEY_BYTES)
+    {
+        std::cerr << "Error: " << (error.empty() ? "Too many players, rows or cards per hand for the exact enumeration" : error) << "\n";
+        return 1;
+    }
+    uint64_t seat_orders = factorial(num_players);
+    uint64_t deals = factorial(num_cards) / factorial(num_cards - num_dealt);
+    if (deals * seat_orders > static_cast<uint64_t>(INT_MAX))
+    {
+        std::cerr << "Error: " << deals * seat_orders << " deals and seat orders to rank, at most " << INT_MAX << "\n";
+        return 1;
+    }
+    int num_roots = deals * seat_orders;
+    uint64_t total = factorial(num_cards) * seat_orders; // Equally likely deck orders and seat orders
+    StrategyParams params = default_strategy_params(config);
+
+    std::cout << "\n--- Exact win probabilities (" << num_cards << " cards, " << num_players << " players: " << deals << " deals x "
+              << seat_orders << " seat orders ranked, " << total << " deck and seat orders in all) ---\n";
+    std::cout << std::left << std::setw(10) << "Strategy" << std::setw(28) << "Exact win rate" << std::setw(12) << "" << std::right << std::setw(12)
+              << "States" << std::setw(12) << "Memo hits" << std::setw(12) << "Evicted" << std::setw(9) << "Seconds";
+    if (num_games > 0)
+    {
+        std::cout << std::setw(14) << "Monte Carlo" << std::setw(8) << "z";
+    }
+    std::cout << std::endl;
+
+    for (const auto &[name, strategy] : strategies)
+    {
+        auto start = std::chrono::steady_clock::now();
+        int workers = std::max(1, std::min(num_threads, num_roots));
+        std::vector<uint64_t> worker_wins(workers, 0);
+        std::vector<long long> worker_states(workers, 0), worker_hits(workers, 0), worker_evicted(workers, 0);
+        std::atomic<int> roots_done{0};
+        parallel_for_chunks(num_roots, workers, [&](int begin, int end, int worker) {
+            ExactSearch search(config, strategy, params);
+            double next_progress = PROGRESS_SECONDS;
+            for (int rank = begin; rank < end; ++rank)
+            {
+                ExactRoot root = decode_root(rank, num_cards, num_dealt, num_players);
+                GameSetup setup;
+                uint32_t undrawn = (1u << num_cards) - 1;
+                for (int p = 0; p < num_players; ++p)
+                {
+                    setup.hands.emplace_back(root.dealt.begin() + p * config.card_in_hands, root.dealt.begin() + (p + 1) * config.card_in_hands);
+                }
+                for (int card : root.dealt)
+                {
+                    undrawn &= ~(1u << (card - 2));
+                }
+                for (int card = 2; card < config.card_max_number; ++card)
+                {
+                    if (undrawn & (1u << (card - 2)))
+                    {
+                        setup.deck.push_back(card); // Placeholder order: every draw is chosen by the search
+                    }
+                }
+                setup.player_order = root.player_order;
+
+                GameSnapshot game;
+                start_snapshot(config, setup, game);
+                CardTracker cards;
+                cards.start_game(config, setup.hands, setup.deck.size());
+                worker_wins[worker] += search.wins_from_turn(game, cards, undrawn);
+                int done = roots_done.fetch_add(1, std::memory_order_relaxed) + 1;
+
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (worker == 0 && elapsed >= next_progress)
+                {
+                    std::ostringstream line; // One write per line, so it does not mix with other output
+                    line << std::fixed << std::setprecision(1) << "Progress: " << name << " " << done << "/" << num_roots << " deals ("
+                         << 100.0 * done / num_roots << " %), ETA " << elapsed * (num_roots - done) / done << " s\n";
+                    std::cerr << line.str();
+                    next_progress = elapsed + PROGRESS_SECONDS;
+                }
+            }
+            worker_states[worker] = search.states;
+            worker_hits[worker] = search.memo_hits;
+            worker_evicted[worker] = search.evicted;
+        });
+        uint64_t wins = 0;
+        long long states = 0, hits = 0, evicted = 0;
+        for (int w = 0; w < workers; ++w)
+        {
+            wins += worker_wins[w];
+            states += worker_states[w];
+            hits += worker_hits[w];
+            evicted += worker_evicted[w];
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t divisor = std::gcd(wins, total);
+        double exact = static_cast<double>(wins) / total;
+        std::ostringstream fraction;
+        fraction << wins / divisor << "/" << total / divisor;
+        std::cout << std::left << std::setw(10) << name << std::setw(28) << fraction.str() << std::setw(12) << format_rate(exact) << std::right
+                  << std::setw(12) << states << std::setw(12) << hits << std::setw(12) << evicted << std::setw(9) << std::fixed << std::setprecision(1) << seconds;
+
+        if (num_games > 0)
+        {
+            // Reference engine on random deals, checked against the exact value
+            std::vector<StrategyFunction> seats(num_players, strategy);
+            std::vector<int> sample_wins(workers, 0);
+            parallel_for_chunks(num_games, workers, [&](int begin, int end, int worker) {
+                std::vector<std::vector<int>> rows, hands;
+                for (int g = begin; g < end; ++g)
+                {
+                    std::vector<int> deck = seeded_deck(config.card_max_number, seed, g);
+                    std::mt19937_64 order_rng = seat_order_rng(seed, g);
+                    int turns = 0;
+                    sample_wins[worker] += simulate_game_multiplayer(config, seats, setup_game(config, num_players, deck, order_rng), params, turns, rows, hands);
+                }
+            });
+            double sampled = static_cast<double>(std::accumulate(sample_wins.begin(), sample_wins.end(), 0)) / num_games;
+            double standard_error = std::sqrt(exact * (1.0 - exact) / num_games);
+            std::cout << std::setw(14) << format_rate(sampled);
+            if (standard_error > 0.0)
+                std::cout << std::setw(8) << std::setprecision(2) << (sampled - exact) / standard_error;
+            else
+                std::cout << std::setw(8) << (sampled == exact ? "0" : "inf");
+        }
+        std::cout << std::endl; // Rows of long runs show up as soon as they are done
+    }
+    return 0;
+}
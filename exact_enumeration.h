@@ -0,0 +1,15 @@
+#ifndef EXACT_ENUMERATION_H
+#define EXACT_ENUMERATION_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+const int EXACT_MAX_CARDS = 16; // Most cards in the deck (16! deals x 8! seat orders still fit a 64-bit count)
+
+int run_exact_enumeration(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, uint64_t seed, int num_threads);
+
+#endif
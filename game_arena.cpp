@@ -0,0 +1,72 @@
+#include "game_arena.h"
+
+/**
+ * @brief Creates an arena with a buffer of initial_bytes.
+ *
+ * @param initial_bytes The starting size of the buffer (it grows on demand).
+ */
+GameArena::GameArena(size_t initial_bytes)
+    : capacity_(initial_bytes), buffer_(new std::byte[initial_bytes])
+{
+    arena_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+/**
+ * @brief Returns the memory resource to allocate the containers of the current game from.
+ */
+std::pmr::memory_resource *GameArena::resource()
+{
+    return &*arena_;
+}
+
+/**
+ * @brief Releases everything allocated since the last reset.
+ *
+ * Every container allocated from resource() must be gone by then. If the
+ * last game did not fit in the buffer, the buffer is enlarged to twice what
+ * the game needed.
+ */
+void GameArena::reset()
+{
+    arena_.reset(); // Returns the heap overflow chunks
+    if (overflow_.overflow_bytes > 0)
+    {
+        capacity_ = 2 * (capacity_ + overflow_.overflow_bytes);
+        buffer_.reset(new std::byte[capacity_]);
+        overflow_.overflow_bytes = 0;
+    }
+    arena_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+/**
+ * @brief Returns the size of the buffer in bytes.
+ */
+size_t GameArena::capacity() const
+{
+    return capacity_;
+}
+
+void *GameArena::OverflowResource::do_allocate(size_t bytes, size_t alignment)
+{
+    overflow_bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void GameArena::OverflowResource::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool GameArena::OverflowResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+/**
+ * @brief Returns the arena of the calling thread, shared by the games played on it.
+ */
+GameArena &thread_game_arena()
+{
+    static thread_local GameArena arena;
+    return arena;
+}
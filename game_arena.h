@@ -0,0 +1,50 @@
+#ifndef GAME_ARENA_H
+#define GAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @brief Monotonic arena for everything allocated while a game is played.
+ *
+ * Allocating is a pointer bump in one buffer and nothing is freed until
+ * reset(), which makes the whole buffer available again for the next game.
+ * Allocations that do not fit go to the heap and are counted; the next
+ * reset() then grows the buffer, so after the first games every game is
+ * served from the buffer without calling malloc.
+ */
+class GameArena
+{
+public:
+    explicit GameArena(size_t initial_bytes = 64 * 1024);
+    GameArena(const GameArena &) = delete;
+    GameArena &operator=(const GameArena &) = delete;
+
+    std::pmr::memory_resource *resource();
+    void reset();
+    size_t capacity() const;
+
+private:
+    // Heap fallback of the monotonic resource, remembers how much the buffer was short
+    class OverflowResource : public std::pmr::memory_resource
+    {
+    public:
+        size_t overflow_bytes = 0;
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+    };
+
+    size_t capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+};
+
+GameArena &thread_game_arena();
+
+#endif
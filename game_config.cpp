@@ -0,0 +1,167 @@
+#include "game_config.h"
+
+#include <fstream> // std::ifstream
+#include <iostream>
+#include <sstream> // std::istringstream
+
+/**
+ * @brief Checks that a config describes a game the engine can play.
+ *
+ * @param config The config to check.
+ * @param error (Output) What is wrong, when the config is rejected.
+ * @return True if the config is valid.
+ */
+bool validate_game_config(const GameConfig &config, std::string &error)
+{
+    if (config.card_max_number < 4)
+    {
+        error = "CARD_MAX_NUMBER must be at least 4";
+        return false;
+    }
+    if (config.reverse_move_diff < 1)
+    {
+        error = "REVERSE_MOVE_DIFF must be at least 1";
+        return false;
+    }
+    if (config.number_of_rows < 1 || config.number_of_rows > MAX_CONFIG_ROWS)
+    {
+        error = "NUMBER_OF_ROWS must be between 1 and " + std::to_string(MAX_CONFIG_ROWS);
+        return false;
+    }
+    if (config.card_in_hands < 1)
+    {
+        error = "CARD_IN_HANDS must be at least 1";
+        return false;
+    }
+    if (config.num_cards_to_play < 1 || config.num_cards_to_play > config.card_in_hands)
+    {
+        error = "NUM_CARDS_TO_PLAY must be between 1 and CARD_IN_HANDS";
+        return false;
+    }
+    if (config.number_of_players < 1)
+    {
+        error = "NUMBER_OF_PLAYERS must be at least 1";
+        return false;
+    }
+    if (static_cast<long long>(config.number_of_players) * config.card_in_hands > config.card_max_number - 2)
+    {
+        error = "NUMBER_OF_PLAYERS x CARD_IN_HANDS is more than the deck holds";
+        return false;
+    }
+    if (config.num_simulations < 0)
+    {
+        error = "NUM_SIMULATIONS must not be negative";
+        return false;
+    }
+    if (config.good_move_window < 0)
+    {
+        error = "GOOD_MOVE_WINDOW must not be negative";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sets one setting of a config by its configuration file name (e.g. CARD_MAX_NUMBER).
+ *
+ * The value is not validated, see validate_game_config.
+ *
+ * @param config The config to change.
+ * @param name The name of the setting.
+ * @param value The new value.
+ * @return False if there is no setting of that name.
+ */
+bool set_game_config_value(GameConfig &config, const std::string &name, int value)
+{
+    if (name == "CARD_MAX_NUMBER")
+        config.card_max_number = value;
+    else if (name == "REVERSE_MOVE_DIFF")
+        config.reverse_move_diff = value;
+    else if (name == "CARD_IN_HANDS")
+        config.card_in_hands = value;
+    else if (name == "NUM_CARDS_TO_PLAY")
+        config.num_cards_to_play = value;
+    else if (name == "NUMBER_OF_ROWS")
+        config.number_of_rows = value;
+    else if (name == "NUMBER_OF_PLAYERS")
+        config.number_of_players = value;
+    else if (name == "NUM_SIMULATIONS")
+        config.num_simulations = value;
+    else if (name == "GOOD_MOVE_WINDOW")
+        config.good_move_window = value;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief Reads a "NAME value" configuration file into a validated config.
+ *
+ * Settings missing from the file keep their GameConfig defaults. Unknown
+ * names and lines that are not "NAME value" are errors.
+ *
+ * @param filename The configuration file.
+ * @param config (Output) The loaded config.
+ * @param error (Output) What went wrong, when loading fails.
+ * @return True if the file was read and the config is valid.
+ */
+bool load_game_config(const std::string &filename, GameConfig &config, std::string &error)
+{
+    std::ifstream config_file(filename);
+    if (!config_file)
+    {
+        error = "Cannot open configuration file " + filename;
+        return false;
+    }
+
+    GameConfig loaded;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(config_file, line))
+    {
+        line_number++;
+        std::istringstream iss(line);
+        std::string variable_name;
+        int variable_value;
+        if (!(iss >> variable_name))
+        {
+            continue; // Blank line
+        }
+        if (!(iss >> variable_value))
+        {
+            error = filename + ":" + std::to_string(line_number) + ": expected an integer after " + variable_name;
+            return false;
+        }
+
+        if (!set_game_config_value(loaded, variable_name, variable_value))
+        {
+            error = filename + ":" + std::to_string(line_number) + ": unknown setting " + variable_name;
+            return false;
+        }
+    }
+
+    if (!validate_game_config(loaded, error))
+    {
+        error = filename + ": " + error;
+        return false;
+    }
+    config = loaded;
+    return true;
+}
+
+/**
+ * @brief Prints every setting of a config, one "NAME: value" line each.
+ *
+ * @param config The config to print.
+ */
+void print_game_config(const GameConfig &config)
+{
+    std::cout << "CARD_MAX_NUMBER: " << config.card_max_number << "\n"
+              << "REVERSE_MOVE_DIFF: " << config.reverse_move_diff << "\n"
+              << "CARD_IN_HANDS: " << config.card_in_hands << "\n"
+              << "NUM_CARDS_TO_PLAY: " << config.num_cards_to_play << "\n"
+              << "NUMBER_OF_ROWS: " << config.number_of_rows << "\n"
+              << "NUMBER_OF_PLAYERS: " << config.number_of_players << "\n"
+              << "GOOD_MOVE_WINDOW: " << config.good_move_window << "\n"
+              << "NUM_SIMULATIONS: " << config.num_simulations << "\n";
+}
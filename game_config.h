@@ -0,0 +1,34 @@
+#ifndef GAME_CONFIG_H
+#define GAME_CONFIG_H
+
+#include <string>
+
+/**
+ * @brief The rules and run size of one simulated game variant.
+ *
+ * Loaded and validated once, then only handed around by const reference:
+ * the engine, the move checks and the strategies read the rules from the
+ * config they are given, so several configs can be simulated side by side
+ * in one process.
+ */
+struct GameConfig
+{
+    int card_max_number = 100;  // Cards run from 2 to card_max_number - 1, rows start at 1 and card_max_number
+    int reverse_move_diff = 10; // Difference for a reverse-10 move
+    int card_in_hands = 6;      // Number of cards each player holds
+    int num_cards_to_play = 2;  // Number of cards to play per turn while the draw pile is not empty
+    int number_of_rows = 4;     // Number of playing rows, the first half ascends
+    int number_of_players = 3;  // Number of players in the game
+    int num_simulations = 1000; // Number of games to simulate
+    int good_move_window = 5;   // A move closer than this to the row top is "good"
+};
+
+// Most rows a config may have (rows are bits of a 32-bit mask in the strategies)
+const int MAX_CONFIG_ROWS = 32;
+
+bool validate_game_config(const GameConfig &config, std::string &error);
+bool set_game_config_value(GameConfig &config, const std::string &name, int value);
+bool load_game_config(const std::string &filename, GameConfig &config, std::string &error);
+void print_game_config(const GameConfig &config);
+
+#endif
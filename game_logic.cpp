@@ -1,6 +1,10 @@
 #include "game_logic.h"
  #include "helper_functions.h"
  #include "player_strategies.h"
+ #include "move_cache.h"
+ #include "game_arena.h"
+ #include "card_tracking.h"
+ #include "game_config.h"
 
  #include <iostream>
  #include <numeric>  // std::iota
@@ -8,18 +12,14 @@
  #include <algorithm> // std::remove, std::find
  #include <iomanip> // For std::hex and std::setw
  #include <cstring>
+ #include <cstdlib> // std::abs
 
- // Constants (declared in main.cpp, defined extern here)
- extern int CARD_MAX_NUMBER;  // Maximum value a card can have
- extern int REVERSE_MOVE_DIFF; // Difference needed for a reverse-10 move
- extern int CARD_IN_HANDS;   // Number of cards each player starts with
- extern int NUM_CARDS_TO_PLAY; // Number of cards each player plays per turn
- extern int NUMBER_OF_ROWS;  // Number of rows in the playing area
+ extern bool TRACE_GAMES;    // Print the board before and after every turn
 
  // Player struct
  struct Player
  {
-  std::vector<int> hand;  // The cards the player currently holds
+  Hand hand;  // The cards the player currently holds
   bool active = true; // Flag to indicate if the player is still in the game
  };
 
@@ -32,7 +32,7 @@
   * @param deck_size The current size of the deck.
   * @return True if the game is won, false otherwise.
   */
- bool check_win_condition_multiplayer(const std::vector<Player> &players, int deck_size)
+ bool check_win_condition_multiplayer(const std::pmr::vector<Player> &players, int deck_size)
  {
   // Iterate through each player
   for (const auto &player : players)
@@ -47,70 +47,255 @@
   return true;
  }
 
+ /**
+  * @brief Checks a whole-turn plan against the rules and plays it in one step.
+  *
+  * Moves refer to the hand at the start of the turn. They are played in
+  * order until one is not legal (card index out of range or already played,
+  * unknown row, card not playable on the row); the played cards then leave
+  * the hand in a single pass, keeping the order of the others.
+  *
+  * @param config The game config.
+  * @param plan The moves of the turn, in play order.
+  * @param num_cards The number of cards the turn must play.
+  * @param hand (In/Out) The hand of the player, as at the start of the turn.
+  * @param playing_rows (In/Out) The playing rows.
+  * @param move_cache The engine's move cache (played rows are invalidated).
+  * @param card_tracker The engine's card tracker (played cards are recorded).
+  * @param used Scratch flags, one per card of the hand.
+  * @param played_cards (Output) The cards played, appended in order.
+  * @return True if the plan played exactly num_cards legal moves.
+  */
+ bool apply_turn_plan(const GameConfig &config, const TurnPlan &plan, int num_cards, Hand &hand, PlayingRows &playing_rows, MoveCache &move_cache, CardTracker &card_tracker, std::pmr::vector<char> &used, std::pmr::vector<int> &played_cards)
+ {
+  bool valid_plan = static_cast<int>(plan.size()) == num_cards;
+  int hand_size = hand.size();
+  used.assign(hand_size, 0);
+  for (int m = 0; m < static_cast<int>(plan.size()) && m < num_cards; ++m)
+  {
+   int card_index = plan[m].first;
+   int row_index = plan[m].second;
+   if (card_index < 0 || card_index >= hand_size || used[card_index] || row_index < 0 || row_index >= config.number_of_rows ||
+       is_valid_move(config, hand[card_index], playing_rows[row_index].back(), row_index < config.number_of_rows / 2) == ValidMove::NO)
+   {
+    valid_plan = false;
+    break;
+   }
+   used[card_index] = 1;
+   make_move(hand[card_index], row_index, playing_rows);
+   move_cache.invalidate_row(row_index);
+   card_tracker.card_played(hand[card_index]);
+   played_cards.push_back(hand[card_index]);
+  }
+
+  int kept = 0;
+  for (int i = 0; i < hand_size; ++i)
+  {
+   if (!used[i])
+   {
+    hand[kept++] = hand[i];
+   }
+  }
+  hand.resize(kept);
+  return valid_plan;
+ }
+
+ /**
+  * @brief Deals a game: fills every player's hand from the deck and picks the seat order.
+  *
+  * @param config The game config (hand size).
+  * @param num_players The number of players in the game.
+  * @param initial_deck The initial shuffled deck of cards.
+  * @return The dealt hands, the remaining draw pile and the shuffled player order.
+  */
+ GameSetup setup_game(const GameConfig &config, int num_players, const std::vector<int> &initial_deck)
+ {
+  std::random_device rd;
+  std::mt19937_64 rng(rd());
+  return setup_game(config, num_players, initial_deck, rng);
+ }
+
+ /**
+  * @brief Deals a game like setup_game, but draws the seat order from the given random engine (reproducible runs).
+  *
+  * @param config The game config (hand size).
+  * @param num_players The number of players in the game.
+  * @param initial_deck The initial shuffled deck of cards.
+  * @param rng The random engine of the seat order.
+  * @return The dealt hands, the remaining draw pile and the player order.
+  */
+ GameSetup setup_game(const GameConfig &config, int num_players, const std::vector<int> &initial_deck, std::mt19937_64 &rng)
+ {
+  GameSetup setup;
+  setup.deck = initial_deck;
+  setup.hands.reserve(num_players);
+  for (int p = 0; p < num_players; ++p)
+  {
+   setup.hands.push_back(deal_cards(setup.deck, config.card_in_hands));
+  }
+
+  setup.player_order.resize(num_players);
+  std::iota(setup.player_order.begin(), setup.player_order.end(), 0);
+  shuffle(setup.player_order, rng);
+  return setup;
+ }
+
+ /**
+  * @brief Deck number game of a seed, the same on every thread and for every player count.
+  *
+  * Used wherever a run must be reproducible from a seed (simulation daemon, C API).
+  *
+  * @param card_max_number Cards go from 2 to card_max_number - 1.
+  * @param seed The seed of the run.
+  * @param game The number of the deck in the run.
+  * @return The shuffled deck.
+  */
+ std::vector<int> seeded_deck(int card_max_number, uint64_t seed, int64_t game)
+ {
+  std::vector<int> deck;
+  deck.reserve(card_max_number);
+  for (int card = 2; card < card_max_number; ++card)
+  {
+   deck.push_back(card);
+  }
+  std::seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(game), 0u};
+  std::mt19937_64 rng(sequence);
+  shuffle(deck, rng);
+  return deck;
+ }
+
+ /**
+  * @brief Random engine of the seat order of deck number game of a seed (see seeded_deck and setup_game).
+  */
+ std::mt19937_64 seat_order_rng(uint64_t seed, int64_t game)
+ {
+  std::seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(game), 1u};
+  return std::mt19937_64(sequence);
+ }
+
  /**
   * @brief Simulates a single game in a multiplayer setting.
   *
   * This function manages the game flow, dealing cards, handling player turns,
-  * checking win conditions, and storing the final game state.
+  * checking win conditions, and storing the final game state. Every player uses
+  * the same strategy, with the default strategy parameters.
   *
+  * @param config The game config.
   * @param get_player_move A function pointer to the chosen player strategy.
   * @param num_players The number of players in the game.
   * @param initial_deck The initial shuffled deck of cards.
   * @param turns_taken (Output) The total number of turns taken in the game.
   * @param final_playing_rows (Output) The final state of the playing rows.
   * @param final_hand (Output) The final hands of all players.
+  * @param deck_size_left (Output, optional) The number of cards left in the draw pile at the end (0 if won).
   * @return True if the game was won, false otherwise.
   */
- bool simulate_game_multiplayer(std::pair<int, int> (*get_player_move)(const std::vector<int> &, const std::vector<std::vector<int>> &, const std::vector<Communication>&, int), int num_players, const std::vector<int> &initial_deck, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand)
+ bool simulate_game_multiplayer(const GameConfig &config, StrategyFunction get_player_move, int num_players, const std::vector<int> &initial_deck, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand, int *deck_size_left)
+ {
+  std::vector<StrategyFunction> seat_strategies(num_players, get_player_move);
+  return simulate_game_multiplayer(config, seat_strategies, setup_game(config, num_players, initial_deck), default_strategy_params(config), turns_taken, final_playing_rows, final_hand, deck_size_left);
+ }
+
+ /**
+  * @brief Simulates a single game from an already dealt setup, with one strategy per player.
+  *
+  * @param config The game config (rules of the game).
+  * @param seat_strategies The strategy of each player, indexed like setup.hands.
+  * @param setup The dealt hands, remaining deck and seat order (see setup_game).
+  * @param params The strategy parameters shared by every player (also sets the good-move window of communications).
+  * @param turns_taken (Output) The total number of turns taken in the game.
+  * @param final_playing_rows (Output) The final state of the playing rows.
+  * @param final_hand (Output) The final hands of all players.
+  * @param deck_size_left (Output, optional) The number of cards left in the draw pile at the end (0 if won).
+  * @param record (Output, optional) Every card played and the final state, for comparisons with other engines.
+  * @return True if the game was won, false otherwise.
+  */
+ bool simulate_game_multiplayer(const GameConfig &config, const std::vector<StrategyFunction> &seat_strategies, const GameSetup &setup, const StrategyParams &params, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand, int *deck_size_left, GameRecord *record)
 {
-    std::vector<int> deck = initial_deck;
-    std::vector<Player> players(num_players);
+    // Every container of the game lives in the thread's arena: no malloc once
+    // the arena has grown to the size of a game
+    GameArena &arena = thread_game_arena();
+    arena.reset();
+    std::pmr::memory_resource *memory = arena.resource();
+    if (record != nullptr)
+    {
+        record->moves.clear();
+    }
 
-    for (auto &player : players)
+    int num_players = setup.hands.size();
+    std::pmr::vector<int> deck(setup.deck.begin(), setup.deck.end(), memory);
+    std::pmr::vector<Player> players(memory);
+    players.reserve(num_players);
+
+    for (int p = 0; p < num_players; ++p)
     {
-        player.hand = deal_cards(deck, CARD_IN_HANDS);
+        players.push_back(Player{Hand(memory)});
+        players[p].hand.reserve(config.card_in_hands);
+        players[p].hand.assign(setup.hands[p].begin(), setup.hands[p].end());
     }
 
     int deck_size = deck.size();
 
-    std::vector<std::vector<int>> playing_rows(NUMBER_OF_ROWS);
-    for (int i = 0; i < NUMBER_OF_ROWS; ++i)
+    PlayingRows playing_rows(config.number_of_rows, memory);
+    for (int i = 0; i < config.number_of_rows; ++i)
     {
-        playing_rows[i].push_back(i < NUMBER_OF_ROWS / 2 ? 1 : CARD_MAX_NUMBER);
+        playing_rows[i].reserve(config.card_max_number);
+        playing_rows[i].push_back(i < config.number_of_rows / 2 ? 1 : config.card_max_number);
     }
 
-    std::vector<int> player_order(num_players);
-    std::iota(player_order.begin(), player_order.end(), 0);
-    shuffle(player_order);
+    const std::vector<int> &player_order = setup.player_order;
 
     int current_player_index = 0;
     int turns = 0;
 
-    std::vector<Communication> communications;
+    Communications communications(memory);
+    communications.reserve(num_players * config.card_in_hands * config.number_of_rows);
+    // (card, row) evaluations shared by the communication phase and the strategy
+    // calls of a turn; reused across games played on this thread
+    static thread_local MoveCache move_cache;
+    StrategyContext context{config, params, &move_cache, memory};
+    CardTracker card_tracker(memory); // Unseen cards of every player, updated on every play and draw
+    card_tracker.start_game(config, setup.hands, deck_size);
+    context.cards = &card_tracker;
+
+    Hand hand_copy(memory);                 // What the strategy sees of the hand
+    TurnPlan turn_plan(memory);             // Whole-turn plan of a planning strategy
+    std::pmr::vector<char> plan_used(memory);
+    Hand hand_at_turn_start(memory);        // Reported as the final hand when the turn fails
+    std::pmr::vector<int> played_cards(memory);
+    std::pmr::vector<int> drawn_cards(memory); // Cards drawn *this* turn
+    hand_copy.reserve(config.card_in_hands);
+    hand_at_turn_start.reserve(config.card_in_hands);
+    played_cards.reserve(config.card_in_hands);
+    turn_plan.reserve(config.num_cards_to_play);
+    plan_used.reserve(config.card_in_hands);
+    drawn_cards.reserve(config.card_in_hands);
 
     while (true)
     {
-        Player current_player = players[player_order[current_player_index]];
+        Player &current_player = players[player_order[current_player_index]];
         if (!current_player.active)
         {
             current_player_index = (current_player_index + 1) % num_players;
             continue;
         }
 
+        // Other players moved since this player's last turn
+        move_cache.reset(config);
+
         // --- Communication Phase ---
         communications.clear();
         for (int p_idx = 0; p_idx < num_players; ++p_idx)
         {
             if (players[p_idx].active) {
                 for (int card : players[p_idx].hand) {
-                    for (int r_idx = 0; r_idx < NUMBER_OF_ROWS; ++r_idx) {
-                        bool is_ascending = r_idx < NUMBER_OF_ROWS / 2;
-                        ValidMove vm = is_valid_move(card, playing_rows[r_idx].back(), is_ascending);
+                    for (int r_idx = 0; r_idx < config.number_of_rows; ++r_idx) {
+                        ValidMove vm = move_cache.evaluate(card, r_idx, playing_rows[r_idx].back());
                         if (vm == ValidMove::REVERSE_MOVE)
                         {
                             communications.push_back({p_idx, r_idx, Communication::REVERSE_TRICK, 0});
                         }
-                        else if (vm == ValidMove::EXCELLENT){
+                        else if (vm != ValidMove::NO && std::abs(card - playing_rows[r_idx].back()) < params.good_move_window){
                             communications.push_back({p_idx, r_idx, Communication::GOOD_CARD, 0});
                         }
                     }
@@ -120,27 +305,52 @@
 
         // --- Action Phase ---
         // Display the game state *before* each player's turn
-        std::cout << "---- Player " << player_order[current_player_index] + 1 << " Before Turn ----\n";
-        display_game_state(playing_rows, current_player.hand, deck_size);
+        if (TRACE_GAMES)
+        {
+            std::cout << "---- Player " << player_order[current_player_index] + 1 << " Before Turn ----\n";
+            display_game_state(config, playing_rows, current_player.hand, deck_size);
+        }
 
-        int num_cards_to_play_this_turn = (deck_size > 0) ? NUM_CARDS_TO_PLAY : 1;
+        int num_cards_to_play_this_turn = (deck_size > 0) ? config.num_cards_to_play : 1;
 
         bool valid_turn = true;
-        std::vector<int> played_cards;
-        std::vector<int> drawn_cards; // Cards drawn *this* turn
+        hand_at_turn_start.assign(current_player.hand.begin(), current_player.hand.end());
+        played_cards.clear();
+        drawn_cards.clear();
+        turn_plan.clear();
 
         for (int k = 0; k < num_cards_to_play_this_turn; ++k)
         {
 			// Create a COPY of the hand for the strategy function.  CRITICAL FIX!
-            std::vector<int> hand_copy = current_player.hand;
-            auto move = get_player_move(hand_copy, playing_rows, communications, player_order[current_player_index]); //Pass the copy
+            hand_copy.assign(current_player.hand.begin(), current_player.hand.end());
+            context.cards_to_plan = num_cards_to_play_this_turn - k;
+            context.turn_plan = k == 0 ? &turn_plan : nullptr; // A planning strategy may answer for the whole turn
+            auto move = seat_strategies[player_order[current_player_index]](hand_copy, playing_rows, communications, player_order[current_player_index], context); //Pass the copy
+            context.turn_plan = nullptr;
+            if (!turn_plan.empty())
+            {
+                valid_turn = apply_turn_plan(config, turn_plan, num_cards_to_play_this_turn, current_player.hand, playing_rows, move_cache, card_tracker, plan_used, played_cards);
+                for (size_t m = 0; record != nullptr && m < played_cards.size(); ++m)
+                {
+                    record->moves.push_back({player_order[current_player_index], played_cards[m], turn_plan[m].second});
+                }
+                turns += played_cards.size();
+                break;
+            }
+            // Single-move strategy: play its move and ask again
             int card_index = move.first;
             int row_index = move.second;
 
             if (card_index != -1) {
                 int card_to_play = current_player.hand[card_index]; // Use ORIGINAL hand here
                 make_move(card_to_play, row_index, playing_rows);
+                move_cache.invalidate_row(row_index); // Only this row's top changed
+                card_tracker.card_played(card_to_play);
                 played_cards.push_back(card_to_play);
+                if (record != nullptr)
+                {
+                    record->moves.push_back({player_order[current_player_index], card_to_play, row_index});
+                }
 
                 // Remove the card by index *immediately* (STILL CORRECT)
                 current_player.hand.erase(current_player.hand.begin() + card_index);
@@ -154,36 +364,41 @@
 
 
         // --- Replenish Hand (AT THE END OF THE TURN) ---
-        while (current_player.hand.size() < CARD_IN_HANDS && deck_size > 0) {
+        while (current_player.hand.size() < config.card_in_hands && deck_size > 0) {
             current_player.hand.push_back(deck.back());
             drawn_cards.push_back(deck.back()); // Track drawn cards
+            card_tracker.card_drawn(player_order[current_player_index], deck.back());
             deck.pop_back();
             deck_size--;
         }
 
         if (!valid_turn)
         {
+            current_player.hand.swap(hand_at_turn_start);
             break;
         }
 
         // --- Output for Debugging/Visualization (After playing AND drawing) ---
-        std::cout << "---- Player " << player_order[current_player_index] + 1 << " After Turn ----\n";
-        display_game_state(playing_rows, current_player.hand, deck_size); // Show correct hand
-        std::cout << "Played cards: ";
-        for (int card : played_cards) {
-            std::cout << card << " ";
-        }
-        std::cout << std::endl;
-        std::cout << "Deck cards: ";
-        for (int card : deck) {
-            std::cout << card << " ";
-        }
-        std::cout << std::endl;
-        std::cout << "Drawn cards: ";
-        for (int card : drawn_cards) {
-            std::cout << card << " ";
+        if (TRACE_GAMES)
+        {
+            std::cout << "---- Player " << player_order[current_player_index] + 1 << " After Turn ----\n";
+            display_game_state(config, playing_rows, current_player.hand, deck_size); // Show correct hand
+            std::cout << "Played cards: ";
+            for (int card : played_cards) {
+                std::cout << card << " ";
+            }
+            std::cout << "\n";
+            std::cout << "Deck cards: ";
+            for (int card : deck) {
+                std::cout << card << " ";
+            }
+            std::cout << "\n";
+            std::cout << "Drawn cards: ";
+            for (int card : drawn_cards) {
+                std::cout << card << " ";
+            }
+            std::cout << "\n";
         }
-        std::cout << std::endl;
         // --- End Output ---
 
 
@@ -193,8 +408,6 @@
             current_player.active = false;
         }
 
-        players[player_order[current_player_index]] = current_player;
-
         current_player_index = (current_player_index + 1) % num_players;
 
         // Check for game over (all players inactive)
@@ -213,14 +426,39 @@
         }
     }
 
-    for (const auto &player : players)
+    move_cache.flush_stats();
+
+    // Overwrite the outputs in place so that callers reusing them do not reallocate
+    final_hand.resize(num_players);
+    for (int p = 0; p < num_players; ++p)
     {
-        final_hand.push_back(player.hand);
+        final_hand[p].assign(players[p].hand.begin(), players[p].hand.end());
+    }
+    final_playing_rows.resize(config.number_of_rows);
+    for (int i = 0; i < config.number_of_rows; ++i)
+    {
+        final_playing_rows[i].assign(playing_rows[i].begin(), playing_rows[i].end());
     }
 
     turns_taken = turns;
-    final_playing_rows = playing_rows;
-    return check_win_condition_multiplayer(players, deck_size);
+    if (deck_size_left != nullptr)
+    {
+        *deck_size_left = deck_size;
+    }
+    bool won = check_win_condition_multiplayer(players, deck_size);
+    if (record != nullptr)
+    {
+        record->hands = final_hand;
+        record->row_tops.resize(config.number_of_rows);
+        for (int i = 0; i < config.number_of_rows; ++i)
+        {
+            record->row_tops[i] = playing_rows[i].back();
+        }
+        record->turns = turns;
+        record->deck_size = deck_size;
+        record->won = won;
+    }
+    return won;
 }
  
  // Base64 encoding functions (simplified, you might want to use a library)
@@ -375,4 +613,22 @@ std::string generate_deck_id(const std::vector<int> &deck) {
 
     // Base64 encode the resulting string
     return base64::encode(deck_str);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes a 64-bit ID of a shuffled deck (FNV-1a over the card values).
+ *
+ * Much cheaper than generate_deck_id, for the result records.
+ *
+ * @param deck The shuffled deck.
+ * @return The hash of the card sequence.
+ */
+uint64_t deck_hash(const std::vector<int> &deck)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int card : deck)
+    {
+        hash = (hash ^ static_cast<uint64_t>(card)) * 1099511628211ULL;
+    }
+    return hash;
+}
@@ -1,16 +1,58 @@
 #ifndef GAME_LOGIC_H
 #define GAME_LOGIC_H
 
+#include <cstdint>
 #include <vector>
 #include <utility>
 #include <string>
+#include <memory_resource>
+#include <random>
+
+#include "player_strategies.h"
 
 // Add forward declaration of Communication here
 struct Communication;
 struct Player; // Forward declare Player
+struct GameConfig;
+
+// Everything decided before the first move of a game: the dealt hands, the
+// remaining draw pile and the seat order. Building it once per deck lets
+// several strategy line-ups be played on exactly the same deal.
+struct GameSetup
+{
+    std::vector<int> deck;               // Cards left to draw after dealing (drawn from the back)
+    std::vector<std::vector<int>> hands; // Initial hand of each player
+    std::vector<int> player_order;       // Order in which players take turns
+};
+
+// One card played: who played it, which card and on which row
+struct PlayedMove
+{
+    int player;
+    int card;
+    int row;
+};
+
+// What an engine reports about a finished game when asked for a full record
+// (differential checks between engines, see differential_harness.h)
+struct GameRecord
+{
+    std::vector<PlayedMove> moves;       // Every card played, in order
+    std::vector<std::vector<int>> hands; // Final hand of each player (hand from the start of a failed turn)
+    std::vector<int> row_tops;           // Final top of every row
+    int turns = 0;                       // Cards played
+    int deck_size = 0;                   // Cards left in the draw pile
+    bool won = false;
+};
 
-bool check_win_condition_multiplayer(const std::vector<Player> &players, int deck_size);
-bool simulate_game_multiplayer(std::pair<int, int> (*get_player_move)(const std::vector<int> &, const std::vector<std::vector<int>> &, const std::vector<Communication>&, int), int num_players, const std::vector<int> &initial_deck, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand);
+bool check_win_condition_multiplayer(const std::pmr::vector<Player> &players, int deck_size);
+GameSetup setup_game(const GameConfig &config, int num_players, const std::vector<int> &initial_deck);
+GameSetup setup_game(const GameConfig &config, int num_players, const std::vector<int> &initial_deck, std::mt19937_64 &rng);
+std::vector<int> seeded_deck(int card_max_number, uint64_t seed, int64_t game);
+std::mt19937_64 seat_order_rng(uint64_t seed, int64_t game);
+bool simulate_game_multiplayer(const GameConfig &config, const std::vector<StrategyFunction> &seat_strategies, const GameSetup &setup, const StrategyParams &params, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand, int *deck_size_left = nullptr, GameRecord *record = nullptr);
+bool simulate_game_multiplayer(const GameConfig &config, StrategyFunction get_player_move, int num_players, const std::vector<int> &initial_deck, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand, int *deck_size_left = nullptr);
 std::string generate_deck_id(const std::vector<int> &deck);
+uint64_t deck_hash(const std::vector<int> &deck);
 
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,448 @@
+#include "game_snapshot.h"
+#include "card_tracking.h"
+#include "helper_functions.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory_resource>
+
+namespace {
+
+// Skips inactive players and sets up the current player's turn
+void begin_turn(const GameConfig &config, GameSnapshot &snapshot)
+{
+    while (!snapshot.active[current_snapshot_player(snapshot)])
+    {
+        snapshot.current_player_index = (snapshot.current_player_index + 1) % snapshot.num_players;
+    }
+    int player = current_snapshot_player(snapshot);
+    snapshot.cards_this_turn = snapshot.deck_size > 0 ? config.num_cards_to_play : 1;
+    snapshot.cards_left = snapshot.cards_this_turn;
+    snapshot.turn_number++;
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        snapshot.turn_start_tops[r] = snapshot.row_tops[r];
+    }
+    snapshot.turn_start_hand_size = snapshot.hand_sizes[player];
+    for (int k = 0; k < snapshot.hand_sizes[player]; ++k)
+    {
+        snapshot.turn_start_hand[k] = snapshot.hands[player][k];
+    }
+}
+
+void finish_game(GameSnapshot &snapshot)
+{
+    snapshot.finished = true;
+    snapshot.won = snapshot.deck_size == 0;
+    for (int p = 0; p < snapshot.num_players; ++p)
+    {
+        snapshot.won = snapshot.won && snapshot.hand_sizes[p] == 0;
+    }
+}
+
+// Refills the current player's hand, then moves on to the next player (or ends the game)
+void end_turn(const GameConfig &config, GameSnapshot &snapshot, bool valid_turn, CardTracker *cards)
+{
+    int player = current_snapshot_player(snapshot);
+    while (snapshot.hand_sizes[player] < config.card_in_hands && snapshot.deck_size > 0)
+    {
+        int card = snapshot.deck[--snapshot.deck_size];
+        snapshot.hands[player][snapshot.hand_sizes[player]++] = card;
+        if (cards)
+        {
+            cards->card_drawn(player, card);
+        }
+    }
+    snapshot.cards_left = 0;
+    if (!valid_turn)
+    {
+        // The engine reports the hand from before the turn; only the outcome matters here
+        finish_game(snapshot);
+        return;
+    }
+    if (snapshot.hand_sizes[player] == 0 && snapshot.deck_size == 0)
+    {
+        snapshot.active[player] = 0;
+    }
+    snapshot.current_player_index = (snapshot.current_player_index + 1) % snapshot.num_players;
+
+    bool all_players_done = true;
+    for (int p = 0; p < snapshot.num_players; ++p)
+    {
+        all_players_done = all_players_done && !snapshot.active[p];
+    }
+    if (all_players_done)
+    {
+        finish_game(snapshot);
+        return;
+    }
+    begin_turn(config, snapshot);
+}
+
+} // namespace
+
+/**
+ * @brief Checks that every game of a config fits in a GameSnapshot.
+ *
+ * @param config The game config.
+ * @param num_players The number of players.
+ * @param error (Output) Which limit is exceeded, if any.
+ * @return True if the games fit.
+ */
+bool check_snapshot_capacity(const GameConfig &config, int num_players, std::string &error)
+{
+    if (config.card_max_number >= SNAPSHOT_MAX_CARDS || num_players > SNAPSHOT_MAX_PLAYERS || config.card_in_hands > SNAPSHOT_MAX_HAND)
+    {
+        error = "game snapshots hold cards below " + std::to_string(SNAPSHOT_MAX_CARDS) + ", at most " +
+                std::to_string(SNAPSHOT_MAX_PLAYERS) + " players and " + std::to_string(SNAPSHOT_MAX_HAND) + " cards per hand";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Builds the snapshot of a dealt game, waiting for the first decision.
+ *
+ * @param config The game config (must pass check_snapshot_capacity).
+ * @param setup The dealt hands, remaining deck and seat order.
+ * @param snapshot (Output) The snapshot.
+ */
+void start_snapshot(const GameConfig &config, const GameSetup &setup, GameSnapshot &snapshot)
+{
+    snapshot = GameSnapshot();
+    snapshot.num_players = setup.hands.size();
+    snapshot.deck_size = setup.deck.size();
+    for (size_t k = 0; k < setup.deck.size(); ++k)
+    {
+        snapshot.deck[k] = setup.deck[k];
+    }
+    for (int p = 0; p < snapshot.num_players; ++p)
+    {
+        snapshot.hand_sizes[p] = setup.hands[p].size();
+        for (size_t k = 0; k < setup.hands[p].size(); ++k)
+        {
+            snapshot.hands[p][k] = setup.hands[p][k];
+        }
+        snapshot.active[p] = 1;
+        snapshot.player_order[p] = setup.player_order[p];
+    }
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        snapshot.row_tops[r] = r < config.number_of_rows / 2 ? 1 : config.card_max_number;
+    }
+    begin_turn(config, snapshot);
+}
+
+int current_snapshot_player(const GameSnapshot &snapshot)
+{
+    return snapshot.player_order[snapshot.current_player_index];
+}
+
+SnapshotDecision::SnapshotDecision() : scratch_(64 * 1024), memory_(scratch_.data(), scratch_.size())
+{
+}
+
+/**
+ * @brief Points the decision at a snapshot; what the strategies are handed is built on the first ask.
+ *
+ * @param config The game config.
+ * @param snapshot The game, waiting for a decision (must outlive the asks).
+ * @param params The strategy parameters.
+ */
+void SnapshotDecision::start(const GameConfig &config, const GameSnapshot &snapshot, const StrategyParams &params)
+{
+    config_ = &config;
+    snapshot_ = &snapshot;
+    params_ = params;
+    built_ = false;
+}
+
+// Builds the hand, the row tops and the announcements of the turn, and resets the move cache to the row tops
+void SnapshotDecision::build()
+{
+    const GameConfig &config = *config_;
+    const GameSnapshot &snapshot = *snapshot_;
+    int player = current_snapshot_player(snapshot);
+    hand_.assign(snapshot.hands[player], snapshot.hands[player] + snapshot.hand_sizes[player]);
+    playing_rows_.resize(config.number_of_rows);
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        playing_rows_[r].assign(1, snapshot.row_tops[r]);
+    }
+
+    communications_.clear();
+    for (int p = 0; p < snapshot.num_players; ++p)
+    {
+        if (!snapshot.active[p])
+        {
+            continue;
+        }
+        const uint8_t *cards = p == player ? snapshot.turn_start_hand : snapshot.hands[p];
+        int num_cards = p == player ? snapshot.turn_start_hand_size : snapshot.hand_sizes[p];
+        for (int k = 0; k < num_cards; ++k)
+        {
+            for (int r = 0; r < config.number_of_rows; ++r)
+            {
+                int row_top = snapshot.turn_start_tops[r];
+                ValidMove vm = is_valid_move(config, cards[k], row_top, r < config.number_of_rows / 2);
+                if (vm == ValidMove::REVERSE_MOVE)
+                {
+                    communications_.push_back({p, r, Communication::REVERSE_TRICK, 0});
+                }
+                else if (vm != ValidMove::NO && std::abs(cards[k] - row_top) < params_.good_move_window)
+                {
+                    communications_.push_back({p, r, Communication::GOOD_CARD, 0});
+                }
+            }
+        }
+    }
+    cache_.reset(config);
+    built_ = true;
+}
+
+// Asks the strategy; {-2, -2} if it answered with a whole-turn plan (stored in plan)
+std::pair<int, int> SnapshotDecision::ask(StrategyFunction strategy, const CardTracker *cards, SnapshotTurnPlan *plan)
+{
+    if (!built_)
+    {
+        build();
+    }
+    const GameConfig &config = *config_;
+    const GameSnapshot &snapshot = *snapshot_;
+    memory_.release();
+    StrategyContext context{config, params_, &cache_, &memory_};
+    context.cards = cards;
+    context.cards_to_plan = snapshot.cards_left;
+    turn_plan_.clear();
+    context.turn_plan = plan != nullptr ? &turn_plan_ : nullptr;
+    std::pair<int, int> move = strategy(hand_, playing_rows_, communications_, current_snapshot_player(snapshot), context);
+    if (turn_plan_.empty())
+    {
+        return move;
+    }
+
+    // Check the plan as apply_turn_plan does: its legal prefix is played, then the turn fails if anything was wrong
+    *plan = SnapshotTurnPlan();
+    plan->legal = static_cast<int>(turn_plan_.size()) == snapshot.cards_left;
+    bool used[SNAPSHOT_MAX_HAND] = {};
+    uint8_t tops[MAX_CONFIG_ROWS];
+    std::copy(snapshot.row_tops, snapshot.row_tops + config.number_of_rows, tops);
+    for (int m = 0; m < static_cast<int>(turn_plan_.size()) && m < snapshot.cards_left; ++m)
+    {
+        auto [card_index, row] = turn_plan_[m];
+        if (card_index < 0 || card_index >= static_cast<int>(hand_.size()) || used[card_index] || row < 0 || row >= config.number_of_rows ||
+            is_valid_move(config, hand_[card_index], tops[row], row < config.number_of_rows / 2) == ValidMove::NO)
+        {
+            plan->legal = false;
+            break;
+        }
+        used[card_index] = true;
+        tops[row] = hand_[card_index];
+        plan->cards[plan->size] = hand_[card_index];
+        plan->rows[plan->size++] = row;
+    }
+    return {-2, -2};
+}
+
+/**
+ * @brief Asks a strategy for the move of the current player; a whole-turn planner replans the rest of the turn at every move.
+ *
+ * @param strategy The strategy of the current player.
+ * @param cards The card tracker of the game, or nullptr.
+ * @return The move, {card index in the current hand, row}, or {-1, -1}.
+ */
+std::pair<int, int> SnapshotDecision::decide(StrategyFunction strategy, const CardTracker *cards)
+{
+    return ask(strategy, cards, nullptr);
+}
+
+/**
+ * @brief Asks a strategy for the move of the current player, playing whole-turn plans as the engine does.
+ *
+ * On the first move of a turn a planning strategy may answer for the whole
+ * turn; the plan is kept in plan and its moves are returned one by one
+ * without asking the strategy again, so the turn is exactly the one
+ * simulate_game_multiplayer plays. An illegal plan fails the turn after its
+ * legal prefix, like apply_turn_plan (except a plan longer than the turn
+ * whose first moves are all legal: the engine fails that turn, here it is played).
+ *
+ * @param strategy The strategy of the current player.
+ * @param cards The card tracker of the game, or nullptr.
+ * @param plan (In/Out) The plan of this player and strategy, kept between calls.
+ * @return The move, {card index in the current hand, row}, or {-1, -1}.
+ */
+std::pair<int, int> SnapshotDecision::decide(StrategyFunction strategy, const CardTracker *cards, SnapshotTurnPlan &plan)
+{
+    const GameSnapshot &snapshot = *snapshot_;
+    if (snapshot.cards_left == snapshot.cards_this_turn)
+    {
+        plan = SnapshotTurnPlan();
+        std::pair<int, int> move = ask(strategy, cards, &plan);
+        if (move.first != -2)
+        {
+            return move;
+        }
+    }
+    else if (plan.size == 0 && plan.legal)
+    {
+        return ask(strategy, cards, nullptr);
+    }
+
+    if (plan.next == plan.size)
+    {
+        return {-1, -1}; // Illegal plan, its legal moves are played
+    }
+    int player = current_snapshot_player(snapshot);
+    int card = plan.cards[plan.next];
+    int row = plan.rows[plan.next++];
+    int index = std::find(snapshot.hands[player], snapshot.hands[player] + snapshot.hand_sizes[player], card) - snapshot.hands[player];
+    return {index, row};
+}
+
+/**
+ * @brief Asks a strategy for the move of the current player, as simulate_game_multiplayer would.
+ *
+ * The announcements are rebuilt from the hands and row tops at the start of
+ * the turn, and a card tracker is handed over only if one is given (kept in
+ * step by apply_snapshot_move). A whole-turn planner replans the rest of the
+ * turn at every move.
+ *
+ * @param config The game config.
+ * @param snapshot The game, waiting for a decision.
+ * @param strategy The strategy of the current player.
+ * @param params The strategy parameters.
+ * @param cards The card tracker of the game, or nullptr.
+ * @return The move, {card index in the current hand, row}, or {-1, -1}.
+ */
+std::pair<int, int> decide_snapshot_move(const GameConfig &config, const GameSnapshot &snapshot, StrategyFunction strategy, const StrategyParams &params, const CardTracker *cards)
+{
+    static thread_local SnapshotDecision decision;
+    decision.start(config, snapshot, params);
+    return decision.decide(strategy, cards);
+}
+
+/**
+ * @brief Asks a strategy for the move of the current player, playing whole-turn plans as the engine does (see SnapshotDecision::decide).
+ *
+ * @param config The game config.
+ * @param snapshot The game, waiting for a decision.
+ * @param strategy The strategy of the current player.
+ * @param params The strategy parameters.
+ * @param cards The card tracker of the game, or nullptr.
+ * @param plan (In/Out) The plan of this player and strategy, kept between calls.
+ * @return The move, {card index in the current hand, row}, or {-1, -1}.
+ */
+std::pair<int, int> decide_snapshot_move(const GameConfig &config, const GameSnapshot &snapshot, StrategyFunction strategy, const StrategyParams &params, const CardTracker *cards, SnapshotTurnPlan &plan)
+{
+    static thread_local SnapshotDecision decision;
+    decision.start(config, snapshot, params);
+    return decision.decide(strategy, cards, plan);
+}
+
+/**
+ * @brief Lists every legal move of the current player.
+ *
+ * @param config The game config.
+ * @param snapshot The game, waiting for a decision.
+ * @param moves (Output) Room for SNAPSHOT_MAX_HAND x MAX_CONFIG_ROWS moves.
+ * @return The number of legal moves.
+ */
+int list_legal_moves(const GameConfig &config, const GameSnapshot &snapshot, std::pair<int, int> *moves)
+{
+    int player = current_snapshot_player(snapshot);
+    int count = 0;
+    for (int i = 0; i < snapshot.hand_sizes[player]; ++i)
+    {
+        for (int r = 0; r < config.number_of_rows; ++r)
+        {
+            if (is_valid_move(config, snapshot.hands[player][i], snapshot.row_tops[r], r < config.number_of_rows / 2) != ValidMove::NO)
+            {
+                moves[count++] = {i, r};
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Plays a move of the current player and advances to the next decision (or the end).
+ *
+ * {-1, -1} fails the turn, which loses the game.
+ *
+ * @param config The game config.
+ * @param snapshot The game, waiting for a decision.
+ * @param move {card index in the current hand, row}, legal or {-1, -1}.
+ * @param cards The card tracker of the game, or nullptr: records the play and the draws.
+ */
+void apply_snapshot_move(const GameConfig &config, GameSnapshot &snapshot, std::pair<int, int> move, CardTracker *cards)
+{
+    if (move.first == -1)
+    {
+        // The engine would ask again for the remaining cards of the turn and get the same answer
+        end_turn(config, snapshot, false, cards);
+        return;
+    }
+    int player = current_snapshot_player(snapshot);
+    uint8_t *hand = snapshot.hands[player];
+    snapshot.row_tops[move.second] = hand[move.first];
+    if (cards)
+    {
+        cards->card_played(hand[move.first]);
+    }
+    for (int k = move.first + 1; k < snapshot.hand_sizes[player]; ++k)
+    {
+        hand[k - 1] = hand[k];
+    }
+    snapshot.hand_sizes[player]--;
+    snapshot.turns++;
+    if (--snapshot.cards_left == 0)
+    {
+        end_turn(config, snapshot, true, cards);
+    }
+}
+
+/**
+ * @brief Deals a tracked game: the snapshot, the card tracker of the deal and no plan.
+ *
+ * @param config The game config (must pass check_snapshot_capacity).
+ * @param setup The dealt hands, remaining deck and seat order.
+ */
+void TrackedGame::start(const GameConfig &config, const GameSetup &setup)
+{
+    start_snapshot(config, setup, game);
+    cards.start_game(config, setup.hands, setup.deck.size());
+    plan = SnapshotTurnPlan();
+}
+
+/**
+ * @brief Plays a move the strategy did not choose (an alternative tried by an analysis).
+ *
+ * The plan the strategy was following no longer applies, so a planner
+ * replans the rest of the turn at every move, as if asked move by move.
+ *
+ * @param config The game config.
+ * @param tracked The game, waiting for a decision.
+ * @param move {card index in the current hand, row}, legal or {-1, -1}.
+ */
+void force_tracked_move(const GameConfig &config, TrackedGame &tracked, std::pair<int, int> move)
+{
+    apply_snapshot_move(config, tracked.game, move, &tracked.cards);
+    tracked.plan = SnapshotTurnPlan();
+}
+
+/**
+ * @brief Finishes a game with every seat using the same strategy, with the card tracker and whole-turn plans.
+ *
+ * @param config The game config.
+ * @param tracked The game to play out; finished on return.
+ * @param strategy The strategy of every player.
+ * @param params The strategy parameters.
+ */
+void play_tracked_to_end(const GameConfig &config, TrackedGame &tracked, StrategyFunction strategy, const StrategyParams &params)
+{
+    while (!tracked.game.finished)
+    {
+        apply_snapshot_move(config, tracked.game, decide_snapshot_move(config, tracked.game, strategy, params, &tracked.cards, tracked.plan), &tracked.cards);
+    }
+}
+
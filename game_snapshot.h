@@ -0,0 +1,132 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "card_tracking.h"
+#include "game_config.h"
+#include "game_logic.h"
+#include "move_cache.h"
+#include "player_strategies.h"
+
+const int SNAPSHOT_MAX_CARDS = 256;  // Cards are stored as bytes: card_max_number must be below this
+const int SNAPSHOT_MAX_PLAYERS = 8;  // Most players a snapshot can hold
+const int SNAPSHOT_MAX_HAND = 16;    // Most cards in a hand
+
+/**
+ * @brief A whole game stopped at a decision, in a fixed-size, trivially copyable form.
+ *
+ * Forking a game is a plain copy of the struct (no allocation, no pointer to
+ * fix up), so thousands of forks per game stay cheap. Only the row tops are
+ * kept, as strategies never look below them. An unfinished snapshot always
+ * waits for a decision of the current player.
+ */
+struct GameSnapshot
+{
+    uint8_t deck[SNAPSHOT_MAX_CARDS]; // Drawn from the back
+    uint8_t hands[SNAPSHOT_MAX_PLAYERS][SNAPSHOT_MAX_HAND];
+    uint8_t hand_sizes[SNAPSHOT_MAX_PLAYERS];
+    uint8_t active[SNAPSHOT_MAX_PLAYERS];
+    uint8_t player_order[SNAPSHOT_MAX_PLAYERS];
+    uint8_t row_tops[MAX_CONFIG_ROWS];
+    uint8_t turn_start_tops[MAX_CONFIG_ROWS];           // Row tops when the turn began (announcements)
+    uint8_t turn_start_hand[SNAPSHOT_MAX_HAND];         // Current player's hand when the turn began
+    uint8_t turn_start_hand_size;
+    int16_t deck_size;
+    uint8_t num_players;
+    uint8_t current_player_index; // Index into player_order
+    uint8_t cards_left;           // Cards still to play this turn
+    uint8_t cards_this_turn;      // Cards to play this turn
+    int16_t turns;                // Cards played
+    int16_t turn_number;          // Player turns begun, from 1
+    bool finished;
+    bool won;
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots are forked by copying");
+
+/**
+ * @brief The whole-turn plan a player is following, kept next to a snapshot by callers that play plans as the engine does.
+ *
+ * A plan belongs to one player and strategy, not to the game, so several
+ * strategies deciding on one snapshot each keep their own.
+ */
+struct SnapshotTurnPlan
+{
+    uint8_t cards[SNAPSHOT_MAX_HAND]; // Planned cards (values, not hand indices) and rows, in play order
+    uint8_t rows[SNAPSHOT_MAX_HAND];
+    uint8_t size = 0;
+    uint8_t next = 0;   // Next planned move to play
+    bool legal = true;  // False: the turn fails once the planned moves run out
+};
+
+/**
+ * @brief A snapshot game with its card tracker and the whole-turn plan of its strategy, played as the reference engine plays it.
+ *
+ * For games with one strategy at every seat (a plan starts afresh every
+ * turn). A fork is a copy of all three; the tracker allocates, the rest is
+ * plain data.
+ */
+struct TrackedGame
+{
+    GameSnapshot game;
+    CardTracker cards;
+    SnapshotTurnPlan plan;
+
+    void start(const GameConfig &config, const GameSetup &setup);
+};
+
+/**
+ * @brief What the strategies deciding on one snapshot are handed, built once for all of them.
+ *
+ * The hand, the row tops and the announcements of a decision are the same
+ * for every strategy asked, so callers asking several strategies on one
+ * snapshot (the shared-prefix tree) build them once and the strategies share
+ * one move cache of the row tops. Nothing is built until a strategy is
+ * actually asked: moves taken from a plan cost nothing.
+ */
+class SnapshotDecision
+{
+public:
+    SnapshotDecision();
+    SnapshotDecision(const SnapshotDecision &) = delete;
+    SnapshotDecision &operator=(const SnapshotDecision &) = delete;
+
+    void start(const GameConfig &config, const GameSnapshot &snapshot, const StrategyParams &params);
+    std::pair<int, int> decide(StrategyFunction strategy, const CardTracker *cards);
+    std::pair<int, int> decide(StrategyFunction strategy, const CardTracker *cards, SnapshotTurnPlan &plan);
+
+private:
+    void build();
+    std::pair<int, int> ask(StrategyFunction strategy, const CardTracker *cards, SnapshotTurnPlan *plan);
+
+    const GameConfig *config_ = nullptr;
+    const GameSnapshot *snapshot_ = nullptr;
+    StrategyParams params_{};
+    bool built_ = false;
+    Hand hand_;
+    PlayingRows playing_rows_;
+    Communications communications_;
+    TurnPlan turn_plan_;
+    MoveCache cache_;
+    std::vector<std::byte> scratch_;            // Scratch allocations of the strategies, dropped before every ask
+    std::pmr::monotonic_buffer_resource memory_;
+};
+
+bool check_snapshot_capacity(const GameConfig &config, int num_players, std::string &error);
+void start_snapshot(const GameConfig &config, const GameSetup &setup, GameSnapshot &snapshot);
+int current_snapshot_player(const GameSnapshot &snapshot);
+std::pair<int, int> decide_snapshot_move(const GameConfig &config, const GameSnapshot &snapshot, StrategyFunction strategy, const StrategyParams &params, const CardTracker *cards = nullptr);
+std::pair<int, int> decide_snapshot_move(const GameConfig &config, const GameSnapshot &snapshot, StrategyFunction strategy, const StrategyParams &params, const CardTracker *cards, SnapshotTurnPlan &plan);
+int list_legal_moves(const GameConfig &config, const GameSnapshot &snapshot, std::pair<int, int> *moves);
+void apply_snapshot_move(const GameConfig &config, GameSnapshot &snapshot, std::pair<int, int> move, CardTracker *cards = nullptr);
+void force_tracked_move(const GameConfig &config, TrackedGame &tracked, std::pair<int, int> move);
+void play_tracked_to_end(const GameConfig &config, TrackedGame &tracked, StrategyFunction strategy, const StrategyParams &params);
+
+#endif
@@ -1,16 +1,9 @@
 #include "helper_functions.h"
+#include "game_config.h"
 #include <random>
 #include <iostream>
 #include <algorithm>
 
-// Constants (declared in main.cpp, defined extern here)
-extern int CARD_MAX_NUMBER;   // Maximum value of a card in the deck
-extern int REVERSE_MOVE_DIFF; // Difference required for a reverse move
-extern int CARD_IN_HANDS;     // Number of cards each player holds
-extern int NUM_CARDS_TO_PLAY; // Number of cards a player must play each turn
-extern int NUMBER_OF_ROWS;    // Number of rows in the playing area
-extern int GOOD_MOVE_WINDOW;  // Internal for good moves
-
 /**
  * @brief Shuffles the order of elements within a vector.
  *
@@ -29,19 +22,31 @@ void shuffle(std::vector<int> &deck)
     std::shuffle(deck.begin(), deck.end(), g);
 }
 
+/**
+ * @brief Shuffles the order of elements within a vector with a given random engine (reproducible runs).
+ *
+ * @param deck The vector to be shuffled.
+ * @param rng The random engine, advanced by the shuffle.
+ */
+void shuffle(std::vector<int> &deck, std::mt19937_64 &rng)
+{
+    std::shuffle(deck.begin(), deck.end(), rng);
+}
+
 /**
  * @brief Creates a standard deck of cards for the game.
  *
  * The deck contains cards with values ranging from 2 up to (but not including)
- * CARD_MAX_NUMBER. The cards are then shuffled.
+ * config.card_max_number. The cards are then shuffled.
  *
+ * @param config The game config.
  * @return A vector representing the created and shuffled deck.
  */
-std::vector<int> create_deck()
+std::vector<int> create_deck(const GameConfig &config)
 {
     std::vector<int> deck;
     // Populate the deck with card values
-    for (int i = 2; i < CARD_MAX_NUMBER; ++i)
+    for (int i = 2; i < config.card_max_number; ++i)
     {
         deck.push_back(i);
     }
@@ -79,16 +84,17 @@ std::vector<int> deal_cards(std::vector<int> &deck, int num_cards)
  * This includes the current cards in each playing row (ascending and descending),
  * the cards in the player's hand, and the number of cards remaining in the deck.
  *
+ * @param config The game config.
  * @param playing_rows A 2D vector representing the playing rows.
  * @param hand The player's current hand of cards.
  * @param deck_size The number of cards remaining in the deck.
  */
-void display_game_state(const std::vector<std::vector<int>> &playing_rows, const std::vector<int> &hand, int deck_size)
+void display_game_state(const GameConfig &config, const PlayingRows &playing_rows, const Hand &hand, int deck_size)
 {
     // Display the cards in each playing row
-    for (int i = 0; i < NUMBER_OF_ROWS; ++i)
+    for (int i = 0; i < config.number_of_rows; ++i)
     {
-        std::cout << (i < NUMBER_OF_ROWS / 2 ? "Ascending: " : "Descending: "); // Indicate if the row is ascending or descending
+        std::cout << (i < config.number_of_rows / 2 ? "Ascending: " : "Descending: "); // Indicate if the row is ascending or descending
         for (int card : playing_rows[i])
         {
             std::cout << card << " "; // Print each card in the row
@@ -109,28 +115,29 @@ void display_game_state(const std::vector<std::vector<int>> &playing_rows, const
  *
  * A move is valid if:
  * - For ascending rows: the card is greater than the top card of the row,
- * OR the card is equal to the top card minus REVERSE_MOVE_DIFF (reverse move, if allowed).
+ * OR the card is equal to the top card minus reverse_move_diff (reverse move, if allowed).
  * - For descending rows: the card is less than the top card of the row,
- * OR the card is equal to the top card plus REVERSE_MOVE_DIFF (reverse move, if allowed).
+ * OR the card is equal to the top card plus reverse_move_diff (reverse move, if allowed).
  *
+ * @param config The game config (reverse difference and good-move window).
  * @param card The card being played.
  * @param row_top The value of the top card in the row.
  * @param is_ascending True if the row is ascending, false if descending.
  * @param reverse_move_allowed True if reverse moves are allowed, false otherwise.
  * @return ValidMove enum indicating if the move is valid, invalid, or a reverse move.
  */
-ValidMove is_valid_move(int card, int row_top, bool is_ascending, bool reverse_move_allowed)
+ValidMove is_valid_move(const GameConfig &config, int card, int row_top, bool is_ascending, bool reverse_move_allowed)
 {
     if (is_ascending)
     {
         // Ascending row logic
-        if (card == row_top - REVERSE_MOVE_DIFF && reverse_move_allowed)
+        if (card == row_top - config.reverse_move_diff && reverse_move_allowed)
         {
             return ValidMove::REVERSE_MOVE; // Reverse move is valid
         }
-        else if (card > row_top && card - row_top < GOOD_MOVE_WINDOW)
+        else if (card > row_top && card - row_top < config.good_move_window)
         {
-            return ValidMove::EXCELLENT; // Card is greater than the top card but less than GOOD_MOVE_WINDOW
+            return ValidMove::EXCELLENT; // Card is greater than the top card but less than good_move_window
         }
         else if (card > row_top)
         {
@@ -144,13 +151,13 @@ ValidMove is_valid_move(int card, int row_top, bool is_ascending, bool reverse_m
     else
     {
         // Descending row logic
-        if (card == row_top + REVERSE_MOVE_DIFF && reverse_move_allowed)
+        if (card == row_top + config.reverse_move_diff && reverse_move_allowed)
         {
             return ValidMove::REVERSE_MOVE; // Reverse move is valid
         }
-        else if (card < row_top && row_top - card < GOOD_MOVE_WINDOW)
+        else if (card < row_top && row_top - card < config.good_move_window)
         {
-            return ValidMove::EXCELLENT; // Card is less than the top card but less than GOOD_MOVE_WINDOW
+            return ValidMove::EXCELLENT; // Card is less than the top card but less than good_move_window
         }
         else if (card < row_top)
         {
@@ -172,7 +179,7 @@ ValidMove is_valid_move(int card, int row_top, bool is_ascending, bool reverse_m
  * @param row_index The index of the row to add the card to.
  * @param playing_rows A 2D vector representing the playing rows. Passed by reference to modify the original.
  */
-void make_move(int card, int row_index, std::vector<std::vector<int>> &playing_rows)
+void make_move(int card, int row_index, PlayingRows &playing_rows)
 {
     playing_rows[row_index].push_back(card); // Add the card to the specified row
 }
\ No newline at end of file
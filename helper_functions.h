@@ -2,20 +2,28 @@
 #define HELPER_FUNCTIONS_H
 
 #include <vector>
+#include <memory_resource>
+#include <random>
 
 struct Communication;
+struct GameConfig;
 
+// Cards of a hand and of the playing rows during a game. They allocate from the
+// game's memory resource (the per-thread arena of the engine, see game_arena.h).
+using Hand = std::pmr::vector<int>;
+using PlayingRows = std::pmr::vector<std::pmr::vector<int>>;
 
 void shuffle(std::vector<int> &deck);
-std::vector<int> create_deck();
+void shuffle(std::vector<int> &deck, std::mt19937_64 &rng);
+std::vector<int> create_deck(const GameConfig &config);
 std::vector<int> deal_cards(std::vector<int> &deck, int num_cards);
-void display_game_state(const std::vector<std::vector<int>> &playing_rows, const std::vector<int> &hand, int deck_size);
+void display_game_state(const GameConfig &config, const PlayingRows &playing_rows, const Hand &hand, int deck_size);
 enum class ValidMove {
     EXCELLENT,
     YES,
     REVERSE_MOVE,
     NO
 };
-ValidMove is_valid_move(int card, int row_top, bool is_ascending, bool reverse_move_allowed = true);
-void make_move(int card, int row_index, std::vector<std::vector<int>> &playing_rows);
+ValidMove is_valid_move(const GameConfig &config, int card, int row_top, bool is_ascending, bool reverse_move_allowed = true);
+void make_move(int card, int row_index, PlayingRows &playing_rows);
 #endif
\ No newline at end of file
@@ -0,0 +1,351 @@
+#include "job_spec.h"
+
+#include <cctype>
+#include <climits>
+
+namespace {
+
+// Reads the small JSON subset of job specs: objects, arrays of strings, strings, integers and booleans.
+class JsonReader
+{
+public:
+    explicit JsonReader(const std::string &text) : text_(text) {}
+
+    bool at_end()
+    {
+        skip_spaces();
+        return pos_ == text_.size();
+    }
+
+    bool consume(char c)
+    {
+        skip_spaces();
+        if (pos_ < text_.size() && text_[pos_] == c)
+        {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        skip_spaces();
+        return pos_ < text_.size() && text_[pos_] == c;
+    }
+
+    bool read_string(std::string &value)
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+        value.clear();
+        while (pos_ < text_.size() && text_[pos_] != '"')
+        {
+            char c = text_[pos_++];
+            if (c == '\\')
+            {
+                if (pos_ == text_.size())
+                {
+                    return false;
+                }
+                char escaped = text_[pos_++];
+                switch (escaped)
+                {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '"': case '\\': case '/': c = escaped; break;
+                default: return false; // \u and friends are not needed for names and ids
+                }
+            }
+            value += c;
+        }
+        return pos_ < text_.size() && text_[pos_++] == '"';
+    }
+
+    bool read_integer(long long &value)
+    {
+        skip_spaces();
+        size_t start = pos_;
+        if (pos_ < text_.size() && text_[pos_] == '-')
+        {
+            pos_++;
+        }
+        unsigned long long magnitude = 0;
+        size_t digits_start = pos_;
+        while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_])))
+        {
+            if (magnitude > (ULLONG_MAX - 9) / 10)
+            {
+                return false;
+            }
+            magnitude = magnitude * 10 + (text_[pos_++] - '0');
+        }
+        if (pos_ == digits_start || magnitude > static_cast<unsigned long long>(LLONG_MAX))
+        {
+            return false;
+        }
+        value = text_[start] == '-' ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude);
+        return true;
+    }
+
+    bool read_bool(bool &value)
+    {
+        skip_spaces();
+        if (text_.compare(pos_, 4, "true") == 0)
+        {
+            pos_ += 4;
+            value = true;
+            return true;
+        }
+        if (text_.compare(pos_, 5, "false") == 0)
+        {
+            pos_ += 5;
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const std::string &text_;
+    size_t pos_ = 0;
+
+    void skip_spaces()
+    {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+        {
+            pos_++;
+        }
+    }
+};
+
+bool read_int_in_range(JsonReader &reader, const std::string &key, long long low, long long high, long long &value, std::string &error)
+{
+    if (!reader.read_integer(value) || value < low || value > high)
+    {
+        error = "\"" + key + "\" must be an integer between " + std::to_string(low) + " and " + std::to_string(high);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Parses one JSON job line of the daemon and validates its rules.
+ *
+ * @param line The JSON object.
+ * @param defaults The rules the job starts from (the daemon's config).
+ * @param job (Output) The parsed job.
+ * @param error (Output) What is wrong with the line, when parsing fails.
+ * @return True if the line is a valid job.
+ */
+bool parse_job_spec(const std::string &line, const GameConfig &defaults, JobSpec &job, std::string &error)
+{
+    job = JobSpec();
+    job.config = defaults;
+    JsonReader reader(line);
+    if (!reader.consume('{'))
+    {
+        error = "a job is a JSON object on one line";
+        return false;
+    }
+
+    bool has_players = false;
+    long long players = 0;
+    std::vector<std::pair<std::string, long long>> overrides;
+    bool first = true;
+    while (!reader.consume('}'))
+    {
+        if (!first && !reader.consume(','))
+        {
+            error = "expected ',' or '}' between fields";
+            return false;
+        }
+        first = false;
+        std::string key;
+        if (!reader.read_string(key) || !reader.consume(':'))
+        {
+            error = "expected \"name\": value";
+            return false;
+        }
+
+        long long number = 0;
+        if (key == "id")
+        {
+            bool is_string = reader.peek('"');
+            if (is_string ? !reader.read_string(job.id) : !reader.read_integer(number))
+            {
+                error = "\"id\" must be a string or an integer";
+                return false;
+            }
+            if (!is_string)
+            {
+                job.id = std::to_string(number);
+            }
+        }
+        else if (key == "priority")
+        {
+            if (!read_int_in_range(reader, key, INT_MIN, INT_MAX, number, error))
+                return false;
+            job.priority = number;
+        }
+        else if (key == "games")
+        {
+            if (!read_int_in_range(reader, key, 1, MAX_JOB_GAMES, number, error))
+                return false;
+            job.num_games = number;
+        }
+        else if (key == "seed")
+        {
+            if (!read_int_in_range(reader, key, 0, LLONG_MAX, number, error))
+                return false;
+            job.seeded = true;
+            job.seed = number;
+        }
+        else if (key == "players")
+        {
+            if (!read_int_in_range(reader, key, 1, INT_MAX, players, error))
+                return false;
+            has_players = true;
+        }
+        else if (key == "strategies")
+        {
+            if (!reader.consume('['))
+            {
+                error = "\"strategies\" must be an array of names";
+                return false;
+            }
+            for (bool first_name = true; !reader.consume(']'); first_name = false)
+            {
+                std::string name;
+                if ((!first_name && !reader.consume(',')) || !reader.read_string(name))
+                {
+                    error = "\"strategies\" must be an array of names";
+                    return false;
+                }
+                job.strategies.push_back(name);
+            }
+        }
+        else if (key == "config_file")
+        {
+            std::string filename;
+            if (!reader.read_string(filename))
+            {
+                error = "\"config_file\" must be a file name";
+                return false;
+            }
+            if (!load_game_config(filename, job.config, error))
+            {
+                return false;
+            }
+        }
+        else if (key == "config")
+        {
+            if (!reader.consume('{'))
+            {
+                error = "\"config\" must be an object of settings";
+                return false;
+            }
+            for (bool first_setting = true; !reader.consume('}'); first_setting = false)
+            {
+                std::string name;
+                if ((!first_setting && !reader.consume(',')) || !reader.read_string(name) || !reader.consume(':') ||
+                    !read_int_in_range(reader, name, INT_MIN, INT_MAX, number, error))
+                {
+                    if (error.empty())
+                        error = "\"config\" must be an object of integer settings";
+                    return false;
+                }
+                overrides.push_back({name, number});
+            }
+        }
+        else if (key == "shutdown")
+        {
+            if (!reader.read_bool(job.shutdown))
+            {
+                error = "\"shutdown\" must be true or false";
+                return false;
+            }
+        }
+        else
+        {
+            error = "unknown field \"" + key + "\"";
+            return false;
+        }
+    }
+    if (!reader.at_end())
+    {
+        error = "unexpected text after the job object";
+        return false;
+    }
+
+    // Overrides apply on top of config_file, wherever it appears in the line
+    for (const auto &[name, value] : overrides)
+    {
+        if (!set_game_config_value(job.config, name, value))
+        {
+            error = "unknown setting " + name;
+            return false;
+        }
+    }
+    if (has_players)
+    {
+        job.config.number_of_players = players;
+    }
+    if (!validate_game_config(job.config, error))
+    {
+        return false;
+    }
+    if (job.num_games == 0)
+    {
+        job.num_games = job.config.num_simulations;
+    }
+    if (job.num_games <= 0)
+    {
+        error = "the job plays no games (no \"games\" and NUM_SIMULATIONS is 0)";
+        return false;
+    }
+    if (job.num_games > MAX_JOB_GAMES)
+    {
+        error = "the job plays more than " + std::to_string(MAX_JOB_GAMES) + " games (NUM_SIMULATIONS without \"games\")";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Escapes a string for use inside JSON quotes.
+ */
+std::string json_escape(const std::string &text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\t': escaped += "\\t"; break;
+        case '\r': escaped += "\\r"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                const char hex[] = "0123456789abcdef";
+                escaped += "\\u00";
+                escaped += hex[(c >> 4) & 0xf];
+                escaped += hex[c & 0xf];
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
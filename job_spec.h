@@ -0,0 +1,37 @@
+#ifndef JOB_SPEC_H
+#define JOB_SPEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game_config.h"
+
+const int MAX_JOB_GAMES = 10000000; // Most games of one job (its chunks are all queued when it arrives)
+
+/**
+ * @brief One simulation job sent to the daemon, parsed from a single JSON line.
+ *
+ * {"id": "sweep-3p", "priority": 5, "games": 2000, "seed": 42,
+ *  "strategies": ["A1", "K"], "players": 3, "config": {"CARD_IN_HANDS": 7}}
+ *
+ * Every field is optional. The rules start from the daemon's config (or from
+ * "config_file"), then "config" and "players" override single settings.
+ * {"shutdown": true} asks the daemon to finish its queue and exit.
+ */
+struct JobSpec
+{
+    std::string id;                      // Echoed in every answer about the job
+    int priority = 0;                    // Higher runs first, equal priorities in arrival order
+    int num_games = 0;                   // Decks to play, 0 = NUM_SIMULATIONS of the config
+    bool seeded = false;                 // False = the daemon picks a seed (and reports it)
+    uint64_t seed = 0;                   // Same seed and deck size = same decks and seat orders
+    std::vector<std::string> strategies; // Empty = every strategy of the daemon
+    GameConfig config;
+    bool shutdown = false;
+};
+
+bool parse_job_spec(const std::string &line, const GameConfig &defaults, JobSpec &job, std::string &error);
+std::string json_escape(const std::string &text);
+
+#endif
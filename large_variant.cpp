@@ -0,0 +1,330 @@
+#include "large_variant.h"
+#include "game_arena.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Number of cards held by the players, by card value (Fenwick tree).
+ *
+ * Adding or removing a card and counting the cards between two values are
+ * O(log n) in the number of card values.
+ */
+class HeldCardCounts
+{
+public:
+    void reset(int card_max_number)
+    {
+        tree_.assign(card_max_number + 1, 0);
+    }
+
+    void add(int card, int delta)
+    {
+        for (int i = card; i < static_cast<int>(tree_.size()); i += i & -i)
+        {
+            tree_[i] += delta;
+        }
+    }
+
+    // Cards strictly between low and high
+    int count_between(int low, int high) const
+    {
+        if (high - low < 2)
+        {
+            return 0;
+        }
+        return count_up_to(high - 1) - count_up_to(low);
+    }
+
+private:
+    std::vector<int> tree_;
+
+    int count_up_to(int card) const
+    {
+        int count = 0;
+        for (int i = std::min(card, static_cast<int>(tree_.size()) - 1); i > 0; i -= i & -i)
+        {
+            count += tree_[i];
+        }
+        return count;
+    }
+};
+
+using SortedHand = std::pmr::set<int>;
+
+// Cards of hand strictly between low and high (the window of a good move is a few values wide)
+int count_own_between(const SortedHand &hand, int low, int high)
+{
+    int count = 0;
+    for (auto it = hand.upper_bound(low); it != hand.end() && *it < high; ++it)
+    {
+        count++;
+    }
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief Plays one game with strategy A1 (or A2) on indexed hands, for decks, tables and row counts far above the standard game.
+ *
+ * Gives the same game as simulate_game_multiplayer with A1 (use_claims) or
+ * A2 at every seat, but nothing is ever scanned card by card:
+ * - every hand is a sorted set, so the closest playable card of a row is a
+ *   lower_bound, and playing or drawing a card is O(log hand);
+ * - the owner of every card value is known, so a reverse trick is one lookup;
+ * - a Fenwick tree counts the held cards by value, so "another player
+ *   announces a good card on this row" is two prefix sums per row instead of
+ *   a scan of every hand.
+ * Ties between equally good moves go to the card held the longest, then to
+ * the lowest row, as in the standard engine's hand order. The claim penalty
+ * must be at least 1 (a move never beats a closer one on the same row).
+ *
+ * @param config The game config.
+ * @param setup The dealt hands, remaining deck and seat order (see setup_game).
+ * @param params The strategy parameters (claim penalty and good-move window).
+ * @param use_claims True to play A1 (avoid rows claimed by other players), false for A2.
+ * @param turns_taken (Output) The number of cards played.
+ * @param deck_size_left (Output, optional) The number of cards left in the draw pile at the end.
+ * @param record (Output, optional) Every card played and the final state, for comparisons with other engines.
+ * @return True if the game was won, false otherwise.
+ */
+bool simulate_game_large(const GameConfig &config, const GameSetup &setup, const StrategyParams &params, bool use_claims, int &turns_taken, int *deck_size_left, GameRecord *record)
+{
+    GameArena &arena = thread_game_arena();
+    arena.reset();
+    std::pmr::memory_resource *memory = arena.resource();
+
+    const int num_players = setup.hands.size();
+    const int num_rows = config.number_of_rows;
+    const int max_card = config.card_max_number;
+
+    std::pmr::vector<int> owner(max_card + 1, -1, memory);   // Player holding each card value, or -1
+    std::pmr::vector<long long> held_since(max_card + 1, 0, memory); // When the card entered its hand
+    std::pmr::vector<SortedHand> hands(num_players, memory);
+    std::pmr::vector<char> active(num_players, 1, memory);
+    static thread_local HeldCardCounts held; // Tree storage reused between games of this thread
+    held.reset(max_card);
+    long long clock = 0;
+
+    auto take_card = [&](int player, int card) {
+        hands[player].insert(card);
+        owner[card] = player;
+        held_since[card] = clock++;
+        held.add(card, 1);
+    };
+    auto play_card = [&](int player, int card) {
+        hands[player].erase(card);
+        owner[card] = -1;
+        held.add(card, -1);
+    };
+
+    for (int p = 0; p < num_players; ++p)
+    {
+        for (int card : setup.hands[p])
+        {
+            take_card(p, card);
+        }
+    }
+    std::pmr::vector<int> deck(setup.deck.begin(), setup.deck.end(), memory);
+    std::pmr::vector<int> row_tops(num_rows, memory);
+    for (int r = 0; r < num_rows; ++r)
+    {
+        row_tops[r] = r < num_rows / 2 ? 1 : max_card;
+    }
+    std::pmr::vector<char> claimed(num_rows, 0, memory);
+
+    int current_player_index = 0;
+    int turns = 0;
+    int players_left = num_players;
+    bool valid_turn = true;
+    int failed_player = -1;
+    std::pmr::vector<int> turn_start_hand(memory);
+    if (record != nullptr)
+    {
+        record->moves.clear();
+    }
+    while (players_left > 0)
+    {
+        int player = setup.player_order[current_player_index];
+        current_player_index = (current_player_index + 1) % num_players;
+        if (!active[player])
+        {
+            continue;
+        }
+        SortedHand &hand = hands[player];
+        if (record != nullptr)
+        {
+            // The hand of a failed turn is reported as it was when the turn began, in the order it was received
+            turn_start_hand.assign(hand.begin(), hand.end());
+            std::sort(turn_start_hand.begin(), turn_start_hand.end(), [&](int a, int b) { return held_since[a] < held_since[b]; });
+        }
+
+        // --- Claims: another player announces a reverse trick or a good card on the row ---
+        for (int r = 0; r < num_rows && use_claims; ++r)
+        {
+            int top = row_tops[r];
+            bool ascending = r < num_rows / 2;
+            int reverse = ascending ? top - config.reverse_move_diff : top + config.reverse_move_diff;
+            bool reverse_claim = reverse >= 0 && reverse <= max_card && owner[reverse] != -1 && owner[reverse] != player;
+            int low = ascending ? top : top - params.good_move_window;
+            int high = ascending ? top + params.good_move_window : top;
+            claimed[r] = reverse_claim || held.count_between(low, high) > count_own_between(hand, low, high);
+        }
+
+        // --- Action: closest card of every row, best row wins ---
+        int num_cards_to_play_this_turn = deck.empty() ? 1 : config.num_cards_to_play;
+        for (int k = 0; k < num_cards_to_play_this_turn; ++k)
+        {
+            int best_card = -1, best_row = -1;
+            long long best_diff = std::numeric_limits<long long>::max();
+            for (int r = 0; r < num_rows; ++r)
+            {
+                int top = row_tops[r];
+                bool ascending = r < num_rows / 2;
+                int reverse = ascending ? top - config.reverse_move_diff : top + config.reverse_move_diff;
+                int card = -1;
+                long long diff = -1;
+                if (reverse >= 0 && reverse <= max_card && owner[reverse] == player)
+                {
+                    card = reverse;
+                }
+                else
+                {
+                    auto it = ascending ? hand.upper_bound(top) : hand.lower_bound(top);
+                    if (ascending ? it == hand.end() : it == hand.begin())
+                    {
+                        continue;
+                    }
+                    card = ascending ? *it : *std::prev(it);
+                    diff = std::abs(card - top);
+                    if (claimed[r] && diff > params.good_move_window)
+                    {
+                        diff *= params.claimed_row_penalty;
+                    }
+                }
+                if (diff < best_diff || (diff == best_diff && best_card != -1 && held_since[card] < held_since[best_card]))
+                {
+                    best_diff = diff;
+                    best_card = card;
+                    best_row = r;
+                }
+            }
+            if (best_card == -1)
+            {
+                valid_turn = false;
+                break;
+            }
+            play_card(player, best_card);
+            row_tops[best_row] = best_card;
+            if (record != nullptr)
+            {
+                record->moves.push_back({player, best_card, best_row});
+            }
+            turns++;
+        }
+
+        // --- Replenish the hand ---
+        while (static_cast<int>(hand.size()) < config.card_in_hands && !deck.empty())
+        {
+            take_card(player, deck.back());
+            deck.pop_back();
+        }
+        if (!valid_turn)
+        {
+            failed_player = player;
+            break;
+        }
+        if (hand.empty() && deck.empty())
+        {
+            active[player] = 0;
+            players_left--;
+        }
+    }
+
+    turns_taken = turns;
+    if (deck_size_left != nullptr)
+    {
+        *deck_size_left = deck.size();
+    }
+    if (record != nullptr)
+    {
+        record->hands.resize(num_players);
+        for (int p = 0; p < num_players; ++p)
+        {
+            record->hands[p].assign(hands[p].begin(), hands[p].end());
+            std::sort(record->hands[p].begin(), record->hands[p].end(), [&](int a, int b) { return held_since[a] < held_since[b]; });
+        }
+        if (failed_player != -1)
+        {
+            record->hands[failed_player].assign(turn_start_hand.begin(), turn_start_hand.end());
+        }
+        record->row_tops.assign(row_tops.begin(), row_tops.end());
+        record->turns = turns;
+        record->deck_size = deck.size();
+        record->won = valid_turn && players_left == 0;
+    }
+    return valid_turn && players_left == 0;
+}
+
+/**
+ * @brief Plays num_games decks of a (possibly very large) variant with the indexed engine and reports the speed.
+ *
+ * @param config The game config.
+ * @param strategy_name A1 or A2, the strategies the indexed engine plays.
+ * @param num_games The number of decks to play.
+ * @param num_threads The number of worker threads.
+ */
+void run_large_variant(const GameConfig &config, const std::string &strategy_name, int num_games, int num_threads)
+{
+    if (strategy_name != "A1" && strategy_name != "A2")
+    {
+        std::cerr << "Error: The large engine plays strategy A1 or A2, not '" << strategy_name << "'\n";
+        return;
+    }
+    StrategyParams params = default_strategy_params(config);
+    if (params.claimed_row_penalty < 1)
+    {
+        std::cerr << "Error: The large engine needs a claim penalty of at least 1\n";
+        return;
+    }
+    bool use_claims = strategy_name == "A1";
+    std::vector<int> initial_deck = create_deck(config);
+
+    int workers = std::max(1, std::min(num_threads, num_games));
+    std::vector<long long> worker_wins(workers, 0), worker_cards(workers, 0);
+    auto start = std::chrono::steady_clock::now();
+    parallel_for_chunks(num_games, workers, [&](int begin, int end, int worker) {
+        for (int game = begin; game < end; ++game)
+        {
+            std::vector<int> game_deck = initial_deck;
+            shuffle(game_deck);
+            GameSetup setup = setup_game(config, config.number_of_players, game_deck);
+            int turns = 0;
+            worker_wins[worker] += simulate_game_large(config, setup, params, use_claims, turns);
+            worker_cards[worker] += turns;
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long wins = 0, cards = 0;
+    for (int w = 0; w < workers; ++w)
+    {
+        wins += worker_wins[w];
+        cards += worker_cards[w];
+    }
+    std::cout << config.number_of_players << " Players, " << config.number_of_rows << " rows, cards 2-" << config.card_max_number - 1
+              << ", " << num_games << " decks (indexed engine):\n";
+    std::cout << strategy_name << " win rate: " << (num_games > 0 ? 100.0 * wins / num_games : 0.0) << " % (average cards played: "
+              << (num_games > 0 ? static_cast<double>(cards) / num_games : 0.0) << ")\n";
+    std::cout << cards << " cards played in " << seconds << " s (" << (cards > 0 ? seconds * 1e9 / cards : 0.0) << " ns per card, deal included)\n";
+}
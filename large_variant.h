@@ -0,0 +1,13 @@
+#ifndef LARGE_VARIANT_H
+#define LARGE_VARIANT_H
+
+#include <string>
+
+#include "game_config.h"
+#include "game_logic.h"
+#include "player_strategies.h"
+
+bool simulate_game_large(const GameConfig &config, const GameSetup &setup, const StrategyParams &params, bool use_claims, int &turns_taken, int *deck_size_left = nullptr, GameRecord *record = nullptr);
+void run_large_variant(const GameConfig &config, const std::string &strategy_name, int num_games, int num_threads);
+
+#endif
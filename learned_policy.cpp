@@ -0,0 +1,294 @@
+#include "learned_policy.h"
+#include "weighted_strategy.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
+
+// Trained with: ./the_game train-policy --seed 1 --metric cards (mpconfig.txt: 3 players, 1000 deals per candidate)
+const PolicyWeights DEFAULT_POLICY_WEIGHTS = {{-1.106f, 1.192f, 1.410f, 0.723f, -0.469f, -0.021f, -0.082f}};
+
+namespace {
+
+const char *const FEATURE_NAMES[POLICY_FEATURES] = {"DISTANCE", "REVERSE_TRICK", "GOOD_MOVE", "PLAYABLE_AFTER", "MIN_GAP", "BLOCKING", "CLAIMED_ROW"};
+
+// Any non-zero lookahead weight makes compute_move_features fill every feature
+const FeatureWeights ALL_FEATURES = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, true};
+
+// Weights strategy L plays with, set once before any game
+PolicyWeights strategy_policy = DEFAULT_POLICY_WEIGHTS;
+
+typedef float PolicyLanes __attribute__((vector_size(POLICY_LANES * sizeof(float))));
+
+int padded_size(int num_moves)
+{
+    return (num_moves + POLICY_LANES - 1) / POLICY_LANES * POLICY_LANES;
+}
+
+} // namespace
+
+const char *policy_feature_name(int feature)
+{
+    return FEATURE_NAMES[feature];
+}
+
+/**
+ * @brief Reads policy weights, one "NAME value" line per feature (unlisted features weigh 0).
+ *
+ * @param filename The weights file (as written by save_policy_weights).
+ * @param weights (Output) The weights.
+ * @param error (Output) Why the file cannot be read.
+ * @return True if the weights were read.
+ */
+bool load_policy_weights(const std::string &filename, PolicyWeights &weights, std::string &error)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        error = "Cannot open policy file " + filename;
+        return false;
+    }
+    PolicyWeights loaded = {};
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        std::istringstream iss(line);
+        std::string name;
+        float value;
+        if (!(iss >> name) || name[0] == '#')
+        {
+            continue; // Blank line or comment
+        }
+        int feature = 0;
+        while (feature < POLICY_FEATURES && name != FEATURE_NAMES[feature])
+        {
+            feature++;
+        }
+        if (feature == POLICY_FEATURES || !(iss >> value))
+        {
+            error = filename + ":" + std::to_string(line_number) + ": expected a feature name and its weight";
+            return false;
+        }
+        loaded.weights[feature] = value;
+    }
+    weights = loaded;
+    return true;
+}
+
+/**
+ * @brief Writes policy weights in the format of load_policy_weights.
+ *
+ * @return True if the file was written.
+ */
+bool save_policy_weights(const std::string &filename, const PolicyWeights &weights, std::string &error)
+{
+    std::ofstream file(filename);
+    for (int f = 0; f < POLICY_FEATURES; ++f)
+    {
+        file << FEATURE_NAMES[f] << " " << weights.weights[f] << "\n";
+    }
+    if (!file)
+    {
+        error = "Cannot write policy file " + filename;
+        return false;
+    }
+    return true;
+}
+
+void PolicyBatch::clear()
+{
+    num_moves = 0;
+    decision_begin.assign(1, 0);
+    num_rows.clear();
+}
+
+/**
+ * @brief Adds the moves of one decision (every card of the hand on every row) and their features.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications What the players announced this turn.
+ * @param player_id The id of the deciding player.
+ * @param context The strategy context handed over by the engine.
+ */
+void PolicyBatch::append(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    static thread_local FeatureGrid grid; // Reused between decisions of this thread
+    compute_move_features(hand, playing_rows, communications, player_id, context, ALL_FEATURES, grid);
+
+    int begin = num_moves;
+    int count = grid.num_cards * grid.num_rows;
+    num_moves += count;
+    size_t padded = padded_size(num_moves);
+    if (score.size() < padded)
+    {
+        for (auto &feature : features)
+        {
+            feature.resize(padded);
+        }
+        score.resize(padded);
+        legal.resize(padded);
+    }
+
+    float scale = 1.0f / context.config.card_max_number;
+    for (int index = 0; index < count; ++index)
+    {
+        int move = begin + index;
+        ValidMove valid_move = grid.valid_move[index];
+        features[POLICY_DISTANCE][move] = grid.distance[index] * scale;
+        features[POLICY_REVERSE_TRICK][move] = grid.reverse_trick[index];
+        features[POLICY_GOOD_MOVE][move] = valid_move == ValidMove::EXCELLENT || valid_move == ValidMove::REVERSE_MOVE;
+        features[POLICY_PLAYABLE_AFTER][move] = grid.playable_after[index];
+        features[POLICY_MIN_GAP][move] = grid.min_gap[index] * scale;
+        features[POLICY_BLOCKING][move] = grid.blocking[index];
+        features[POLICY_CLAIMED_ROW][move] = grid.claimed_row[index];
+        legal[move] = valid_move != ValidMove::NO;
+    }
+    for (size_t move = num_moves; move < padded; ++move)
+    {
+        legal[move] = 0; // Padding of the last vector
+    }
+    decision_begin.push_back(num_moves);
+    num_rows.push_back(grid.num_rows);
+}
+
+/**
+ * @brief Scores every move of the batch: one multiply-add per feature over whole vectors of POLICY_LANES moves.
+ *
+ * The lanes are a GCC vector type, so each step is a vector multiply and
+ * add (two SSE instructions on plain x86-64, one AVX instruction with
+ * -mavx) whatever the optimisation level.
+ *
+ * @param weights The policy weights.
+ */
+void PolicyBatch::score_moves(const PolicyWeights &weights)
+{
+    int padded = padded_size(num_moves);
+    for (int move = 0; move < padded; move += POLICY_LANES)
+    {
+        PolicyLanes sum = {};
+        for (int f = 0; f < POLICY_FEATURES; ++f)
+        {
+            PolicyLanes x;
+            std::memcpy(&x, features[f].data() + move, sizeof(x)); // Unaligned vector load
+            sum += weights.weights[f] * x;
+        }
+        std::memcpy(score.data() + move, &sum, sizeof(sum));
+    }
+}
+
+/**
+ * @brief The legal move with the highest score of one decision (ties go to the first card, then the first row).
+ *
+ * @param decision The decision, in the order they were appended.
+ * @return The card index and row index, or {-1, -1} if no move is legal.
+ */
+std::pair<int, int> PolicyBatch::best_move(int decision) const
+{
+    int best = -1;
+    for (int move = decision_begin[decision]; move < decision_begin[decision + 1]; ++move)
+    {
+        if (legal[move] && (best == -1 || score[move] > score[best]))
+        {
+            best = move;
+        }
+    }
+    if (best == -1)
+    {
+        return {-1, -1};
+    }
+    int index = best - decision_begin[decision];
+    return {index / num_rows[decision], index % num_rows[decision]};
+}
+
+PolicyDecider::PolicyDecider(const GameConfig &config, const PolicyWeights &weights) : config_(config), weights_(weights)
+{
+}
+
+/**
+ * @brief Collects the features of every move of every request, scores them all in one pass and picks each request's best move.
+ */
+void PolicyDecider::decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions)
+{
+    static thread_local std::byte buffer[16 * 1024];
+    static thread_local std::byte scratch_buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource memory(buffer, sizeof(buffer));
+
+    StrategyParams strategy_params{params.claimed_row_penalty, params.panic_threshold, params.good_move_window};
+    Hand hand(&memory);
+    PlayingRows playing_rows(config_.number_of_rows, &memory);
+    Communications communications(&memory);
+    for (auto &row : playing_rows)
+    {
+        row.resize(1); // Features only look at the top of a row
+    }
+
+    batch_.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        const thegame_decision_request &request = requests[i];
+        hand.assign(request.hand, request.hand + request.hand_size);
+        for (int r = 0; r < config_.number_of_rows; ++r)
+        {
+            playing_rows[r][0] = request.row_tops[r];
+        }
+        communications.clear();
+        for (int c = 0; c < request.num_communications; ++c)
+        {
+            const thegame_communication &comm = request.communications[c];
+            communications.push_back({comm.player_id, comm.row_index, static_cast<Communication::CommType>(comm.type), comm.relative_value});
+        }
+        std::pmr::monotonic_buffer_resource scratch(scratch_buffer, sizeof(scratch_buffer));
+        StrategyContext context{config_, strategy_params, nullptr, &scratch};
+        batch_.append(hand, playing_rows, communications, request.player_id, context);
+    }
+
+    batch_.score_moves(weights_);
+    for (int i = 0; i < count; ++i)
+    {
+        std::pair<int, int> move = batch_.best_move(i);
+        decisions[i] = {move.first, move.second};
+    }
+}
+
+/**
+ * @brief Sets the weights strategy L plays with (DEFAULT_POLICY_WEIGHTS until then).
+ */
+void set_strategy_policy(const PolicyWeights &weights)
+{
+    strategy_policy = weights;
+}
+
+/**
+ * @brief The weights strategy L plays with.
+ */
+const PolicyWeights &get_strategy_policy()
+{
+    return strategy_policy;
+}
+
+/**
+ * @brief Strategy L: Learned Linear Policy
+ *
+ * Plays the legal move with the highest weighted sum of its features, with
+ * weights trained by self-play (train-policy mode) and loaded with --policy.
+ * Same choices as PolicyDecider, one decision at a time.
+ *
+ * @param hand The player's hand.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications The list of communications from other players.
+ * @param player_id The ID of the current player.
+ * @param context The strategy context handed over by the engine.
+ * @return A pair containing the best card index and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_L(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    static thread_local PolicyBatch batch;
+    batch.clear();
+    batch.append(hand, playing_rows, communications, player_id, context);
+    batch.score_moves(strategy_policy);
+    return batch.best_move(0);
+}
@@ -0,0 +1,78 @@
+#ifndef LEARNED_POLICY_H
+#define LEARNED_POLICY_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "game_config.h"
+#include "lockstep_engine.h"
+#include "player_strategies.h"
+
+// Features of a (card, row) move scored by the learned policy
+enum PolicyFeature
+{
+    POLICY_DISTANCE,       // |card - row top| / CARD_MAX_NUMBER, -1 / CARD_MAX_NUMBER for a reverse trick
+    POLICY_REVERSE_TRICK,  // 1 if the move is a reverse trick
+    POLICY_GOOD_MOVE,      // 1 if the move is closer than GOOD_MOVE_WINDOW (or a reverse trick)
+    POLICY_PLAYABLE_AFTER, // Other cards of the hand still playable after the move
+    POLICY_MIN_GAP,        // Smallest gap left between a remaining card and a row top, / CARD_MAX_NUMBER
+    POLICY_BLOCKING,       // Other cards of the hand left behind the new row top
+    POLICY_CLAIMED_ROW,    // 1 if another player claimed the row and the move is not a good one
+    POLICY_FEATURES
+};
+
+const int POLICY_LANES = 8; // Moves scored together by one pass of the scoring loop
+
+// Weights of the linear policy: the legal move with the highest weighted sum of its features is played
+struct PolicyWeights
+{
+    float weights[POLICY_FEATURES];
+};
+
+extern const PolicyWeights DEFAULT_POLICY_WEIGHTS; // Trained with the train-policy mode on mpconfig.txt
+
+const char *policy_feature_name(int feature);
+bool load_policy_weights(const std::string &filename, PolicyWeights &weights, std::string &error);
+bool save_policy_weights(const std::string &filename, const PolicyWeights &weights, std::string &error);
+
+/**
+ * @brief The moves of many decisions and their features, one array per feature (structure of arrays).
+ *
+ * Every array is padded to a multiple of POLICY_LANES so that the scoring
+ * loop runs over whole vectors, with no scalar tail.
+ */
+struct PolicyBatch
+{
+    int num_moves = 0;                              // Moves of all decisions (before padding)
+    std::vector<float> features[POLICY_FEATURES];
+    std::vector<float> score;
+    std::vector<uint8_t> legal;
+    std::vector<int> decision_begin;                // Moves of decision d: [decision_begin[d], decision_begin[d + 1])
+    std::vector<int> num_rows;                      // Rows of each decision (move index = card * rows + row)
+
+    PolicyBatch() { clear(); }
+    void clear();
+    void append(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+    void score_moves(const PolicyWeights &weights);
+    std::pair<int, int> best_move(int decision) const;
+};
+
+// Decides a whole lockstep batch with the linear policy: features of every move of every game, then one scoring pass
+class PolicyDecider : public BatchDecider
+{
+public:
+    PolicyDecider(const GameConfig &config, const PolicyWeights &weights);
+    void decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions) override;
+
+private:
+    const GameConfig &config_;
+    PolicyWeights weights_;
+    PolicyBatch batch_;
+};
+
+void set_strategy_policy(const PolicyWeights &weights);
+const PolicyWeights &get_strategy_policy();
+std::pair<int, int> get_player_move_L(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+
+#endif
@@ -0,0 +1,127 @@
+#include "lineup_evaluation.h"
+#include "game_logic.h"
+#include "helper_functions.h"
+
+#include <iostream>
+
+/**
+ * @brief Lists every multiset of strategies that can sit at a table of num_players.
+ *
+ * Seats are interchangeable (the seat order is shuffled per deck anyway), so a
+ * line-up is a non-decreasing sequence of indices into strategy_names, e.g.
+ * {A1, A1, E2} but never {E2, A1, A1}.
+ *
+ * @param strategy_names The available strategy names.
+ * @param num_players The number of players at the table.
+ * @return All line-ups, each one a list of num_players strategy names.
+ */
+std::vector<std::vector<std::string>> enumerate_lineups(const std::vector<std::string> &strategy_names, int num_players)
+{
+    std::vector<std::vector<std::string>> lineups;
+    if (strategy_names.empty() || num_players <= 0)
+    {
+        return lineups;
+    }
+
+    std::vector<int> indices(num_players, 0); // Non-decreasing indices into strategy_names
+    while (true)
+    {
+        std::vector<std::string> lineup;
+        for (int index : indices)
+        {
+            lineup.push_back(strategy_names[index]);
+        }
+        lineups.push_back(lineup);
+
+        // Advance to the next non-decreasing index sequence
+        int pos = num_players - 1;
+        while (pos >= 0 && indices[pos] == static_cast<int>(strategy_names.size()) - 1)
+        {
+            pos--;
+        }
+        if (pos < 0)
+        {
+            break;
+        }
+        indices[pos]++;
+        for (int k = pos + 1; k < num_players; ++k)
+        {
+            indices[k] = indices[pos];
+        }
+    }
+    return lineups;
+}
+
+/**
+ * @brief Plays every strategy line-up on the same decks and seat orders and prints win rates.
+ *
+ * For each deck the shuffle, the deal and the seat order are computed once
+ * (setup_game) and then shared by all line-ups, so differences between
+ * line-ups come from the strategies alone.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param num_players The number of players at the table.
+ * @param num_games The number of decks to play.
+ */
+void run_lineup_evaluation(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games)
+{
+    std::vector<std::string> strategy_names;
+    for (auto const &[name, func] : strategies)
+    {
+        strategy_names.push_back(name);
+    }
+
+    std::vector<std::vector<std::string>> lineups = enumerate_lineups(strategy_names, num_players);
+
+    // Resolve the function pointers once instead of looking names up for every game
+    std::vector<std::vector<StrategyFunction>> lineup_functions;
+    for (const auto &lineup : lineups)
+    {
+        std::vector<StrategyFunction> seat_strategies;
+        for (const auto &name : lineup)
+        {
+            seat_strategies.push_back(strategies.at(name));
+        }
+        lineup_functions.push_back(seat_strategies);
+    }
+
+    std::vector<int> win_counts(lineups.size(), 0);
+    std::vector<long long> total_turns(lineups.size(), 0);
+
+    StrategyParams params = default_strategy_params(config);
+    std::vector<int> initial_deck = create_deck(config);
+    std::vector<std::vector<int>> final_playing_rows;
+    std::vector<std::vector<int>> final_hand;
+
+    for (int game = 0; game < num_games; ++game)
+    {
+        std::vector<int> game_deck = initial_deck;
+        shuffle(game_deck);
+        GameSetup setup = setup_game(config, num_players, game_deck); // Shared by every line-up
+
+        for (size_t l = 0; l < lineups.size(); ++l)
+        {
+            int turns = 0;
+            if (simulate_game_multiplayer(config, lineup_functions[l], setup, params, turns, final_playing_rows, final_hand))
+            {
+                win_counts[l]++;
+            }
+            total_turns[l] += turns;
+        }
+    }
+
+    std::cout << num_players << " Players, " << lineups.size() << " line-ups, " << num_games << " decks each:\n";
+    for (size_t l = 0; l < lineups.size(); ++l)
+    {
+        double win_rate = (static_cast<double>(win_counts[l]) / num_games) * 100;
+        double average_turns = static_cast<double>(total_turns[l]) / num_games;
+
+        std::cout << "Lineup";
+        for (const auto &name : lineups[l])
+        {
+            std::cout << " " << name;
+        }
+        std::cout << " win rate: " << win_rate << " % (average cards played: " << average_turns << ")\n";
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef LINEUP_EVALUATION_H
+#define LINEUP_EVALUATION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+std::vector<std::vector<std::string>> enumerate_lineups(const std::vector<std::string> &strategy_names, int num_players);
+void run_lineup_evaluation(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games);
+
+#endif
@@ -0,0 +1,291 @@
+#include "lockstep_engine.h"
+#include "helper_functions.h"
+#include "game_config.h"
+
+#include <cstdlib>
+#include <memory_resource>
+
+namespace {
+
+/**
+ * @brief A game of a lockstep run, stopped at its next decision.
+ *
+ * Plays by the same rules as simulate_game_multiplayer, but instead of
+ * calling the strategy it exposes the decision it waits for, so the
+ * decisions of many games can be taken in one batch. Only the row tops are
+ * kept: strategies never look below them.
+ */
+struct LockstepGame
+{
+    const GameConfig *config;
+    const GameSetup *setup;
+    std::vector<int> deck; // Drawn from the back
+    std::vector<std::vector<int>> hands;
+    std::vector<int> hand_at_turn_start; // Reported as the final hand when the turn fails
+    std::vector<char> active;
+    std::vector<int> row_tops;
+    std::vector<thegame_communication> communications;
+    int current_player_index = 0; // Index into setup->player_order
+    int cards_left = 0;           // Decisions left in the current turn, 0 = between turns
+    int turns = 0;
+    bool finished = false;
+    bool won = false;
+    GameRecord *record = nullptr; // Every card played, if asked for
+};
+
+void start_game(LockstepGame &game, const GameConfig &config, const GameSetup &setup)
+{
+    game.config = &config;
+    game.setup = &setup;
+    game.deck = setup.deck;
+    game.hands = setup.hands;
+    game.active.assign(setup.hands.size(), 1);
+    game.row_tops.resize(config.number_of_rows);
+    for (int i = 0; i < config.number_of_rows; ++i)
+    {
+        game.row_tops[i] = i < config.number_of_rows / 2 ? 1 : config.card_max_number;
+    }
+}
+
+int current_seat(const LockstepGame &game)
+{
+    return game.setup->player_order[game.current_player_index];
+}
+
+// Skips inactive players and computes the announcements of the turn
+void begin_turn(LockstepGame &game, const thegame_params &params)
+{
+    const GameConfig &config = *game.config;
+    int num_players = game.hands.size();
+    while (!game.active[current_seat(game)])
+    {
+        game.current_player_index = (game.current_player_index + 1) % num_players;
+    }
+
+    game.communications.clear();
+    for (int p = 0; p < num_players; ++p)
+    {
+        if (!game.active[p])
+        {
+            continue;
+        }
+        for (int card : game.hands[p])
+        {
+            for (int r = 0; r < config.number_of_rows; ++r)
+            {
+                ValidMove vm = is_valid_move(config, card, game.row_tops[r], r < config.number_of_rows / 2);
+                if (vm == ValidMove::REVERSE_MOVE)
+                {
+                    game.communications.push_back({p, r, Communication::REVERSE_TRICK, 0});
+                }
+                else if (vm != ValidMove::NO && std::abs(card - game.row_tops[r]) < params.good_move_window)
+                {
+                    game.communications.push_back({p, r, Communication::GOOD_CARD, 0});
+                }
+            }
+        }
+    }
+    game.hand_at_turn_start = game.hands[current_seat(game)];
+    game.cards_left = game.deck.empty() ? 1 : config.num_cards_to_play;
+}
+
+void finish_game(LockstepGame &game)
+{
+    game.finished = true;
+    game.won = game.deck.empty();
+    for (const auto &hand : game.hands)
+    {
+        game.won = game.won && hand.empty();
+    }
+}
+
+// Refills the hand of the current player, then moves on to the next player (or ends the game)
+void end_turn(LockstepGame &game, bool valid_turn)
+{
+    std::vector<int> &hand = game.hands[current_seat(game)];
+    while (static_cast<int>(hand.size()) < game.config->card_in_hands && !game.deck.empty())
+    {
+        hand.push_back(game.deck.back());
+        game.deck.pop_back();
+    }
+    game.cards_left = 0;
+    if (!valid_turn)
+    {
+        hand = game.hand_at_turn_start;
+        finish_game(game);
+        return;
+    }
+    if (hand.empty() && game.deck.empty())
+    {
+        game.active[current_seat(game)] = 0;
+    }
+    game.current_player_index = (game.current_player_index + 1) % game.hands.size();
+
+    bool all_players_done = true;
+    for (char active : game.active)
+    {
+        all_players_done = all_players_done && !active;
+    }
+    if (all_players_done)
+    {
+        finish_game(game);
+    }
+}
+
+void apply_decision(LockstepGame &game, const thegame_decision &decision)
+{
+    if (decision.card_index == -1)
+    {
+        // The engine would ask again for the remaining cards of the turn and get the same answer
+        end_turn(game, false);
+        return;
+    }
+    std::vector<int> &hand = game.hands[current_seat(game)];
+    game.row_tops[decision.row_index] = hand[decision.card_index];
+    if (game.record != nullptr)
+    {
+        game.record->moves.push_back({current_seat(game), hand[decision.card_index], decision.row_index});
+    }
+    hand.erase(hand.begin() + decision.card_index);
+    game.turns++;
+    if (--game.cards_left == 0)
+    {
+        end_turn(game, true);
+    }
+}
+
+} // namespace
+
+FunctionDecider::FunctionDecider(const GameConfig &config, StrategyFunction strategy) : config_(config), strategy_(strategy)
+{
+}
+
+/**
+ * @brief Rebuilds the engine-side view of every request and calls the strategy on it.
+ */
+void FunctionDecider::decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions)
+{
+    static thread_local std::byte buffer[16 * 1024];
+    static thread_local std::byte scratch_buffer[16 * 1024];
+    std::pmr::monotonic_buffer_resource memory(buffer, sizeof(buffer));
+
+    StrategyParams strategy_params{params.claimed_row_penalty, params.panic_threshold, params.good_move_window};
+    Hand hand(&memory);
+    PlayingRows playing_rows(config_.number_of_rows, &memory);
+    Communications communications(&memory);
+    for (auto &row : playing_rows)
+    {
+        row.resize(1); // Strategies only look at the top of a row
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        const thegame_decision_request &request = requests[i];
+        hand.assign(request.hand, request.hand + request.hand_size);
+        for (int r = 0; r < config_.number_of_rows; ++r)
+        {
+            playing_rows[r][0] = request.row_tops[r];
+        }
+        communications.clear();
+        for (int c = 0; c < request.num_communications; ++c)
+        {
+            const thegame_communication &comm = request.communications[c];
+            communications.push_back({comm.player_id, comm.row_index, static_cast<Communication::CommType>(comm.type), comm.relative_value});
+        }
+        std::pmr::monotonic_buffer_resource scratch(scratch_buffer, sizeof(scratch_buffer));
+        StrategyContext context{config_, strategy_params, nullptr, &scratch};
+        std::pair<int, int> move = strategy_(hand, playing_rows, communications, request.player_id, context);
+        decisions[i] = {move.first, move.second};
+    }
+}
+
+/**
+ * @brief Converts strategy parameters to their plugin ABI form.
+ */
+thegame_params to_plugin_params(const StrategyParams &params)
+{
+    return {params.claimed_row_penalty, params.panic_threshold, params.good_move_window};
+}
+
+/**
+ * @brief Plays every setup to the end, taking the pending decision of all running games in one batch per step.
+ *
+ * Every seat of every game uses the decider's strategy. The outcomes are the
+ * ones simulate_game_multiplayer gives with a deterministic strategy.
+ *
+ * @param config The game config.
+ * @param setups The dealt games.
+ * @param decider Takes the decisions of a batch.
+ * @param params The strategy parameters (also the good-move window of the announcements).
+ * @param outcomes (Output) One outcome per setup.
+ * @param records (Output, optional) One full record per setup (every card played and the final state).
+ */
+void play_lockstep(const GameConfig &config, const std::vector<GameSetup> &setups, BatchDecider &decider, const StrategyParams &params, std::vector<LockstepOutcome> &outcomes, std::vector<GameRecord> *records)
+{
+    thegame_params plugin_params = to_plugin_params(params);
+    std::vector<LockstepGame> games(setups.size());
+    if (records != nullptr)
+    {
+        records->assign(setups.size(), GameRecord());
+    }
+    for (size_t g = 0; g < setups.size(); ++g)
+    {
+        start_game(games[g], config, setups[g]);
+        games[g].record = records != nullptr ? &(*records)[g] : nullptr;
+    }
+
+    std::vector<int> running(setups.size()); // Games still waiting for decisions
+    for (size_t g = 0; g < setups.size(); ++g)
+    {
+        running[g] = g;
+    }
+    std::vector<thegame_decision_request> requests;
+    std::vector<thegame_decision> decisions;
+    requests.reserve(setups.size());
+    decisions.resize(setups.size());
+
+    while (!running.empty())
+    {
+        requests.clear();
+        for (int g : running)
+        {
+            LockstepGame &game = games[g];
+            if (game.cards_left == 0)
+            {
+                begin_turn(game, plugin_params);
+            }
+            const std::vector<int> &hand = game.hands[current_seat(game)];
+            requests.push_back({hand.data(), static_cast<int32_t>(hand.size()), game.row_tops.data(),
+                                game.communications.data(), static_cast<int32_t>(game.communications.size()), current_seat(game)});
+        }
+
+        decider.decide(plugin_params, requests.data(), requests.size(), decisions.data());
+
+        size_t still_running = 0;
+        for (size_t i = 0; i < running.size(); ++i)
+        {
+            LockstepGame &game = games[running[i]];
+            apply_decision(game, decisions[i]);
+            if (!game.finished)
+            {
+                running[still_running++] = running[i];
+            }
+        }
+        running.resize(still_running);
+    }
+
+    outcomes.resize(setups.size());
+    for (size_t g = 0; g < setups.size(); ++g)
+    {
+        outcomes[g] = {games[g].won, games[g].turns, static_cast<int>(games[g].deck.size())};
+        if (records != nullptr)
+        {
+            GameRecord &record = (*records)[g];
+            record.hands = games[g].hands;
+            record.row_tops = games[g].row_tops;
+            record.turns = games[g].turns;
+            record.deck_size = games[g].deck.size();
+            record.won = games[g].won;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef LOCKSTEP_ENGINE_H
+#define LOCKSTEP_ENGINE_H
+
+#include <vector>
+
+#include "game_config.h"
+#include "game_logic.h"
+#include "player_strategies.h"
+#include "strategy_plugin.h"
+
+/**
+ * @brief Takes the decisions of a whole batch of games at once.
+ *
+ * Requests and decisions use the plugin C ABI layout, so a plugin decider
+ * passes the batch through without conversion.
+ */
+class BatchDecider
+{
+public:
+    virtual ~BatchDecider() = default;
+    virtual void decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions) = 0;
+};
+
+// Decides with an in-binary strategy, one request at a time
+class FunctionDecider : public BatchDecider
+{
+public:
+    FunctionDecider(const GameConfig &config, StrategyFunction strategy);
+    void decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions) override;
+
+private:
+    const GameConfig &config_;
+    StrategyFunction strategy_;
+};
+
+// Result of one game of a lockstep run
+struct LockstepOutcome
+{
+    bool won;
+    int turns;     // Cards played
+    int deck_size; // Cards left in the draw pile
+};
+
+thegame_params to_plugin_params(const StrategyParams &params);
+void play_lockstep(const GameConfig &config, const std::vector<GameSetup> &setups, BatchDecider &decider, const StrategyParams &params, std::vector<LockstepOutcome> &outcomes, std::vector<GameRecord> *records = nullptr);
+
+#endif
@@ -1,25 +1,44 @@
 #include "helper_functions.h"
 #include "player_strategies.h"
 #include "game_logic.h"
+#include "lineup_evaluation.h"
+#include "strategy_tuning.h"
+#include "parallel.h"
+#include "move_cache.h"
+#include "weighted_strategy.h"
+#include "deck_stratification.h"
+#include "win_summary.h"
+#include "allocation_counter.h"
+#include "result_output.h"
+#include "progress_metrics.h"
+#include "plugin_loader.h"
+#include "plugin_benchmark.h"
+#include "game_config.h"
+#include "multi_config.h"
+#include "mistake_finder.h"
+#include "turn_planning.h"
+#include "large_variant.h"
+#include "simulation_server.h"
+#include "rare_event_splitting.h"
+#include "shared_prefix_tree.h"
+#include "differential_harness.h"
+#include "endgame_analysis.h"
+#include "learned_policy.h"
+#include "policy_training.h"
+#include "variance_reduction.h"
+#include "strategy_registry.h"
+#include "result_cache.h"
+#include "exact_enumeration.h"
 
 #include <iostream>
-#include <fstream> // std::ifstream
-#include <sstream> // std::istringstream
 #include <string>
 #include <vector>
 #include <map>       // std::map
 #include <ctime>     // std::time, std::srand
 #include <algorithm> // std::find
+#include <memory>    // std::unique_ptr
 
-// Constants (declared and initialized here)
-int CARD_MAX_NUMBER;   // Maximum card value
-int REVERSE_MOVE_DIFF; // Difference for a reverse-10 move
-int CARD_IN_HANDS;     // Number of cards each player holds
-int NUM_CARDS_TO_PLAY; // Number of cards to play per turn
-int NUMBER_OF_ROWS;    // Number of playing rows
-int NUMBER_OF_PLAYERS; // Number of players in the game
-int NUM_SIMULATIONS;   // Number of games to simulate
-int GOOD_MOVE_WINDOW;  // Internal for good moves
+bool TRACE_GAMES = false; // Print the board before and after every turn (--trace)
 
 /**
  * @brief Main function to simulate and analyze the card game.
@@ -27,20 +46,107 @@ int GOOD_MOVE_WINDOW;  // Internal for good moves
  * This function reads configuration parameters from a file, sets up the game,
  * runs multiple simulations with different strategies, and outputs the results.
  *
+ * Usage: the_game [mode] [--config file] [options]
+ *   simulate (default)  Every strategy plays every deck with all seats using it.
+ *                       Options: --summary file (win counts, losses and winning-strategy combinations),
+ *                       --output file|- (results, default standard output), --format text|csv|binary,
+ *                       --backpressure block|drop (when the writer falls behind), --threads n,
+ *                       --trace (print every turn; single thread, needs --output file),
+ *                       --progress seconds (progress lines on stderr, 0 = none), --metrics file,
+ *                       --metrics-interval seconds (Prometheus text file, rewritten atomically),
+ *                       --seed n (decks and seat orders, default random),
+ *                       --cache file (outcomes of earlier runs with the same --seed are looked up, new ones appended)
+ *   lineups             Every multiset of strategies plays the same decks and seat orders.
+ *   tune                Searches the parameters of --strategy (racing + successive halving).
+ *                       Options: --budget games, --min-decks n, --threads n, --metric wins|cards
+ *   stratified          Win rates from decks stratified by predicted hardness. Options: --threads n
+ *   allocations         Heap allocations per game of every strategy (first game and steady state).
+ *   plugin-bench        Plugin strategies against the in-binary strategies of the same name, on the same deals
+ *                       (regular engine, lockstep engine, lockstep engine through the plugin ABI).
+ *   mistakes            Earliest move that lost each deck --strategy loses and another strategy wins
+ *                       (every alternative of every decision is played out). Options: --threads n
+ *   large               Plays --strategy (A1 or A2) with the indexed engine built for big decks,
+ *                       many rows and many players. Options: --threads n
+ *   splitting           Win probability of --strategy by multilevel splitting on cards played, with a 95%
+ *                       confidence interval and the speed-up over plain sampling. Options: --seed n, --threads n
+ *   shared-prefix       Plays every strategy on the same deals as one tree, sharing the game state until their
+ *                       moves differ, and checks the outcomes against separate games. Options: --threads n
+ *   differential        Checks the simulate, snapshot, lockstep and large engines against the frozen reference engine move by move
+ *                       on seeded decks, shrinks mismatching decks and prints a throughput table.
+ *                       Options: --seed n (default random), --threads n
+ *   tablebase           Solves the endgames (draw pile empty, at most --endgame-cards n cards left, default 10) that every
+ *                       strategy gets to on seeded deals, with every position reachable from them, and writes them to
+ *                       the --tablebase file (default endgame.tb). Options: --seed n, --threads n
+ *   endgame             Labels the endgames of every strategy exactly with the --tablebase file: already lost when reached,
+ *                       or winnable and then won or thrown away. Options: --seed n, --threads n
+ *   train-policy        Trains the weights of strategy L (linear policy over per-move features) by self-play with the
+ *                       cross-entropy method, writes them to --policy file (default policy.txt) and compares L with
+ *                       the built-in strategies on held-out deals. Options: --seed n, --threads n, --metric wins|cards
+ *   variance            Win rate and cards played of every strategy, plain and with --estimator antithetic|control|both
+ *                       (default both): antithetic deck pairs (mirrored values, reversed seats) and control variates
+ *                       on deck statistics of known mean, with the effective sample-size gain. Options: --seed n, --threads n,
+ *                       --strategy S (only S)
+ *   exact               Exact win probability of every strategy over every deck order and seat order, as a fraction, for
+ *                       variants of at most 16 cards (CARD_MAX_NUMBER 18), next to a Monte Carlo estimate on NUM_SIMULATIONS
+ *                       seeded deals and its z-score. Options: --seed n, --threads n
+ *   multi               Simulates every --config given (repeatable) side by side on one pool of --threads n.
+ *   serve               Daemon taking JSON jobs (one per line) on a Unix socket: --socket file (default thegame.sock),
+ *                       --threads n workers. The --config file gives the default rules of the jobs.
+ *   submit              Sends the JSON jobs of the standard input to the daemon on --socket and prints the answers.
+ *   Every mode: --strategy-lib file (repeatable) loads a strategy plugin, its strategies are named plugin:strategy.
+ *   --tablebase file gives strategy T its endgame tablebase (without one T plays as J).
+ *   --policy file gives strategy L its weights (default: the weights trained on the default rules).
+ *
  * @return 0 if the program executes successfully.
  */
 int main(int argc, char** argv) // Corrected argv declaration
 {
-    std::string config_filename = "mpconfig.txt"; // Default config file name
+    std::vector<std::string> config_filenames;     // --config files, mpconfig.txt if none
+    std::string mode = "simulate";                 // Default run mode
+    std::string strategy_to_tune = "H1";           // tune: strategy whose parameters are searched
+    bool strategy_given = false;                   // variance: only --strategy, not every strategy
+    long long tuning_budget = -1;                  // tune: total games, defaults to 20 x NUM_SIMULATIONS
+    int tuning_min_decks = 2000;                   // tune: paired decks before racing may drop a candidate
+    int num_threads = default_thread_count();      // Worker threads for the parallel modes
+    std::string tuning_metric = "wins";            // tune: what the candidates race on
+    std::string summary_filename;                  // simulate: summary file, none if empty
+    std::string output_filename = "-";             // simulate: result records, "-" = standard output
+    std::string output_format = "text";            // simulate: text, csv or binary
+    Backpressure backpressure = Backpressure::BLOCK; // simulate: full ring buffer policy
+    ProgressOptions progress_options;              // simulate: progress lines and metrics file
+    std::vector<std::string> plugin_paths;         // Strategy plugins to load (--strategy-lib)
+    std::string socket_path = "thegame.sock";      // serve and submit: Unix socket of the daemon
+    uint64_t seed = 0;                             // simulate, differential, splitting, ...: seed of the decks and seat orders
+    bool seed_given = false;
+    std::string tablebase_filename;                // Endgame tablebase (tablebase: file written, default endgame.tb)
+    int endgame_cards = 10;                        // tablebase: most cards left in the positions stored
+    std::string policy_filename;                   // Weights of strategy L (train-policy: file written, default policy.txt)
+    VarianceEstimator estimator = VarianceEstimator::BOTH; // variance: estimators reported next to the plain one
+    std::string cache_filename;                    // simulate: persistent result cache, none if empty
+
+    // An optional first argument that is not a flag selects the run mode
+    int first_flag = 1;
+    if (argc > 1 && argv[1][0] != '-')
+    {
+        mode = argv[1];
+        first_flag = 2;
+    }
+    if (mode != "simulate" && mode != "lineups" && mode != "tune" && mode != "stratified" && mode != "allocations" && mode != "plugin-bench" && mode != "multi" && mode != "mistakes" && mode != "large" &&
+        mode != "splitting" && mode != "shared-prefix" && mode != "differential" && mode != "tablebase" && mode != "endgame" && mode != "train-policy" &&
+        mode != "variance" && mode != "exact" && mode != "serve" && mode != "submit")
+    {
+        std::cerr << "Error: Unknown mode '" << mode << "'\n";
+        return 1;
+    }
 
     // Parse command-line arguments
-    for (int i = 1; i < argc; ++i)
+    for (int i = first_flag; i < argc; ++i)
     {
         if (std::string(argv[i]) == "--config")
         { // Construct string with char*
             if (i + 1 < argc)
             {
-                config_filename = argv[i + 1];
+                config_filenames.push_back(argv[i + 1]);
                 i++;
             }
             else
@@ -49,220 +155,495 @@ int main(int argc, char** argv) // Corrected argv declaration
                 return 1;
             }
         }
-    }
-
-    std::ifstream config_file(config_filename); // Open the configuration file
-
-    std::string line; // Store each line read from the file
-
-    // Read each line from the configuration file
-    while (std::getline(config_file, line))
-    {
-        std::istringstream iss(line); // Create a stringstream from the line
-        std::string variable_name;    // Store the variable name
-        int variable_value;           // Store the variable value
-
-        // Attempt to extract the variable name and value from the line
-        if (iss >> variable_name >> variable_value)
+        else if (std::string(argv[i]) == "--strategy" || std::string(argv[i]) == "--budget" || std::string(argv[i]) == "--min-decks" ||
+                 std::string(argv[i]) == "--threads" || std::string(argv[i]) == "--metric" || std::string(argv[i]) == "--summary" ||
+                 std::string(argv[i]) == "--output" || std::string(argv[i]) == "--format" || std::string(argv[i]) == "--backpressure" ||
+                 std::string(argv[i]) == "--progress" || std::string(argv[i]) == "--metrics" || std::string(argv[i]) == "--metrics-interval" ||
+                 std::string(argv[i]) == "--strategy-lib" || std::string(argv[i]) == "--socket" || std::string(argv[i]) == "--seed" ||
+                 std::string(argv[i]) == "--tablebase" || std::string(argv[i]) == "--endgame-cards" || std::string(argv[i]) == "--policy" ||
+                 std::string(argv[i]) == "--estimator" || std::string(argv[i]) == "--cache")
         {
-            // Assign the read value to the corresponding global variable
-            if (variable_name == "CARD_MAX_NUMBER")
-            {
-                CARD_MAX_NUMBER = variable_value;
-            }
-            else if (variable_name == "REVERSE_MOVE_DIFF")
-            {
-                REVERSE_MOVE_DIFF = variable_value;
-            }
-            else if (variable_name == "CARD_IN_HANDS")
-            {
-                CARD_IN_HANDS = variable_value;
-            }
-            else if (variable_name == "NUM_CARDS_TO_PLAY")
+            std::string option = argv[i];
+            if (i + 1 >= argc)
             {
-                NUM_CARDS_TO_PLAY = variable_value;
+                std::cerr << "Error: Missing value after " << option << "\n";
+                return 1;
             }
-            else if (variable_name == "NUMBER_OF_ROWS")
+            std::string value = argv[++i];
+            if (option == "--strategy")
             {
-                NUMBER_OF_ROWS = variable_value;
+                strategy_to_tune = value;
+                strategy_given = true;
             }
-            else if (variable_name == "NUMBER_OF_PLAYERS")
+            else if (option == "--budget")
+                tuning_budget = std::stoll(value);
+            else if (option == "--min-decks")
+                tuning_min_decks = std::stoi(value);
+            else if (option == "--threads")
+                num_threads = std::max(1, std::stoi(value));
+            else if (option == "--summary")
+                summary_filename = value;
+            else if (option == "--output")
+                output_filename = value;
+            else if (option == "--format")
+                output_format = value;
+            else if (option == "--progress")
+                progress_options.progress_interval = std::max(0.0, std::stod(value));
+            else if (option == "--metrics")
+                progress_options.metrics_filename = value;
+            else if (option == "--metrics-interval")
+                progress_options.metrics_interval = std::max(0.1, std::stod(value));
+            else if (option == "--strategy-lib")
+                plugin_paths.push_back(value);
+            else if (option == "--socket")
+                socket_path = value;
+            else if (option == "--tablebase")
+                tablebase_filename = value;
+            else if (option == "--endgame-cards")
+                endgame_cards = std::stoi(value);
+            else if (option == "--policy")
+                policy_filename = value;
+            else if (option == "--cache")
+                cache_filename = value;
+            else if (option == "--seed")
             {
-                NUMBER_OF_PLAYERS = variable_value;
+                seed = std::stoull(value);
+                seed_given = true;
             }
-            else if (variable_name == "NUM_SIMULATIONS")
+            else if (option == "--estimator")
             {
-                NUM_SIMULATIONS = variable_value;
+                if (value != "antithetic" && value != "control" && value != "both")
+                {
+                    std::cerr << "Error: --estimator must be antithetic, control or both\n";
+                    return 1;
+                }
+                estimator = value == "antithetic" ? VarianceEstimator::ANTITHETIC : value == "control" ? VarianceEstimator::CONTROL : VarianceEstimator::BOTH;
             }
-            else if(variable_name == "GOOD_MOVE_WINDOW")
+            else if (option == "--backpressure")
             {
-                GOOD_MOVE_WINDOW = variable_value;
+                if (value != "block" && value != "drop")
+                {
+                    std::cerr << "Error: --backpressure must be block or drop\n";
+                    return 1;
+                }
+                backpressure = value == "drop" ? Backpressure::DROP : Backpressure::BLOCK;
             }
-            // Output the read variable and its value to the console
-            std::cout << variable_name << ": " << variable_value << std::endl;
+            else
+                tuning_metric = value;
+        }
+        else if (std::string(argv[i]) == "--trace")
+        {
+            TRACE_GAMES = true;
         }
     }
-    config_file.close(); // Close the configuration file
+    if (mode == "simulate" && TRACE_GAMES && output_filename == "-")
+    {
+        std::cerr << "Error: --trace prints to the standard output, write the results to a file with --output\n";
+        return 1;
+    }
+    if (!cache_filename.empty() && (mode != "simulate" || TRACE_GAMES || !seed_given))
+    {
+        std::cerr << "Error: --cache needs the simulate mode, a --seed (random decks are never seen twice) and no --trace\n";
+        return 1;
+    }
+
+    if (mode == "submit")
+    {
+        return run_job_client(socket_path); // The daemon has the rules and the strategies
+    }
+
+    if (config_filenames.empty())
+    {
+        config_filenames.push_back("mpconfig.txt"); // Default config file name
+    }
+    if (mode != "multi" && config_filenames.size() > 1)
+    {
+        std::cerr << "Error: Only the multi mode takes several --config files\n";
+        return 1;
+    }
+
+    // Every config is read and validated up front; games only ever see a const GameConfig
+    std::vector<GameConfig> configs;
+    for (const auto &filename : config_filenames)
+    {
+        GameConfig loaded;
+        std::string config_error;
+        if (!load_game_config(filename, loaded, config_error))
+        {
+            std::cerr << "Error: " << config_error << "\n";
+            return 1;
+        }
+        configs.push_back(loaded);
+    }
+    const GameConfig &config = configs.front();
+    if (mode != "multi")
+    {
+        print_game_config(config);
+    }
+    if (mode == "multi" && !plugin_paths.empty())
+    {
+        std::cerr << "Error: Plugins receive the rules of one config, the multi mode cannot load them\n";
+        return 1;
+    }
+    if (mode == "serve" && !plugin_paths.empty())
+    {
+        std::cerr << "Error: Plugins receive the rules of one config, the daemon runs jobs with other rules\n";
+        return 1;
+    }
 
     // --- 2. Setup Random Number Generator and Game Parameters ---
     std::srand(std::time(nullptr));              // Seed the random number generator
-    int num_games_to_simulate = NUM_SIMULATIONS; // Number of games to simulate
+    int num_games_to_simulate = config.num_simulations; // Number of games to simulate
 
     // --- 3. Define Player Strategies ---
-    // Create a map to associate strategy names with their function pointers.
-    //  IMPORTANT: The function pointer type now includes Communication and player_id.
-    std::map<std::string, std::pair<int, int> (*)(const std::vector<int> &, const std::vector<std::vector<int>> &, const std::vector<Communication>&, int)> strategies;
-    strategies["A1"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_A1(hand, playing_rows, comms, player_id);
-    }; // Strategy A: Closest Card
-    strategies["A2"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_A2(hand, playing_rows, comms, player_id);
-    }; // Strategy A: Closest Card
-
-    strategies["E1"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_E1(hand, playing_rows, comms, player_id);
-    }; // Strategy E: Combination of C and A
-    strategies["E2"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_E2(hand, playing_rows, comms, player_id);
-    }; // Strategy E: Combination of C and A
+    std::map<std::string, StrategyFunction> strategies = builtin_strategies();
 
-    strategies["H1"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_H1(hand, playing_rows, comms, player_id);
-    }; // Strategy H: Panic Mode
-    strategies["H2"] = [](const std::vector<int>& hand, const std::vector<std::vector<int>>& playing_rows, const std::vector<Communication>& comms, int player_id) {
-        return get_player_move_H2(hand, playing_rows, comms, player_id);
-    }; // Strategy H: Panic Mode
+    // Plugins are loaded once the rules are known (they receive them in init)
+    std::map<std::string, StrategyFunction> in_binary_strategies = strategies;
+    std::vector<LoadedPlugin> plugins;
+    for (const auto &path : plugin_paths)
+    {
+        LoadedPlugin plugin;
+        std::string error;
+        if (!load_strategy_plugin(config, path, plugin, error) || !register_plugin_strategies(plugin, strategies, error))
+        {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        plugins.push_back(plugin);
+    }
 
-    // strategies["A"] = get_player_move_A; // Strategy A: Closest Card
-    // strategies["B"] = get_player_move_B; // Strategy B: Closest Card (No Reverse)
-    // strategies["C"] = get_player_move_C; // Strategy C: Maximize Future Playability
-    // strategies["D"] = get_player_move_D; // Strategy D: Prioritize Ascending Rows
-    // strategies["E"] = get_player_move_E; // Strategy E: Combination of C and A
-    // strategies["F"] = get_player_move_F; // Strategy F: Maximize Minimum Gap
-    // strategies["G"] = get_player_move_G; // Strategy G: Weighted Combination of A, C, and F
-    // strategies["H"] = get_player_move_H; // Strategy H: Panic Mode
-    // strategies["I"] = get_player_move_I; // Strategy I: Minimize Blocking 1 and 100
+    // Strategy T probes the tablebase in every mode; the tablebase mode writes it instead
+    EndgameTablebase tablebase;
+    if (!tablebase_filename.empty() && mode != "tablebase")
+    {
+        std::string error;
+        if (mode == "multi" || mode == "serve")
+        {
+            std::cerr << "Error: A tablebase is built for the rules of one config, the " << mode << " mode plays others\n";
+            return 1;
+        }
+        if (!tablebase.open(tablebase_filename, config, error))
+        {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        set_strategy_tablebase(&tablebase);
+    }
+    if (!policy_filename.empty() && mode != "train-policy")
+    {
+        PolicyWeights weights;
+        std::string error;
+        if (!load_policy_weights(policy_filename, weights, error))
+        {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        set_strategy_policy(weights);
+    }
+    if (!seed_given)
+    {
+        std::random_device rd;
+        seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
 
-    // --- 4. Structure to Store Game Results ---
-    // Define a struct to hold the results of each simulated game
-    struct GameResult
-    {
-        int num_players;                                  // Number of players in the game
-        std::string shuffle_id;                           // Unique ID for the shuffled deck
-        std::string strategy_name;                        // Name of the strategy used
-        bool win;                                         // True if the strategy won, false otherwise
-        int turns;                                        // Number of turns taken in the game
-        std::vector<std::vector<int>> final_playing_rows; // Final state of the playing rows
-        std::vector<std::vector<int>> final_hand;         // Final hands of the players
-        int deck_size;                                    // Size of the deck at the end of the game (or 0 if won)
-    };
-    std::vector<GameResult> game_results; // Vector to store the results of all games
+    if (mode == "serve")
+    {
+        TRACE_GAMES = false;
+        return run_simulation_server(config, strategies, socket_path, num_threads);
+    }
+    if (mode == "large")
+    {
+        TRACE_GAMES = false;
+        run_large_variant(config, strategy_to_tune, num_games_to_simulate, num_threads);
+        return 0;
+    }
+    if (mode == "differential")
+    {
+        TRACE_GAMES = false;
+        return run_differential_harness(config, strategies, num_games_to_simulate, seed, num_threads);
+    }
+    if (mode == "tablebase")
+    {
+        TRACE_GAMES = false;
+        return run_tablebase_build(config, strategies, endgame_cards, num_games_to_simulate, seed,
+                                   tablebase_filename.empty() ? "endgame.tb" : tablebase_filename, num_threads);
+    }
+    if (mode == "variance")
+    {
+        TRACE_GAMES = false;
+        std::map<std::string, StrategyFunction> estimated = strategies;
+        if (strategy_given)
+        {
+            auto found = strategies.find(strategy_to_tune);
+            if (found == strategies.end())
+            {
+                std::cerr << "Error: Unknown strategy '" << strategy_to_tune << "'\n";
+                return 1;
+            }
+            estimated = {*found};
+        }
+        return run_variance_estimators(config, estimated, estimator, num_games_to_simulate, seed, num_threads);
+    }
+    if (mode == "exact")
+    {
+        TRACE_GAMES = false;
+        return run_exact_enumeration(config, strategies, num_games_to_simulate, seed, num_threads);
+    }
+    if (mode == "train-policy")
+    {
+        TRACE_GAMES = false;
+        PolicyTrainingOptions options{num_games_to_simulate, seed, num_threads, tuning_metric == "cards",
+                                      policy_filename.empty() ? "policy.txt" : policy_filename};
+        return run_policy_training(config, in_binary_strategies, options);
+    }
+    if (mode == "endgame")
+    {
+        TRACE_GAMES = false;
+        if (tablebase_filename.empty())
+        {
+            std::cerr << "Error: The endgame mode needs a --tablebase file (see the tablebase mode)\n";
+            return 1;
+        }
+        return run_endgame_analysis(config, strategies, tablebase, num_games_to_simulate, seed, num_threads);
+    }
+    if (mode == "shared-prefix")
+    {
+        TRACE_GAMES = false;
+        run_shared_prefix(config, strategies, num_games_to_simulate, num_threads);
+        return 0;
+    }
+    if (mode == "splitting")
+    {
+        TRACE_GAMES = false;
+        run_splitting_estimate(config, strategies, strategy_to_tune, num_games_to_simulate, seed, num_threads);
+        return 0;
+    }
+    if (mode == "mistakes")
+    {
+        TRACE_GAMES = false;
+        run_mistake_finder(config, strategies, strategy_to_tune, num_games_to_simulate, num_threads);
+        return 0;
+    }
+    if (mode == "multi")
+    {
+        TRACE_GAMES = false;
+        run_multi_config(configs, config_filenames, strategies, num_threads);
+        return 0;
+    }
+    if (mode == "plugin-bench")
+    {
+        TRACE_GAMES = false;
+        if (plugins.empty())
+        {
+            std::cerr << "Error: plugin-bench needs at least one --strategy-lib\n";
+            return 1;
+        }
+        run_plugin_benchmark(config, plugins, in_binary_strategies, config.number_of_players, num_games_to_simulate);
+        return 0;
+    }
+    if (mode == "lineups")
+    {
+        TRACE_GAMES = false; // One trace per line-up and deck would drown the results
+        run_lineup_evaluation(config, strategies, config.number_of_players, num_games_to_simulate);
+        return 0;
+    }
+    if (mode == "allocations")
+    {
+        TRACE_GAMES = false;
+        run_allocation_report(config, strategies, config.number_of_players, num_games_to_simulate);
+        return 0;
+    }
+    if (mode == "tune")
+    {
+        TRACE_GAMES = false;
+        TuningOptions options;
+        options.strategy_name = strategy_to_tune;
+        options.num_players = config.number_of_players;
+        options.budget = tuning_budget > 0 ? tuning_budget : 20LL * num_games_to_simulate;
+        options.min_decks = tuning_min_decks;
+        options.batch_size = 500;
+        options.num_threads = num_threads;
+        options.race_on_cards = tuning_metric == "cards";
+        run_strategy_tuning(config, strategies, options);
+        return 0;
+    }
+    if (mode == "stratified")
+    {
+        TRACE_GAMES = false;
+        StratificationOptions options;
+        options.num_players = config.number_of_players;
+        options.num_games = num_games_to_simulate;
+        options.pilot_share = 0.1;
+        options.num_strata = 5;
+        options.feature_samples = 100000;
+        options.num_threads = num_threads;
+        run_stratified_sampling(config, strategies, options);
+        return 0;
+    }
 
-    // --- 5. Data Structures for Win Rates and Turn Counts ---
-    // Create maps to store win counts and total turns for each strategy
-    std::map<std::string, int> win_counts;
-    std::map<std::string, int> total_turns;
+    // --- 4. Result Output ---
+    // Workers push fixed-size records into per-worker rings; a writer thread
+    // formats them and writes them to the sink, so workers never wait on I/O
+    int num_players = config.number_of_players; // Get the number of players from the config
+    int workers = TRACE_GAMES ? 1 : std::max(1, std::min(num_threads, num_games_to_simulate)); // Traces are only readable from one thread
 
-    // Initialize win counts and total turns to 0 for each strategy
+    std::vector<std::string> strategy_names;
+    std::vector<StrategyFunction> strategy_functions;
     for (auto const &[key, val] : strategies)
     {
-        win_counts[key] = 0;
-        total_turns[key] = 0;
+        strategy_names.push_back(key);
+        strategy_functions.push_back(val);
     }
 
-    int num_players = NUMBER_OF_PLAYERS; // Get the number of players from the config
+    std::string output_error;
+    std::unique_ptr<ResultSink> sink = make_result_sink(output_format, output_filename, strategy_names, output_error);
+    if (!sink)
+    {
+        std::cerr << "Error: " << output_error << "\n";
+        return 1;
+    }
+    std::cout.flush(); // Everything printed so far goes before the results
 
-    // --- 6. Simulate Games and Store Results ---
-    std::vector<int> initial_deck = create_deck(); // Create the initial shuffled deck
+    // --- 5. Per-Worker Aggregates ---
+    // Win counts, losses and winning-strategy combinations, merged after the run
+    WinSummary summary;
+    std::string summary_error;
+    init_win_summary(summary, num_players, strategy_names);
+    std::vector<WinSummary> worker_summaries(workers, summary);
 
-    // Simulate multiple games
-    for (int game = 0; game < num_games_to_simulate; ++game)
+    // Outcomes of unchanged strategies on decks of earlier runs are looked up instead of played
+    ResultCache result_cache;
+    std::vector<uint64_t> strategy_versions(strategy_names.size(), 0); // 0: never cached
+    uint64_t config_key = config_cache_hash(config);
+    if (!cache_filename.empty())
     {
-        std::vector<int> game_deck = initial_deck;            // Copy the initial deck for this game
-        shuffle(game_deck);                                   // Shuffle the deck
-        std::string shuffle_id = generate_deck_id(game_deck); // Generate a unique ID
-
-        // Iterate through each strategy
-        for (auto const &[strategy_name, strategy_func] : strategies)
+        std::string cache_error;
+        if (!result_cache.open(cache_filename, cache_error))
         {
-            int turns = 0;                                    // Reset turn counter for each strategy
-            std::vector<std::vector<int>> final_playing_rows; // Store final rows
-            std::vector<std::vector<int>> final_hand;         // Store final hands
-            // Simulate the game with the current strategy
-            bool won = simulate_game_multiplayer(strategy_func, num_players, game_deck, turns, final_playing_rows, final_hand);
-
-            // Store the results of the game
-            GameResult result;
-            result.num_players = num_players;
-            result.shuffle_id = shuffle_id;
-            result.strategy_name = strategy_name;
-            result.win = won;
-            result.turns = turns;
-            result.final_playing_rows = final_playing_rows;
-            result.final_hand = final_hand;
-            result.deck_size = -1; // IMPROVE THIS
-            game_results.push_back(result); // Add the result to the list of game results
-
-            // If the game was won, update win counts and total turns
-            if (won)
-            {
-                win_counts[strategy_name]++;
-                total_turns[strategy_name] += turns;
-            }
+            std::cerr << "Error: " << cache_error << "\n";
+            return 1;
         }
-        // Output progress to the console
-        std::cout << "Completed simulation of game " << game << "\n";
+        for (size_t s = 0; s < strategy_names.size(); ++s)
+        {
+            strategy_versions[s] = strategy_version_hash(strategy_names[s]);
+        }
+    }
+    std::vector<std::vector<StrategyFunction>> seat_strategies;
+    for (const auto &strategy : strategy_functions)
+    {
+        seat_strategies.emplace_back(num_players, strategy);
     }
+    StrategyParams params = default_strategy_params(config);
 
-    // --- 7. Output Game Results ---
-    // Print detailed results for each game
-    for (const auto &result : game_results)
-    {
-        std::cout << "Game Results:\n";
-        std::cout << "  Number of Players: " << result.num_players << "\n";
-        std::cout << "  Shuffle ID: " << result.shuffle_id << "\n";
-        std::cout << "  Strategy: " << result.strategy_name << "\n";
-        std::cout << "  Win: " << (result.win ? "true" : "false") << "\n";
-        std::cout << "  Turns: " << result.turns << "\n";
-        std::cout << "  Deck Size: " << result.deck_size << "\n";
+    // --- 6. Simulate Games ---
+    {
+        ResultPipeline pipeline(*sink, workers, 4096, max_result_state_size(config, num_players), backpressure);
+        ProgressReporter reporter(strategy_names, num_players, workers, num_games_to_simulate, progress_options);
 
-        // Print the final playing rows
-        std::cout << "  Final Playing Rows:\n";
-        for (int i = 0; i < NUMBER_OF_ROWS; ++i)
-        {
-            std::cout << "    " << (i < NUMBER_OF_ROWS / 2 ? "Ascending: " : "Descending: ");
-            for (int card : result.final_playing_rows[i])
+        parallel_for_chunks(num_games_to_simulate, workers, [&](int begin, int end, int worker) {
+            std::vector<StrategyOutcome> deck_outcomes(strategy_names.size());
+            std::vector<std::vector<int>> final_playing_rows; // Reused by every game of the worker
+            std::vector<std::vector<int>> final_hand;
+            std::vector<int32_t> state; // Final rows and hands of the current record
+            ResultCacheBatch new_entries;
+            for (int game = begin; game < end; ++game)
             {
-                std::cout << card << " ";
+                std::vector<int> game_deck = seeded_deck(config.card_max_number, seed, game); // Deck number game of the seed
+                std::mt19937_64 order_rng = seat_order_rng(seed, game);
+                GameSetup setup = setup_game(config, num_players, game_deck, order_rng);
+                uint64_t shuffle_id = deck_hash(game_deck); // Unique ID of the deck
+                uint64_t seats_key = seat_order_hash(setup.player_order);
+
+                // Iterate through each strategy
+                new_entries.clear();
+                for (size_t s = 0; s < strategy_functions.size(); ++s)
+                {
+                    ResultCacheKey key{shuffle_id, seats_key, config_key, strategy_versions[s]};
+                    ResultRecord record;
+                    if (strategy_versions[s] != 0 && result_cache.lookup(key, record, state))
+                    {
+                        record.deck_index = game;
+                        record.strategy_index = s;
+                        deck_outcomes[s] = {record.win != 0, record.turns, record.deck_size};
+                        pipeline.push(worker, record, state.data());
+                        continue;
+                    }
+                    int turns = 0;     // Reset turn counter for each strategy
+                    int deck_size = 0; // Cards left in the deck at the end
+                    bool won = simulate_game_multiplayer(config, seat_strategies[s], setup, params, turns, final_playing_rows, final_hand, &deck_size);
+                    deck_outcomes[s] = {won, turns, deck_size};
+                    record = make_result_record(shuffle_id, game, s, won, turns, deck_size, final_playing_rows, final_hand, state);
+                    pipeline.push(worker, record, state.data());
+                    if (strategy_versions[s] != 0)
+                    {
+                        new_entries.add(key, record, state.data());
+                    }
+                }
+                result_cache.append(new_entries);
+                add_deck_outcomes(worker_summaries[worker], deck_outcomes);
+                reporter.worker(worker).add_deck(deck_outcomes);
             }
-            std::cout << "\n";
-        }
+        });
+        reporter.stop();
 
-        // Print the final hands of players
-        std::cout << "  Final Hands:\n";
-        for (int i = 0; i < result.final_hand.size(); ++i)
+        pipeline.finish();
+        if (!sink->finish(output_error))
         {
-            std::cout << "    Player " << i + 1 << ": ";
-            for (int card : result.final_hand[i])
-            {
-                std::cout << card << " ";
-            }
-            std::cout << "\n";
+            std::cerr << "Error: " << output_error << "\n";
+            return 1;
         }
-
-        std::cout << std::endl;
+        if (pipeline.dropped() > 0)
+        {
+            std::cerr << "Warning: " << pipeline.dropped() << " result records dropped (output too slow)\n";
+        }
+        if (pipeline.rejected() > 0)
+        {
+            std::cerr << "Error: " << pipeline.rejected() << " result records larger than the bound of the config were not written\n";
+            return 1;
+        }
+    }
+    for (const auto &worker_summary : worker_summaries)
+    {
+        merge_win_summary(summary, worker_summary);
     }
 
-    // --- 8. Output Overall Win Rates ---
+    // --- 7. Output Overall Win Rates ---
     // Calculate and print the win rate for each strategy
-    for (auto const &[strategy_name, win_count] : win_counts)
+    for (size_t s = 0; s < strategy_names.size(); ++s)
     {
-        double win_rate = (static_cast<double>(win_count) / num_games_to_simulate) * 100;
-        double average_turns = (win_count > 0) ? static_cast<double>(total_turns[strategy_name]) / win_count : 0.0;
+        double win_rate = (static_cast<double>(summary.wins[s]) / num_games_to_simulate) * 100;
 
         std::cout << num_players << " Players: \n";
-        std::cout << strategy_name << " win rate: " << win_rate << " %\n";
+        std::cout << strategy_names[s] << " win rate: " << win_rate << " %\n";
     }
 
+    if (!summary_filename.empty() && !write_win_summary(summary, summary_filename, summary_error))
+    {
+        std::cerr << "Error: " << summary_error << "\n";
+        return 1;
+    }
+
+    if (!cache_filename.empty())
+    {
+        long long lookups = result_cache.hits() + result_cache.misses();
+        std::cout << "Result cache: " << result_cache.hits() << " hits, " << result_cache.misses() << " misses ("
+                  << (lookups > 0 ? 100.0 * result_cache.hits() / lookups : 0.0) << " % hit rate), "
+                  << result_cache.size() + result_cache.misses() << " outcomes in " << cache_filename << "\n";
+        std::string cache_error;
+        if (!result_cache.close(cache_error))
+        {
+            std::cerr << "Error: " << cache_error << "\n";
+            return 1;
+        }
+    }
+
+    // --- 8. Output Move Cache Statistics ---
+    MoveCacheStats cache_stats = collect_move_cache_stats();
+    long long evaluations = cache_stats.hits + cache_stats.misses;
+    std::cout << "Move cache: " << cache_stats.hits << " hits, " << cache_stats.misses << " misses ("
+              << (evaluations > 0 ? 100.0 * cache_stats.hits / evaluations : 0.0) << " % hit rate), "
+              << cache_stats.row_invalidations << " row invalidations, " << cache_stats.resets << " turn resets\n";
+
     return 0; // Indicate successful execution
 }
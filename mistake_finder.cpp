@@ -0,0 +1,220 @@
+#include "mistake_finder.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// What the analysis found on one deck
+struct MistakeReport
+{
+    bool analysed = false;     // Lost by the strategy and won by another one
+    std::string winner;        // First other strategy that wins the deck
+    uint64_t deck_id = 0;
+    int decisions = 0;         // Decisions of the lost game
+    long long forks = 0;       // Alternative moves played out
+    bool fixed = false;        // One different move wins the game
+    int turn_number = 0;       // Player turn of the earliest winning alternative (from 1)
+    int card_in_turn = 0;      // Card of the turn (from 1)
+    int player = 0;
+    int played_card = 0, played_row = 0; // What the strategy played
+    int fix_card = 0, fix_row = 0;       // The alternative that wins
+};
+
+/**
+ * @brief Replays a lost game, then plays out every alternative of every decision, earliest first.
+ *
+ * Every decision point of the game is kept as a tracked game (snapshot, card
+ * tracker and turn plan); an alternative is a copy of it, the alternative
+ * move, and the strategy playing on to the end (replanning the rest of the
+ * turn). The search stops at the first decision where an alternative wins.
+ */
+void find_earliest_fix(const GameConfig &config, const GameSetup &setup, StrategyFunction strategy, const StrategyParams &params,
+                       std::vector<TrackedGame> &path, std::vector<std::pair<int, int>> &chosen, MistakeReport &report)
+{
+    TrackedGame tracked;
+    tracked.start(config, setup);
+    path.clear();
+    chosen.clear();
+    while (!tracked.game.finished)
+    {
+        path.push_back(tracked);
+        chosen.push_back(decide_snapshot_move(config, tracked.game, strategy, params, &tracked.cards, tracked.plan));
+        apply_snapshot_move(config, tracked.game, chosen.back(), &tracked.cards);
+    }
+    report.decisions = path.size();
+
+    std::pair<int, int> moves[SNAPSHOT_MAX_HAND * MAX_CONFIG_ROWS];
+    for (size_t d = 0; d < path.size(); ++d)
+    {
+        const GameSnapshot &decision = path[d].game;
+        int num_moves = list_legal_moves(config, decision, moves);
+        for (int m = 0; m < num_moves; ++m)
+        {
+            if (moves[m] == chosen[d])
+            {
+                continue;
+            }
+            TrackedGame fork = path[d];
+            force_tracked_move(config, fork, moves[m]);
+            play_tracked_to_end(config, fork, strategy, params);
+            report.forks++;
+            if (fork.game.won)
+            {
+                int player = current_snapshot_player(decision);
+                report.fixed = true;
+                report.turn_number = decision.turn_number;
+                report.card_in_turn = decision.cards_this_turn - decision.cards_left + 1;
+                report.player = player;
+                report.fix_card = decision.hands[player][moves[m].first];
+                report.fix_row = moves[m].second;
+                if (chosen[d].first != -1)
+                {
+                    report.played_card = decision.hands[player][chosen[d].first];
+                    report.played_row = chosen[d].second;
+                }
+                else
+                {
+                    report.played_card = report.played_row = -1;
+                }
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Finds, on the decks a strategy loses and another strategy wins, the earliest move that lost it.
+ *
+ * Every deck is dealt once and played by every strategy (all seats using
+ * it) on game snapshots, with the card tracker and whole-turn plans. For each deck the analysed strategy loses while
+ * another wins, the lost game is replayed and every alternative legal move of
+ * every decision is tried, the strategy then playing on as usual. The
+ * earliest decision where one different move turns the loss into a win is
+ * reported. Decks are analysed in parallel.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param strategy_name The strategy whose losses are analysed.
+ * @param num_games The number of decks to deal.
+ * @param num_threads The number of worker threads.
+ */
+void run_mistake_finder(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &strategy_name, int num_games, int num_threads)
+{
+    auto analysed = strategies.find(strategy_name);
+    if (analysed == strategies.end())
+    {
+        std::cerr << "Error: Unknown strategy '" << strategy_name << "'\n";
+        return;
+    }
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return;
+    }
+
+    std::vector<int> initial_deck = create_deck(config);
+    std::vector<std::vector<int>> decks(num_games);
+    std::vector<GameSetup> setups(num_games);
+    for (int game = 0; game < num_games; ++game)
+    {
+        decks[game] = initial_deck;
+        shuffle(decks[game]);
+        setups[game] = setup_game(config, config.number_of_players, decks[game]);
+    }
+    StrategyParams params = default_strategy_params(config);
+    std::vector<MistakeReport> reports(num_games);
+
+    auto start = std::chrono::steady_clock::now();
+    parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+        std::vector<TrackedGame> path;
+        std::vector<std::pair<int, int>> chosen;
+        for (int game = begin; game < end; ++game)
+        {
+            TrackedGame tracked;
+            tracked.start(config, setups[game]);
+            play_tracked_to_end(config, tracked, analysed->second, params);
+            if (tracked.game.won)
+            {
+                continue;
+            }
+            MistakeReport &report = reports[game];
+            for (auto const &[name, func] : strategies)
+            {
+                if (name == strategy_name)
+                {
+                    continue;
+                }
+                tracked.start(config, setups[game]);
+                play_tracked_to_end(config, tracked, func, params);
+                if (tracked.game.won)
+                {
+                    report.winner = name;
+                    break;
+                }
+            }
+            if (report.winner.empty())
+            {
+                continue;
+            }
+            report.analysed = true;
+            report.deck_id = deck_hash(decks[game]);
+            find_earliest_fix(config, setups[game], analysed->second, params, path, chosen, report);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int num_analysed = 0, num_fixed = 0;
+    long long forks = 0;
+    double turn_sum = 0.0;
+    std::cout << "Mistakes of " << strategy_name << ", " << config.number_of_players << " Players, " << num_games << " decks:\n";
+    for (int game = 0; game < num_games; ++game)
+    {
+        const MistakeReport &report = reports[game];
+        if (!report.analysed)
+        {
+            continue;
+        }
+        num_analysed++;
+        forks += report.forks;
+        std::cout << "Deck " << game << " (" << std::hex << std::setw(16) << std::setfill('0') << report.deck_id
+                  << std::dec << std::setfill(' ') << ", won by " << report.winner << "): ";
+        if (report.fixed)
+        {
+            num_fixed++;
+            turn_sum += report.turn_number;
+            std::cout << "turn " << report.turn_number << " card " << report.card_in_turn << " (player " << report.player + 1 << "): ";
+            if (report.played_card == -1)
+            {
+                std::cout << "no move";
+            }
+            else
+            {
+                std::cout << report.played_card << " on row " << report.played_row;
+            }
+            std::cout << " -> " << report.fix_card << " on row " << report.fix_row << " wins";
+        }
+        else
+        {
+            std::cout << "no single different move wins";
+        }
+        std::cout << " (" << report.decisions << " decisions, " << report.forks << " forks)\n";
+    }
+    std::cout << num_analysed << " decks lost by " << strategy_name << " and won by another strategy, "
+              << num_fixed << " saved by one different move";
+    if (num_fixed > 0)
+    {
+        std::cout << " (earliest fix at turn " << turn_sum / num_fixed << " on average)";
+    }
+    std::cout << "\n" << forks << " forks in " << seconds << " s (" << (seconds > 0 ? forks / seconds : 0.0)
+              << " forks/s), " << sizeof(GameSnapshot) << " bytes per snapshot\n";
+}
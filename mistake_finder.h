@@ -0,0 +1,12 @@
+#ifndef MISTAKE_FINDER_H
+#define MISTAKE_FINDER_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+void run_mistake_finder(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &strategy_name, int num_games, int num_threads);
+
+#endif
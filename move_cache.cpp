@@ -0,0 +1,102 @@
+#include "move_cache.h"
+#include "game_config.h"
+
+#include <atomic>
+
+namespace {
+
+// Totals over every thread, updated once per game by flush_stats()
+std::atomic<long long> total_hits{0};
+std::atomic<long long> total_misses{0};
+std::atomic<long long> total_row_invalidations{0};
+std::atomic<long long> total_resets{0};
+
+} // namespace
+
+/**
+ * @brief Drops every cached evaluation, e.g. because another player moved since the last turn.
+ *
+ * The storage is (re)sized when the deck or the number of rows changed and is
+ * otherwise reused, so a reset only bumps the row generations.
+ *
+ * @param config The config of the game being played (kept for the evaluations).
+ */
+void MoveCache::reset(const GameConfig &config)
+{
+    config_ = &config;
+    int number_of_rows = config.number_of_rows;
+    size_t size = static_cast<size_t>(config.card_max_number + 1) * number_of_rows;
+    if (number_of_rows != number_of_rows_ || evaluations_.size() != size)
+    {
+        number_of_rows_ = number_of_rows;
+        evaluations_.assign(size, ValidMove::NO);
+        stamps_.assign(size, 0);
+        row_generations_.assign(number_of_rows, 0);
+    }
+    for (auto &generation : row_generations_)
+    {
+        generation++;
+    }
+    stats_.resets++;
+}
+
+/**
+ * @brief Drops the cached evaluations of one row after a card was played on it.
+ *
+ * @param row The index of the row whose top card changed.
+ */
+void MoveCache::invalidate_row(int row)
+{
+    row_generations_[row]++;
+    stats_.row_invalidations++;
+}
+
+/**
+ * @brief Returns is_valid_move(card, row_top, ...) for the row, computing it only on a miss.
+ *
+ * @param card The card to play.
+ * @param row The index of the row.
+ * @param row_top The current top card of the row (used on a miss).
+ * @return The ValidMove of playing the card on the row.
+ */
+ValidMove MoveCache::evaluate(int card, int row, int row_top)
+{
+    size_t index = static_cast<size_t>(card) * number_of_rows_ + row;
+    if (stamps_[index] == row_generations_[row])
+    {
+        stats_.hits++;
+        return evaluations_[index];
+    }
+    stats_.misses++;
+    ValidMove valid_move = is_valid_move(*config_, card, row_top, row < number_of_rows_ / 2);
+    evaluations_[index] = valid_move;
+    stamps_[index] = row_generations_[row];
+    return valid_move;
+}
+
+/**
+ * @brief Adds the counters of this cache to the process-wide totals and clears them.
+ */
+void MoveCache::flush_stats()
+{
+    total_hits += stats_.hits;
+    total_misses += stats_.misses;
+    total_row_invalidations += stats_.row_invalidations;
+    total_resets += stats_.resets;
+    stats_ = MoveCacheStats();
+}
+
+/**
+ * @brief Returns the counters of every cache flushed so far.
+ *
+ * @return The summed MoveCacheStats.
+ */
+MoveCacheStats collect_move_cache_stats()
+{
+    MoveCacheStats stats;
+    stats.hits = total_hits;
+    stats.misses = total_misses;
+    stats.row_invalidations = total_row_invalidations;
+    stats.resets = total_resets;
+    return stats;
+}
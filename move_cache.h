@@ -0,0 +1,49 @@
+#ifndef MOVE_CACHE_H
+#define MOVE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "helper_functions.h"
+
+struct GameConfig;
+
+// Totals of all MoveCache counters, summed over every finished game.
+struct MoveCacheStats
+{
+    long long hits = 0;              // Evaluations answered from the cache
+    long long misses = 0;            // Evaluations computed with is_valid_move
+    long long row_invalidations = 0; // Rows dropped because their top card changed
+    long long resets = 0;            // Whole-cache drops at the start of a turn
+};
+
+/**
+ * @brief Memoises is_valid_move for every (card, row) pair during one turn.
+ *
+ * A turn asks the strategy for up to num_cards_to_play moves, and between two
+ * calls only one row top and one hand card change. The engine resets the
+ * cache when a turn starts and invalidates the row it just played on, so the
+ * other rows keep their evaluations. Entries are stamped with a per-row
+ * generation, so invalidating a row or the whole cache is O(1) per row.
+ */
+class MoveCache
+{
+public:
+    void reset(const GameConfig &config);
+    void invalidate_row(int row);
+    ValidMove evaluate(int card, int row, int row_top);
+    void flush_stats();
+
+private:
+    const GameConfig *config_ = nullptr;
+    int number_of_rows_ = 0;
+    std::vector<ValidMove> evaluations_;     // [card * number_of_rows + row]
+    std::vector<uint32_t> stamps_;           // Generation of the row when the entry was computed
+    std::vector<uint32_t> row_generations_;  // Current generation of every row
+    MoveCacheStats stats_;                   // Counters not yet added to the global totals
+};
+
+MoveCacheStats collect_move_cache_stats();
+
+#endif
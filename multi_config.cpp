@@ -0,0 +1,100 @@
+#include "multi_config.h"
+#include "game_logic.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+/**
+ * @brief Simulates several configs side by side on one pool of worker threads.
+ *
+ * Every strategy plays num_simulations decks of every config (all seats
+ * using it), like the simulate mode. The games of the configs are
+ * interleaved before being split between the workers, so every worker plays
+ * a mix of configs and the threads stay busy until the end. Each game reads
+ * its rules from its own config only.
+ *
+ * @param configs The validated configs.
+ * @param config_names The name printed for each config (its file name).
+ * @param strategies The available strategies, by name.
+ * @param num_threads The number of worker threads.
+ */
+void run_multi_config(const std::vector<GameConfig> &configs, const std::vector<std::string> &config_names, const std::map<std::string, StrategyFunction> &strategies, int num_threads)
+{
+    std::vector<std::string> strategy_names;
+    std::vector<StrategyFunction> strategy_functions;
+    for (auto const &[name, func] : strategies)
+    {
+        strategy_names.push_back(name);
+        strategy_functions.push_back(func);
+    }
+    const int num_configs = configs.size();
+    const int num_strategies = strategy_functions.size();
+
+    // Round-robin order of (config, game) so that every chunk mixes the configs
+    std::vector<std::pair<int, int>> tasks;
+    std::vector<int> next_game(num_configs, 0);
+    for (bool added = true; added;)
+    {
+        added = false;
+        for (int c = 0; c < num_configs; ++c)
+        {
+            if (next_game[c] < configs[c].num_simulations)
+            {
+                tasks.push_back({c, next_game[c]++});
+                added = true;
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> initial_decks;
+    for (const auto &config : configs)
+    {
+        initial_decks.push_back(create_deck(config));
+    }
+
+    int workers = std::max(1, std::min<int>(num_threads, tasks.size()));
+    // Per worker, wins of [config * strategies + strategy]
+    std::vector<std::vector<long long>> worker_wins(workers, std::vector<long long>(num_configs * num_strategies, 0));
+
+    auto start = std::chrono::steady_clock::now();
+    parallel_for_chunks(tasks.size(), workers, [&](int begin, int end, int worker) {
+        std::vector<std::vector<int>> final_playing_rows;
+        std::vector<std::vector<int>> final_hand;
+        for (int t = begin; t < end; ++t)
+        {
+            int c = tasks[t].first;
+            const GameConfig &config = configs[c];
+            std::vector<int> game_deck = initial_decks[c];
+            shuffle(game_deck);
+            for (int s = 0; s < num_strategies; ++s)
+            {
+                int turns = 0;
+                if (simulate_game_multiplayer(config, strategy_functions[s], config.number_of_players, game_deck, turns, final_playing_rows, final_hand))
+                {
+                    worker_wins[worker][c * num_strategies + s]++;
+                }
+            }
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int c = 0; c < num_configs; ++c)
+    {
+        std::cout << config_names[c] << ": " << configs[c].number_of_players << " Players, "
+                  << configs[c].num_simulations << " decks\n";
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            long long wins = 0;
+            for (const auto &counts : worker_wins)
+            {
+                wins += counts[c * num_strategies + s];
+            }
+            double win_rate = configs[c].num_simulations > 0 ? 100.0 * wins / configs[c].num_simulations : 0.0;
+            std::cout << strategy_names[s] << " win rate: " << win_rate << " %\n";
+        }
+    }
+    std::cout << tasks.size() * num_strategies << " games on " << workers << " threads in " << seconds << " s\n";
+}
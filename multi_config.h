@@ -0,0 +1,13 @@
+#ifndef MULTI_CONFIG_H
+#define MULTI_CONFIG_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+void run_multi_config(const std::vector<GameConfig> &configs, const std::vector<std::string> &config_names, const std::map<std::string, StrategyFunction> &strategies, int num_threads);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the user did not ask for a specific count.
+inline int default_thread_count()
+{
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 0 ? static_cast<int>(hardware_threads) : 1;
+}
+
+/**
+ * @brief Splits [0, count) into contiguous chunks and runs body(begin, end, worker) on each one.
+ *
+ * Chunk w is processed by worker thread w. With a single thread (or a single
+ * item) the body runs on the calling thread and no thread is created.
+ *
+ * @param count The number of items to process.
+ * @param num_threads The maximum number of worker threads.
+ * @param body Callable taking (int begin, int end, int worker).
+ */
+template <typename Body>
+void parallel_for_chunks(int count, int num_threads, Body body)
+{
+    int workers = std::max(1, std::min(num_threads, count));
+    if (workers == 1)
+    {
+        body(0, count, 0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (int w = 0; w < workers; ++w)
+    {
+        int begin = static_cast<int>(static_cast<long long>(count) * w / workers);
+        int end = static_cast<int>(static_cast<long long>(count) * (w + 1) / workers);
+        threads.emplace_back([=, &body]() { body(begin, end, w); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+#endif
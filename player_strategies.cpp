@@ -1,17 +1,97 @@
 #include "player_strategies.h"
 #include "helper_functions.h"
+#include "move_cache.h"
+#include "card_tracking.h"
+#include "game_config.h"
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 
-// Constants (defined in main.cpp, declared extern here)
-extern int CARD_MAX_NUMBER;   // Maximum value of a card
-extern int REVERSE_MOVE_DIFF; // Difference needed for a reverse move
-extern int NUMBER_OF_ROWS;    // Number of rows in the playing area
-extern int GOOD_MOVE_WINDOW;  // interval for good moves
+/**
+ * @brief Returns the strategy parameters the built-in strategies were written with.
+ *
+ * The good-move window comes from the game config (GOOD_MOVE_WINDOW).
+ *
+ * @param config The game config.
+ * @return The default StrategyParams.
+ */
+StrategyParams default_strategy_params(const GameConfig &config)
+{
+    StrategyParams params;
+    params.claimed_row_penalty = 100;
+    params.panic_threshold = 2;
+    params.good_move_window = config.good_move_window;
+    return params;
+}
+
+/**
+ * @brief Evaluates playing a card on a row, through the engine's per-turn cache when there is one.
+ *
+ * Only valid for the current top of the row; evaluations against a simulated
+ * top (lookahead) must call is_valid_move directly.
+ *
+ * @param context The strategy context handed over by the engine.
+ * @param card The card to play.
+ * @param row The index of the row.
+ * @param row_top The current top card of the row.
+ * @return ValidMove enum, as is_valid_move.
+ */
+ValidMove evaluate_move(const StrategyContext &context, int card, int row, int row_top)
+{
+    if (context.cache != nullptr)
+    {
+        return context.cache->evaluate(card, row, row_top);
+    }
+    return is_valid_move(context.config, card, row_top, row < context.config.number_of_rows / 2);
+}
+
+/**
+ * @brief Computes, for every card in hand, the set of rows it can currently be played on.
+ *
+ * Bit j of the result for card k is set when hand[k] can be played on row j
+ * (so at most 32 rows are supported).
+ */
+RowMasks get_playable_rows(const Hand &hand, const PlayingRows &playing_rows, const StrategyContext &context)
+{
+    RowMasks playable_rows(hand.size(), 0, context.memory);
+    for (int k = 0; k < hand.size(); ++k)
+    {
+        for (int l = 0; l < context.config.number_of_rows; ++l)
+        {
+            if (evaluate_move(context, hand[k], l, playing_rows[l].back()) != ValidMove::NO)
+            {
+                playable_rows[k] |= 1u << l;
+            }
+        }
+    }
+    return playable_rows;
+}
 
-std::vector<int> get_claimed_rows(const std::vector<Communication> &communications, int player_id)
+/**
+ * @brief Counts the cards of the hand, other than hand[i], still playable after hand[i] goes on row j.
+ *
+ * Only the top of row j changes, so a card stays playable if it fits another
+ * row (from playable_rows) or fits row j with hand[i] as its new top.
+ */
+int count_playable_after(const Hand &hand, const RowMasks &playable_rows, int i, int j, const StrategyContext &context)
 {
-    std::vector<int> claimed_rows;
+    bool is_ascending = j < context.config.number_of_rows / 2;
+    int playable_after = 0;
+    for (int k = 0; k < hand.size(); ++k)
+    {
+        // Skip the card that was just "played"
+        if (k != i && ((playable_rows[k] & ~(1u << j)) != 0 || is_valid_move(context.config, hand[k], hand[i], is_ascending) != ValidMove::NO))
+        {
+            playable_after++;
+        }
+    }
+    return playable_after;
+}
+
+std::pmr::vector<int> get_claimed_rows(const Communications &communications, int player_id, std::pmr::memory_resource *memory)
+{
+    std::pmr::vector<int> claimed_rows(memory);
+    claimed_rows.reserve(communications.size());
     for (const auto &comm : communications)
     {
         if (comm.player_id != player_id)
@@ -32,7 +112,7 @@ std::vector<int> get_claimed_rows(const std::vector<Communication> &communicatio
  * @param playing_rows The current state of the playing rows.
  * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_A1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
     int best_card_index = -1; // Store the *index* of the best card
     int best_card = -1;
@@ -40,14 +120,14 @@ std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::
     int min_diff = std::numeric_limits<int>::max(); // Use numeric_limits for max value
 
     // --- Observation Phase ---
-    std::vector<int> claimed_rows = get_claimed_rows(communications, player_id);
+    std::pmr::vector<int> claimed_rows = get_claimed_rows(communications, player_id, context.memory);
 
     // --- Decision-Making Phase (with Communication) ---
     for (int i = 0; i < hand.size(); ++i)
     {
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
-            ValidMove valid_move = is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2);
+            ValidMove valid_move = evaluate_move(context, hand[i], j, playing_rows[j].back());
             if (valid_move != ValidMove::NO)
             {
                 int diff = (valid_move == ValidMove::REVERSE_MOVE) ? -1 : std::abs(hand[i] - playing_rows[j].back());
@@ -55,9 +135,9 @@ std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::
                 // Check if the row is claimed.  If it is, and our move is "bad", increase the diff
                 // to make it less likely to be chosen.
                 bool row_is_claimed = std::find(claimed_rows.begin(), claimed_rows.end(), j) != claimed_rows.end();
-                if (row_is_claimed && diff > GOOD_MOVE_WINDOW)
-                { // Consider it a less good move if diff > GOOD_MOVE_WINDOW
-                    diff = diff * 100;
+                if (row_is_claimed && diff > context.params.good_move_window)
+                { // Consider it a less good move if diff > good_move_window
+                    diff = diff * context.params.claimed_row_penalty;
                 }
 
                 if (diff < min_diff)
@@ -84,7 +164,7 @@ std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::
  * @param playing_rows The current state of the playing rows.
  * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_A2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_A2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
     int best_card_index = -1; // Store the *index* of the best card
     int best_card = -1;
@@ -94,9 +174,9 @@ std::pair<int, int> get_player_move_A2(const std::vector<int> &hand, const std::
     // --- Decision-Making Phase (with Communication) ---
     for (int i = 0; i < hand.size(); ++i)
     {
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
-            ValidMove valid_move = is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2);
+            ValidMove valid_move = evaluate_move(context, hand[i], j, playing_rows[j].back());
             if (valid_move != ValidMove::NO)
             {
                 int diff = (valid_move == ValidMove::REVERSE_MOVE) ? -1 : std::abs(hand[i] - playing_rows[j].back());
@@ -125,63 +205,45 @@ std::pair<int, int> get_player_move_A2(const std::vector<int> &hand, const std::
  * @param playing_rows The current state of the playing rows.
  * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_E1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_E1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
     int best_card_index = -1;
     int best_card = -1;                 // Initialize the best card to -1 (no card selected yet)
     int best_row = -1;                  // Initialize the best row to -1 (no row selected yet)
     int max_playable_after = -1;        // Initialize the maximum playable cards after to -1
-    int min_diff = CARD_MAX_NUMBER * 2; // Initialize the minimum difference to a large value
+    int min_diff = context.config.card_max_number * 2; // Initialize the minimum difference to a large value
 
     // --- Observation Phase ---
-    std::vector<int> claimed_rows = get_claimed_rows(communications, player_id);
+    std::pmr::vector<int> claimed_rows = get_claimed_rows(communications, player_id, context.memory);
+
+    // Rows each card can be played on right now (bit j set = playable on row j)
+    RowMasks playable_rows = get_playable_rows(hand, playing_rows, context);
 
     // Iterate through each card in the player's hand
     for (int i = 0; i < hand.size(); ++i)
     {
         // Iterate through each row in the playing area
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
             // Check if the current card can be played on the current row
-            if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            if (playable_rows[i] & (1u << j))
             {
-                // Simulate the move (create copies of playing rows)
-                std::vector<std::vector<int>> temp_rows = playing_rows;
-                temp_rows[j].push_back(hand[i]);
-
-                int playable_after = 0; // Initialize the count of playable cards after the move
-                // Iterate through the remaining cards in the hand
-                for (int k = 0; k < hand.size(); ++k)
-                {
-                    // Skip the card that was just "played"
-                    if (static_cast<unsigned long long>(i) != k)
-                    {
-                        // Iterate through each row to check playability
-                        for (int l = 0; l < NUMBER_OF_ROWS; ++l)
-                        {
-                            // If the remaining card is playable on any row
-                            if (is_valid_move(hand[k], temp_rows[l].back(), l < NUMBER_OF_ROWS / 2) != ValidMove::NO)
-                            {
-                                // Increment the count of playable cards and break the inner loop
-                                playable_after++;
-                                break;
-                            }
-                        }
-                    }
-                }
+                // Count the cards still playable after the move; only row j changes,
+                // so the other rows reuse the evaluations in playable_rows
+                int playable_after = count_playable_after(hand, playable_rows, i, j, context);
 
                 // Calculate the difference between the card and the row's top card
                 int diff = std::abs(hand[i] - playing_rows[j].back());
 
-                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) == ValidMove::REVERSE_MOVE)
+                if (evaluate_move(context, hand[i], j, playing_rows[j].back()) == ValidMove::REVERSE_MOVE)
                     diff = -1;
 
                 // Check if the row is claimed.  If it is, and our move is "bad", increase the diff
                 // to make it less likely to be chosen.
                 bool row_is_claimed = std::find(claimed_rows.begin(), claimed_rows.end(), j) != claimed_rows.end();
-                if (row_is_claimed && diff > GOOD_MOVE_WINDOW)
-                { // Consider it a less good move if diff > GOOD_MOVE_WINDOW
-                    diff = diff * 100;
+                if (row_is_claimed && diff > context.params.good_move_window)
+                { // Consider it a less good move if diff > good_move_window
+                    diff = diff * context.params.claimed_row_penalty;
                 }
 
                 // Tie-breaker logic: If playable_after is the same, choose the smaller diff
@@ -219,51 +281,33 @@ std::pair<int, int> get_player_move_E1(const std::vector<int> &hand, const std::
  * @param playing_rows The current state of the playing rows.
  * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_E2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_E2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
     int best_card_index = -1;
     int best_card = -1;                 // Initialize the best card to -1 (no card selected yet)
     int best_row = -1;                  // Initialize the best row to -1 (no row selected yet)
     int max_playable_after = -1;        // Initialize the maximum playable cards after to -1
-    int min_diff = CARD_MAX_NUMBER * 2; // Initialize the minimum difference to a large value
+    int min_diff = context.config.card_max_number * 2; // Initialize the minimum difference to a large value
+
+    // Rows each card can be played on right now (bit j set = playable on row j)
+    RowMasks playable_rows = get_playable_rows(hand, playing_rows, context);
 
     // Iterate through each card in the player's hand
     for (int i = 0; i < hand.size(); ++i)
     {
         // Iterate through each row in the playing area
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
             // Check if the current card can be played on the current row
-            if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            if (playable_rows[i] & (1u << j))
             {
-                // Simulate the move (create copies of playing rows)
-                std::vector<std::vector<int>> temp_rows = playing_rows;
-                temp_rows[j].push_back(hand[i]);
-
-                int playable_after = 0; // Initialize the count of playable cards after the move
-                // Iterate through the remaining cards in the hand
-                for (int k = 0; k < hand.size(); ++k)
-                {
-                    // Skip the card that was just "played"
-                    if (static_cast<unsigned long long>(i) != k)
-                    {
-                        // Iterate through each row to check playability
-                        for (int l = 0; l < NUMBER_OF_ROWS; ++l)
-                        {
-                            // If the remaining card is playable on any row
-                            if (is_valid_move(hand[k], temp_rows[l].back(), l < NUMBER_OF_ROWS / 2) != ValidMove::NO)
-                            {
-                                // Increment the count of playable cards and break the inner loop
-                                playable_after++;
-                                break;
-                            }
-                        }
-                    }
-                }
+                // Count the cards still playable after the move; only row j changes,
+                // so the other rows reuse the evaluations in playable_rows
+                int playable_after = count_playable_after(hand, playable_rows, i, j, context);
 
                 // Calculate the difference between the card and the row's top card
                 int diff = std::abs(hand[i] - playing_rows[j].back());
-                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) == ValidMove::REVERSE_MOVE)
+                if (evaluate_move(context, hand[i], j, playing_rows[j].back()) == ValidMove::REVERSE_MOVE)
                     diff = -1;
 
                 // Tie-breaker logic: If playable_after is the same, choose the smaller diff
@@ -303,7 +347,7 @@ std::pair<int, int> get_player_move_E2(const std::vector<int> &hand, const std::
  * @return A pair containing the best card to play and
  * the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_H1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
 
     int total_valid_moves = 0; // Initialize the count of valid moves
@@ -312,10 +356,10 @@ std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::
     for (int card : hand)
     {
         // Iterate through each row in the playing area
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
             // If the card can be played on the current row
-            if (is_valid_move(card, playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            if (evaluate_move(context, card, j, playing_rows[j].back()) != ValidMove::NO)
             {
                 // Increment the count of valid moves
                 total_valid_moves++;
@@ -323,8 +367,8 @@ std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::
         }
     }
 
-    // If there are very few valid moves left (2 or less)
-    if (total_valid_moves <= 2)
+    // If there are very few valid moves left (panic_threshold or less)
+    if (total_valid_moves <= context.params.panic_threshold)
     {
         int best_card_index = -1;
         int best_card = -1; // Initialize the best card to -1 (no card selected yet)
@@ -333,13 +377,13 @@ std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::
         // Try to play the largest possible card on an ascending row, or the smallest on a descending row
         for (int i = 0; i < hand.size(); ++i)
         {
-            for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+            for (int j = 0; j < context.config.number_of_rows; ++j)
             {
                 // If the card can be played on the current row
-                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                if (evaluate_move(context, hand[i], j, playing_rows[j].back()) != ValidMove::NO)
                 {
                     // If it's an ascending row
-                    if (j < NUMBER_OF_ROWS / 2)
+                    if (j < context.config.number_of_rows / 2)
                     {
                         // Choose the largest card
                         if (best_card == -1 || hand[i] > best_card)
@@ -368,7 +412,7 @@ std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::
     }
 
     // Otherwise, default to Strategy E (a good general-purpose strategy)
-    return get_player_move_E1(hand, playing_rows, communications, player_id);
+    return get_player_move_E1(hand, playing_rows, communications, player_id, context);
 }
 
 /**
@@ -383,7 +427,7 @@ std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::
  * @return A pair containing the best card to play and
  * the row index, or {-1, -1} if no valid move.
  */
-std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+std::pair<int, int> get_player_move_H2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
 {
 
     int total_valid_moves = 0; // Initialize the count of valid moves
@@ -391,10 +435,10 @@ std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::
     for (int card : hand)
     {
         // Iterate through each row in the playing area
-        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        for (int j = 0; j < context.config.number_of_rows; ++j)
         {
             // If the card can be played on the current row
-            if (is_valid_move(card, playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            if (evaluate_move(context, card, j, playing_rows[j].back()) != ValidMove::NO)
             {
                 // Increment the count of valid moves
                 total_valid_moves++;
@@ -402,8 +446,8 @@ std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::
         }
     }
 
-    // If there are very few valid moves left (2 or less)
-    if (total_valid_moves <= 2)
+    // If there are very few valid moves left (panic_threshold or less)
+    if (total_valid_moves <= context.params.panic_threshold)
     {
         int best_card_index = -1;
         int best_card = -1; // Initialize the best card to -1 (no card selected yet)
@@ -412,13 +456,13 @@ std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::
         // Try to play the largest possible card on an ascending row, or the smallest on a descending row
         for (int i = 0; i < hand.size(); ++i)
         {
-            for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+            for (int j = 0; j < context.config.number_of_rows; ++j)
             {
                 // If the card can be played on the current row
-                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                if (evaluate_move(context, hand[i], j, playing_rows[j].back()) != ValidMove::NO)
                 {
                     // If it's an ascending row
-                    if (j < NUMBER_OF_ROWS / 2)
+                    if (j < context.config.number_of_rows / 2)
                     {
                         // Choose the largest card
                         if (best_card == -1 || hand[i] > best_card)
@@ -447,5 +491,70 @@ std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::
     }
 
     // Otherwise, default to Strategy E (a good general-purpose strategy)
-    return get_player_move_E2(hand, playing_rows, communications, player_id);
+    return get_player_move_E2(hand, playing_rows, communications, player_id, context);
+}
+
+/**
+ * @brief Strategy J: plays the move that skips the fewest cards still in play.
+ *
+ * A jump over cards that were already played costs nothing, so instead of the
+ * raw distance to the row top (Strategy A) a move costs the cards between the
+ * top and the played card that are not played yet: the ones the player has
+ * not seen plus its own. The cost is halved as far as the reverse card of the
+ * new top is likely to be in a hand, because that card can still bring the
+ * row back. Reverse tricks come first; the distance breaks ties. Without a
+ * card tracker every card in between counts as unseen.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications What the players announced this turn (not used).
+ * @param player_id The id of the deciding player.
+ * @param context The strategy context handed over by the engine.
+ * @return A pair containing the best card index and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_J(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    int best_card_index = -1;
+    int best_row = -1;
+    double min_cost = std::numeric_limits<double>::max();
+    int min_diff = std::numeric_limits<int>::max();
+
+    for (int i = 0; i < hand.size(); ++i)
+    {
+        for (int j = 0; j < context.config.number_of_rows; ++j)
+        {
+            int row_top = playing_rows[j].back();
+            ValidMove valid_move = evaluate_move(context, hand[i], j, row_top);
+            if (valid_move == ValidMove::NO)
+            {
+                continue;
+            }
+
+            int diff = std::abs(hand[i] - row_top);
+            double cost = -1.0;
+            if (valid_move != ValidMove::REVERSE_MOVE)
+            {
+                int skipped = context.cards ? context.cards->count_unseen_between(player_id, row_top, hand[i]) : diff - 1;
+                if (context.cards)
+                {
+                    for (int card : hand)
+                    {
+                        skipped += (card > row_top && card < hand[i]) || (card < row_top && card > hand[i]);
+                    }
+                }
+                double rescue = context.cards ? context.cards->reverse_card_live_probability(player_id, j, hand[i]) : 0.0;
+                cost = skipped * (1.0 - 0.5 * rescue);
+            }
+
+            if (cost < min_cost || (cost == min_cost && diff < min_diff))
+            {
+                min_cost = cost;
+                min_diff = diff;
+                best_card_index = i;
+                best_row = j;
+            }
+        }
+    }
+
+    return {best_card_index, best_row};
 }
@@ -1,7 +1,16 @@
 #ifndef PLAYER_STRATEGIES_H
 #define PLAYER_STRATEGIES_H
 
+#include <cstdint>
 #include <vector>
+#include <memory_resource>
+#include <utility>
+
+#include "helper_functions.h"
+
+class MoveCache;
+class CardTracker;
+struct GameConfig;
 
 struct Communication {
     int player_id;
@@ -15,22 +24,52 @@ struct Communication {
                         // +1 = slightly bad, +2 = bad, +3 = very bad
 };
 
-std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
-std::pair<int, int> get_player_move_A2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
+using Communications = std::pmr::vector<Communication>;
+using RowMasks = std::pmr::vector<uint32_t>; // Per card of a hand, bit j set = playable on row j
+using TurnPlan = std::pmr::vector<std::pair<int, int>>; // Moves of a whole turn in play order: {card index in the hand at turn start, row index}
+
+// Tuning constants of the built-in strategies (see default_strategy_params for the defaults).
+struct StrategyParams {
+    int claimed_row_penalty; // A1/E1: a far move on a row claimed by another player counts as diff * penalty
+    int panic_threshold;     // H1/H2: play the extreme card when there are at most this many valid moves
+    int good_move_window;    // A1/E1 and communications: a move closer than this to the row top is "good"
+};
+
+// Everything the engine hands to a strategy besides the visible game state.
+struct StrategyContext {
+    const GameConfig &config; // Rules of the game being played
+    StrategyParams params;
+    MoveCache *cache; // Per-turn (card, row) evaluations kept by the engine, or nullptr
+    std::pmr::memory_resource *memory = std::pmr::get_default_resource(); // Scratch allocations; the engine's arena is reset between games
+    const CardTracker *cards = nullptr; // Unseen cards of every player (query with the player_id), or nullptr
+    int cards_to_plan = 0;              // Cards left to play in this turn, or 0 if the engine does not say
+    TurnPlan *turn_plan = nullptr;      // Set on the first move of a turn by engines that take whole-turn plans (see play_turn_plan)
+};
+
+// Signature shared by every player strategy: returns {card index in hand, row index}, or {-1, -1} if no valid move.
+using StrategyFunction = std::pair<int, int> (*)(const Hand &, const PlayingRows &, const Communications &, int, const StrategyContext &);
+// Optional whole-turn entry point: fills the plan with the moves of the turn (fewer than asked = the turn fails after them).
+using TurnStrategyFunction = void (*)(const Hand &, const PlayingRows &, const Communications &, int, const StrategyContext &, TurnPlan &);
+
+StrategyParams default_strategy_params(const GameConfig &config);
+ValidMove evaluate_move(const StrategyContext &context, int card, int row, int row_top);
+RowMasks get_playable_rows(const Hand &hand, const PlayingRows &playing_rows, const StrategyContext &context);
+int count_playable_after(const Hand &hand, const RowMasks &playable_rows, int i, int j, const StrategyContext &context);
 
-// std::pair<int, int> get_player_move_B(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
-// std::pair<int, int> get_player_move_C(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
-// std::pair<int, int> get_player_move_D(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
+std::pair<int, int> get_player_move_A1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_A2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
 
-std::pair<int, int> get_player_move_E1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
-std::pair<int, int> get_player_move_E2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
+std::pair<int, int> get_player_move_E1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_E2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
 
-// std::pair<int, int> get_player_move_F(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
-// std::pair<int, int> get_player_move_G(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
+std::pair<int, int> get_player_move_H1(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_H2(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
 
-std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
-std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication>& communications, int player_id);
+std::pair<int, int> get_player_move_J(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
 
-// std::pair<int, int> get_player_move_I(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows);
+// Strategies B, C, D, F, G and I are feature-weighted presets, see weighted_strategy.h
+// Strategy K plans whole turns, see turn_planning.h
+// Strategy L is a learned linear policy, see learned_policy.h
+// Strategy T plays endgames from a tablebase, see endgame_tablebase.h
 
 #endif
\ No newline at end of file
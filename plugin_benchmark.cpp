@@ -0,0 +1,130 @@
+#include "plugin_benchmark.h"
+#include "game_logic.h"
+#include "helper_functions.h"
+#include "lockstep_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+const int LOCKSTEP_BATCH = 1024; // Games played in lockstep (decisions per plugin call)
+
+// Games per second of a run of num_games games that took `seconds`
+double games_per_second(int num_games, double seconds)
+{
+    return seconds > 0 ? num_games / seconds : 0.0;
+}
+
+// Plays the setups in lockstep batches and returns the elapsed seconds
+double time_lockstep(const GameConfig &config, const std::vector<GameSetup> &setups, BatchDecider &decider, const StrategyParams &params, std::vector<LockstepOutcome> &outcomes)
+{
+    auto start = std::chrono::steady_clock::now();
+    outcomes.clear();
+    std::vector<GameSetup> batch;
+    std::vector<LockstepOutcome> batch_outcomes;
+    for (size_t begin = 0; begin < setups.size(); begin += LOCKSTEP_BATCH)
+    {
+        size_t end = std::min(setups.size(), begin + LOCKSTEP_BATCH);
+        batch.assign(setups.begin() + begin, setups.begin() + end);
+        play_lockstep(config, batch, decider, params, batch_outcomes);
+        outcomes.insert(outcomes.end(), batch_outcomes.begin(), batch_outcomes.end());
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double win_rate(const std::vector<LockstepOutcome> &outcomes)
+{
+    long long wins = 0;
+    for (const auto &outcome : outcomes)
+    {
+        wins += outcome.won;
+    }
+    return outcomes.empty() ? 0.0 : 100.0 * wins / outcomes.size();
+}
+
+int count_identical(const std::vector<LockstepOutcome> &a, const std::vector<LockstepOutcome> &b)
+{
+    int identical = 0;
+    for (size_t g = 0; g < a.size() && g < b.size(); ++g)
+    {
+        identical += a[g].won == b[g].won && a[g].turns == b[g].turns && a[g].deck_size == b[g].deck_size;
+    }
+    return identical;
+}
+
+} // namespace
+
+/**
+ * @brief Compares every plugin strategy with the in-binary strategy of the same name on the same deals.
+ *
+ * Three ways of playing the same setups are timed: the regular engine with
+ * the in-binary strategy, the lockstep engine with the in-binary strategy,
+ * and the lockstep engine with the plugin (one ABI call per batch of
+ * decisions). The outcomes of the three must be identical for a plugin built
+ * from the same code.
+ *
+ * @param config The game config the plugins were loaded with.
+ * @param plugins The loaded plugins.
+ * @param strategies The in-binary strategies, by name.
+ * @param num_players The number of players at the table.
+ * @param num_games The number of decks to play.
+ */
+void run_plugin_benchmark(const GameConfig &config, const std::vector<LoadedPlugin> &plugins, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games)
+{
+    std::vector<int> initial_deck = create_deck(config);
+    std::vector<GameSetup> setups;
+    setups.reserve(num_games);
+    for (int game = 0; game < num_games; ++game)
+    {
+        std::vector<int> game_deck = initial_deck;
+        shuffle(game_deck);
+        setups.push_back(setup_game(config, num_players, game_deck));
+    }
+    StrategyParams params = default_strategy_params(config);
+
+    std::cout << num_players << " Players, " << num_games << " decks, lockstep batches of " << LOCKSTEP_BATCH << " games:\n";
+    for (const auto &plugin : plugins)
+    {
+        for (int s = 0; s < plugin.table->num_strategies; ++s)
+        {
+            std::string name = plugin.table->strategy_names[s];
+            PluginDecider plugin_decider(plugin.table, s);
+            std::vector<LockstepOutcome> plugin_outcomes;
+            double plugin_seconds = time_lockstep(config, setups, plugin_decider, params, plugin_outcomes);
+
+            std::cout << plugin.table->name << ":" << name << ": plugin lockstep " << win_rate(plugin_outcomes) << " % wins, "
+                      << games_per_second(num_games, plugin_seconds) << " games/s\n";
+
+            auto in_binary = strategies.find(name);
+            if (in_binary == strategies.end())
+            {
+                continue;
+            }
+
+            FunctionDecider function_decider(config, in_binary->second);
+            std::vector<LockstepOutcome> function_outcomes;
+            double function_seconds = time_lockstep(config, setups, function_decider, params, function_outcomes);
+
+            std::vector<StrategyFunction> seat_strategies(num_players, in_binary->second);
+            std::vector<LockstepOutcome> engine_outcomes(num_games);
+            std::vector<std::vector<int>> final_playing_rows;
+            std::vector<std::vector<int>> final_hand;
+            auto start = std::chrono::steady_clock::now();
+            for (int game = 0; game < num_games; ++game)
+            {
+                LockstepOutcome &outcome = engine_outcomes[game];
+                outcome.won = simulate_game_multiplayer(config, seat_strategies, setups[game], params, outcome.turns, final_playing_rows, final_hand, &outcome.deck_size);
+            }
+            double engine_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "  in-binary " << name << ": engine " << win_rate(engine_outcomes) << " % wins, "
+                      << games_per_second(num_games, engine_seconds) << " games/s; lockstep "
+                      << games_per_second(num_games, function_seconds) << " games/s\n";
+            std::cout << "  identical outcomes: " << count_identical(plugin_outcomes, engine_outcomes) << "/" << num_games
+                      << " (plugin vs engine), " << count_identical(function_outcomes, engine_outcomes) << "/" << num_games
+                      << " (lockstep vs engine)\n";
+        }
+    }
+}
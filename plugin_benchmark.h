@@ -0,0 +1,12 @@
+#ifndef PLUGIN_BENCHMARK_H
+#define PLUGIN_BENCHMARK_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "plugin_loader.h"
+
+void run_plugin_benchmark(const GameConfig &config, const std::vector<LoadedPlugin> &plugins, const std::map<std::string, StrategyFunction> &strategies, int num_players, int num_games);
+
+#endif
@@ -0,0 +1,141 @@
+#include "plugin_loader.h"
+
+#include <array>
+#include <dlfcn.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Plugin strategy behind each trampoline
+struct PluginSlot
+{
+    const thegame_plugin *plugin;
+    int strategy;
+};
+PluginSlot plugin_slots[MAX_PLUGIN_STRATEGIES];
+int used_slots = 0;
+
+// Single decision of the regular engine, as a batch of one
+std::pair<int, int> decide_with_plugin(const PluginSlot &slot, const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    static thread_local std::vector<int32_t> row_tops;
+    static thread_local std::vector<thegame_communication> plugin_communications;
+    row_tops.resize(playing_rows.size());
+    for (size_t r = 0; r < playing_rows.size(); ++r)
+    {
+        row_tops[r] = playing_rows[r].back();
+    }
+    plugin_communications.clear();
+    for (const auto &comm : communications)
+    {
+        plugin_communications.push_back({comm.player_id, comm.row_index, comm.type, comm.relative_value});
+    }
+
+    thegame_params params = to_plugin_params(context.params);
+    thegame_decision_request request = {hand.data(), static_cast<int32_t>(hand.size()), row_tops.data(),
+                                        plugin_communications.data(), static_cast<int32_t>(plugin_communications.size()), player_id};
+    thegame_decision decision;
+    slot.plugin->decide_batch(slot.strategy, &params, &request, 1, &decision);
+    return {decision.card_index, decision.row_index};
+}
+
+// StrategyFunction is a plain function pointer: one instantiation per slot
+template <int Slot>
+std::pair<int, int> plugin_trampoline(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return decide_with_plugin(plugin_slots[Slot], hand, playing_rows, communications, player_id, context);
+}
+
+template <int... Slots>
+constexpr std::array<StrategyFunction, sizeof...(Slots)> make_trampolines(std::integer_sequence<int, Slots...>)
+{
+    return {plugin_trampoline<Slots>...};
+}
+
+const std::array<StrategyFunction, MAX_PLUGIN_STRATEGIES> trampolines = make_trampolines(std::make_integer_sequence<int, MAX_PLUGIN_STRATEGIES>());
+
+} // namespace
+
+/**
+ * @brief Loads a strategy shared object and initialises it with the rules of a config.
+ *
+ * The plugin keeps these rules for the whole run, so its strategies must only
+ * play games of this config.
+ *
+ * @param config The game config whose rules the plugin receives.
+ * @param path The path of the shared object (as given to dlopen).
+ * @param plugin (Output) The loaded plugin.
+ * @param error (Output) Why the plugin could not be loaded.
+ * @return True on success.
+ */
+bool load_strategy_plugin(const GameConfig &config, const std::string &path, LoadedPlugin &plugin, std::string &error)
+{
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        error = dlerror();
+        return false;
+    }
+    auto get_plugin = reinterpret_cast<thegame_get_plugin_fn>(dlsym(handle, THEGAME_PLUGIN_ENTRY));
+    if (get_plugin == nullptr)
+    {
+        error = path + " does not export " THEGAME_PLUGIN_ENTRY;
+        dlclose(handle);
+        return false;
+    }
+    const thegame_plugin *table = get_plugin();
+    if (table == nullptr || table->abi_version != THEGAME_PLUGIN_ABI_VERSION)
+    {
+        error = path + " was built for another plugin ABI version";
+        dlclose(handle);
+        return false;
+    }
+
+    thegame_rules rules = {config.card_max_number, config.reverse_move_diff, config.number_of_rows,
+                           config.card_in_hands, config.num_cards_to_play, config.good_move_window};
+    if (table->init(&rules) != 0)
+    {
+        error = path + " does not support this configuration";
+        dlclose(handle);
+        return false;
+    }
+    plugin.path = path;
+    plugin.table = table;
+    return true;
+}
+
+/**
+ * @brief Adds every strategy of a plugin to the strategy map, as "<plugin>:<strategy>".
+ *
+ * The regular engine then calls them with batches of one decision.
+ *
+ * @param plugin The loaded plugin.
+ * @param strategies The strategy map to extend.
+ * @param error (Output) Why the strategies could not be registered.
+ * @return True on success.
+ */
+bool register_plugin_strategies(const LoadedPlugin &plugin, std::map<std::string, StrategyFunction> &strategies, std::string &error)
+{
+    if (used_slots + plugin.table->num_strategies > MAX_PLUGIN_STRATEGIES)
+    {
+        error = "too many plugin strategies (at most " + std::to_string(MAX_PLUGIN_STRATEGIES) + ")";
+        return false;
+    }
+    for (int s = 0; s < plugin.table->num_strategies; ++s)
+    {
+        plugin_slots[used_slots] = {plugin.table, s};
+        strategies[std::string(plugin.table->name) + ":" + plugin.table->strategy_names[s]] = trampolines[used_slots];
+        used_slots++;
+    }
+    return true;
+}
+
+PluginDecider::PluginDecider(const thegame_plugin *plugin, int strategy) : plugin_(plugin), strategy_(strategy)
+{
+}
+
+void PluginDecider::decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions)
+{
+    plugin_->decide_batch(strategy_, &params, requests, count, decisions);
+}
@@ -0,0 +1,37 @@
+#ifndef PLUGIN_LOADER_H
+#define PLUGIN_LOADER_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "lockstep_engine.h"
+#include "player_strategies.h"
+#include "strategy_plugin.h"
+
+// Most plugin strategies that can be registered as StrategyFunction at once
+const int MAX_PLUGIN_STRATEGIES = 32;
+
+// A strategy plugin loaded for the whole run (never unloaded)
+struct LoadedPlugin
+{
+    std::string path;
+    const thegame_plugin *table = nullptr;
+};
+
+bool load_strategy_plugin(const GameConfig &config, const std::string &path, LoadedPlugin &plugin, std::string &error);
+bool register_plugin_strategies(const LoadedPlugin &plugin, std::map<std::string, StrategyFunction> &strategies, std::string &error);
+
+// Decides a whole batch with one call into a plugin
+class PluginDecider : public BatchDecider
+{
+public:
+    PluginDecider(const thegame_plugin *plugin, int strategy);
+    void decide(const thegame_params &params, const thegame_decision_request *requests, int count, thegame_decision *decisions) override;
+
+private:
+    const thegame_plugin *plugin_;
+    int strategy_;
+};
+
+#endif
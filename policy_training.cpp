@@ -0,0 +1,195 @@
+#include "policy_training.h"
+#include "game_logic.h"
+#include "learned_policy.h"
+#include "lockstep_engine.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int CEM_ITERATIONS = 20;
+const int CEM_POPULATION = 32;     // Candidates per iteration, the current mean included
+const int CEM_ELITES = 6;          // Best candidates the next distribution is fitted to
+const double CEM_SMOOTHING = 0.7;  // Weight of the elites against the previous distribution
+const double CEM_MIN_SIGMA = 0.05; // Keeps the search from collapsing early
+const uint64_t HELD_OUT_DEALS = 1ULL << 40; // Game offset of the evaluation deals (never trained on)
+
+// Deals number first .. first + count - 1 of a seed, as in the daemon and the C API
+std::vector<GameSetup> seeded_setups(const GameConfig &config, uint64_t seed, uint64_t first, int count)
+{
+    std::vector<GameSetup> setups;
+    setups.reserve(count);
+    for (int g = 0; g < count; ++g)
+    {
+        std::vector<int> deck = seeded_deck(config.card_max_number, seed, first + g);
+        std::mt19937_64 order_rng = seat_order_rng(seed, first + g);
+        setups.push_back(setup_game(config, config.number_of_players, deck, order_rng));
+    }
+    return setups;
+}
+
+// Self-play: every seat of every deal uses the candidate, all deals in lockstep batches
+double evaluate_candidate(const GameConfig &config, const std::vector<GameSetup> &setups, const PolicyWeights &weights, const StrategyParams &params, bool on_cards)
+{
+    PolicyDecider decider(config, weights);
+    std::vector<LockstepOutcome> outcomes;
+    play_lockstep(config, setups, decider, params, outcomes);
+    double sum = 0.0;
+    for (const auto &outcome : outcomes)
+    {
+        sum += on_cards ? outcome.turns : outcome.won;
+    }
+    return setups.empty() ? 0.0 : sum / setups.size();
+}
+
+void print_weights(const PolicyWeights &weights)
+{
+    for (int f = 0; f < POLICY_FEATURES; ++f)
+    {
+        std::cout << (f ? ", " : "") << policy_feature_name(f) << "=" << std::setprecision(3) << weights.weights[f];
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+/**
+ * @brief Trains the weights of the linear policy (strategy L) by self-play with the cross-entropy method.
+ *
+ * Each iteration samples CEM_POPULATION weight vectors from a diagonal
+ * Gaussian (the mean itself is one of them), plays the same fresh deals with
+ * each of them at every seat through the lockstep engine, and refits the
+ * Gaussian to the CEM_ELITES best. The search starts from zero weights,
+ * i.e. from no knowledge of the game. The final mean is written to the
+ * weights file, then played on held-out deals next to the built-in
+ * strategies, and the batched scoring is timed against one decision at a
+ * time.
+ *
+ * @param config The game config.
+ * @param strategies The built-in strategies to compare with.
+ * @param options The training settings.
+ * @return 0 on success, 1 on error.
+ */
+int run_policy_training(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const PolicyTrainingOptions &options)
+{
+    StrategyParams params = default_strategy_params(config);
+    std::mt19937_64 rng(options.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    double mean[POLICY_FEATURES] = {};
+    double sigma[POLICY_FEATURES];
+    std::fill(sigma, sigma + POLICY_FEATURES, 1.0);
+    const char *metric = options.train_on_cards ? "mean cards played" : "win rate";
+
+    std::cout << "\n--- Training the linear policy by self-play (cross-entropy method, " << CEM_POPULATION << " candidates x "
+              << options.games_per_candidate << " deals per iteration, " << metric << ") ---\n";
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < CEM_ITERATIONS; ++iteration)
+    {
+        std::vector<GameSetup> setups = seeded_setups(config, options.seed, static_cast<uint64_t>(iteration) * options.games_per_candidate, options.games_per_candidate);
+        std::vector<PolicyWeights> candidates(CEM_POPULATION);
+        for (int c = 0; c < CEM_POPULATION; ++c)
+        {
+            for (int f = 0; f < POLICY_FEATURES; ++f)
+            {
+                candidates[c].weights[f] = c == 0 ? mean[f] : mean[f] + sigma[f] * normal(rng);
+            }
+        }
+
+        std::vector<double> scores(CEM_POPULATION);
+        parallel_for_chunks(CEM_POPULATION, options.num_threads, [&](int begin, int end, int) {
+            for (int c = begin; c < end; ++c)
+            {
+                scores[c] = evaluate_candidate(config, setups, candidates[c], params, options.train_on_cards);
+            }
+        });
+
+        std::vector<int> order(CEM_POPULATION);
+        for (int c = 0; c < CEM_POPULATION; ++c)
+        {
+            order[c] = c;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+        double elite_score = 0.0;
+        for (int f = 0; f < POLICY_FEATURES; ++f)
+        {
+            double elite_mean = 0.0, elite_square = 0.0;
+            for (int e = 0; e < CEM_ELITES; ++e)
+            {
+                double w = candidates[order[e]].weights[f];
+                elite_mean += w / CEM_ELITES;
+                elite_square += w * w / CEM_ELITES;
+            }
+            double elite_sigma = std::sqrt(std::max(0.0, elite_square - elite_mean * elite_mean));
+            mean[f] = CEM_SMOOTHING * elite_mean + (1.0 - CEM_SMOOTHING) * mean[f];
+            sigma[f] = std::max(CEM_MIN_SIGMA, CEM_SMOOTHING * elite_sigma + (1.0 - CEM_SMOOTHING) * sigma[f]);
+        }
+        for (int e = 0; e < CEM_ELITES; ++e)
+        {
+            elite_score += scores[order[e]] / CEM_ELITES;
+        }
+        std::cout << "Iteration " << std::setw(2) << iteration + 1 << ": mean " << std::fixed << std::setprecision(options.train_on_cards ? 2 : 4)
+                  << scores[0] << ", best " << scores[order[0]] << ", elites " << elite_score << "\n";
+    }
+
+    PolicyWeights trained;
+    for (int f = 0; f < POLICY_FEATURES; ++f)
+    {
+        trained.weights[f] = mean[f];
+    }
+    std::string error;
+    if (!save_policy_weights(options.filename, trained, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Weights (written to " << options.filename << " after " << std::setprecision(1) << seconds << " s): ";
+    print_weights(trained);
+
+    // Held-out deals: the trained policy (strategy L) next to the built-in strategies, reference engine
+    set_strategy_policy(trained);
+    std::vector<GameSetup> held_out = seeded_setups(config, options.seed, HELD_OUT_DEALS, options.games_per_candidate);
+    std::vector<std::pair<double, std::string>> results;
+    for (const auto &[name, strategy] : strategies)
+    {
+        std::vector<StrategyFunction> seats(config.number_of_players, strategy);
+        std::vector<std::vector<int>> final_rows, final_hands;
+        double sum = 0.0;
+        for (const auto &setup : held_out)
+        {
+            int turns = 0;
+            bool won = simulate_game_multiplayer(config, seats, setup, params, turns, final_rows, final_hands);
+            sum += options.train_on_cards ? turns : won;
+        }
+        results.push_back({sum / held_out.size(), name});
+    }
+    std::stable_sort(results.begin(), results.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    std::cout << "Held-out deals (" << held_out.size() << ", " << metric << "):";
+    for (const auto &[score, name] : results)
+    {
+        std::cout << " " << name << " " << std::setprecision(options.train_on_cards ? 2 : 4) << score;
+    }
+    std::cout << "\n";
+
+    // Inference speed on the held-out deals: one batched pass per lockstep step against one decision at a time
+    std::vector<LockstepOutcome> outcomes;
+    PolicyDecider batched(config, trained);
+    FunctionDecider single(config, get_player_move_L);
+    auto timed = [&](BatchDecider &decider) {
+        auto begin = std::chrono::steady_clock::now();
+        play_lockstep(config, held_out, decider, params, outcomes);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    };
+    double single_seconds = timed(single);
+    double batched_seconds = timed(batched);
+    std::cout << "Lockstep games per second: " << std::setprecision(0) << held_out.size() / batched_seconds << " batched, "
+              << held_out.size() / single_seconds << " one decision at a time\n";
+    return 0;
+}
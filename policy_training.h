@@ -0,0 +1,23 @@
+#ifndef POLICY_TRAINING_H
+#define POLICY_TRAINING_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+// Settings of the `train-policy` mode.
+struct PolicyTrainingOptions
+{
+    int games_per_candidate; // Deals every candidate plays per iteration (the same deals for all)
+    uint64_t seed;           // Seed of the deals and of the search
+    int num_threads;         // Worker threads, one candidate at a time each
+    bool train_on_cards;     // Mean cards played instead of wins (useful when win rates are ~0)
+    std::string filename;    // Weights file written at the end
+};
+
+int run_policy_training(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const PolicyTrainingOptions &options);
+
+#endif
@@ -0,0 +1,218 @@
+#include "progress_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const double CI_Z = 1.96;                           // 95% confidence intervals
+const std::chrono::milliseconds WAKE_PERIOD{250}; // How often the reporter looks at the counters
+
+// Wilson score interval of a win rate, in percent
+void wilson_interval(long long wins, long long games, double &low, double &high)
+{
+    if (games == 0)
+    {
+        low = 0.0;
+        high = 100.0;
+        return;
+    }
+    double n = games;
+    double p = wins / n;
+    double z2 = CI_Z * CI_Z;
+    double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double half_width = CI_Z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+    low = std::max(0.0, centre - half_width) * 100;
+    high = std::min(1.0, centre + half_width) * 100;
+}
+
+} // namespace
+
+/**
+ * @brief Counts one deck played by every strategy. Called by the owning worker only.
+ *
+ * @param outcomes One outcome per strategy.
+ */
+void WorkerCounters::add_deck(const std::vector<StrategyOutcome> &outcomes)
+{
+    for (size_t s = 0; s < outcomes.size(); ++s)
+    {
+        if (outcomes[s].won)
+        {
+            wins[s].store(wins[s].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+    decks.store(decks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Creates the counters of every worker and starts the reporter thread.
+ *
+ * @param strategy_names The strategies of the run.
+ * @param num_players The number of players (metrics label).
+ * @param num_workers The number of simulation workers.
+ * @param total_decks The number of decks of the run (for the ETA).
+ * @param options What to report and how often.
+ */
+ProgressReporter::ProgressReporter(const std::vector<std::string> &strategy_names, int num_players, int num_workers, long long total_decks, const ProgressOptions &options)
+    : strategy_names_(strategy_names), num_players_(num_players), total_decks_(total_decks), options_(options),
+      workers_(num_workers), start_(std::chrono::steady_clock::now())
+{
+    for (auto &counters : workers_)
+    {
+        counters.wins.reset(new std::atomic<long long>[strategy_names.size()]);
+        for (size_t s = 0; s < strategy_names.size(); ++s)
+        {
+            counters.wins[s].store(0, std::memory_order_relaxed);
+        }
+    }
+    if (options_.progress_interval > 0 || !options_.metrics_filename.empty())
+    {
+        thread_ = std::thread(&ProgressReporter::reporter_loop, this);
+    }
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    stop();
+}
+
+/**
+ * @brief Returns the counters of worker w.
+ */
+WorkerCounters &ProgressReporter::worker(int w)
+{
+    return workers_[w];
+}
+
+/**
+ * @brief Stops the reporter thread after a last metrics export.
+ */
+void ProgressReporter::stop()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+ProgressReporter::Totals ProgressReporter::collect() const
+{
+    Totals totals;
+    totals.wins.assign(strategy_names_.size(), 0);
+    for (const auto &counters : workers_)
+    {
+        totals.decks += counters.decks.load(std::memory_order_relaxed);
+        for (size_t s = 0; s < strategy_names_.size(); ++s)
+        {
+            totals.wins[s] += counters.wins[s].load(std::memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+void ProgressReporter::reporter_loop()
+{
+    double next_progress = options_.progress_interval;
+    double next_metrics = 0.0; // The metrics file exists from the start of the run
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        bool stopping = wake_.wait_for(lock, WAKE_PERIOD, [this] { return stopping_; });
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        if (stopping)
+        {
+            if (!options_.metrics_filename.empty())
+            {
+                write_metrics(collect(), elapsed, true);
+            }
+            return;
+        }
+        if (options_.progress_interval > 0 && elapsed >= next_progress)
+        {
+            print_progress(collect(), elapsed);
+            next_progress = elapsed + options_.progress_interval;
+        }
+        if (!options_.metrics_filename.empty() && elapsed >= next_metrics)
+        {
+            write_metrics(collect(), elapsed, false);
+            next_metrics = elapsed + options_.metrics_interval;
+        }
+    }
+}
+
+void ProgressReporter::print_progress(const Totals &totals, double elapsed) const
+{
+    double decks_per_second = elapsed > 0 ? totals.decks / elapsed : 0.0;
+    double games_per_second = decks_per_second * strategy_names_.size();
+    double eta = decks_per_second > 0 ? (total_decks_ - totals.decks) / decks_per_second : 0.0;
+
+    std::ostringstream line; // One write per line, so it does not mix with other output
+    line << std::fixed << std::setprecision(1);
+    line << "Progress: " << totals.decks << "/" << total_decks_ << " decks ("
+         << (total_decks_ > 0 ? 100.0 * totals.decks / total_decks_ : 0.0) << " %), "
+         << std::setprecision(0) << games_per_second << " games/s, ETA " << eta << " s\n";
+    line << std::setprecision(2);
+    for (size_t s = 0; s < strategy_names_.size(); ++s)
+    {
+        double low, high;
+        wilson_interval(totals.wins[s], totals.decks, low, high);
+        line << "  " << strategy_names_[s] << " " << (totals.decks > 0 ? 100.0 * totals.wins[s] / totals.decks : 0.0)
+             << " % [" << low << " - " << high << "]" << ((s + 1) % 4 == 0 || s + 1 == strategy_names_.size() ? "\n" : "");
+    }
+    std::cerr << line.str();
+}
+
+/**
+ * @brief Writes the Prometheus text exposition of the run to a temporary file and renames it over the metrics file.
+ *
+ * A scraper reading the metrics file always sees a complete export.
+ */
+void ProgressReporter::write_metrics(const Totals &totals, double elapsed, bool finished) const
+{
+    std::string players = "players=\"" + std::to_string(num_players_) + "\"";
+    double decks_per_second = elapsed > 0 ? totals.decks / elapsed : 0.0;
+
+    std::ostringstream out;
+    out << "# HELP thegame_decks_target Decks the run will play.\n# TYPE thegame_decks_target gauge\n";
+    out << "thegame_decks_target{" << players << "} " << total_decks_ << "\n";
+    out << "# HELP thegame_decks_completed_total Decks played by every strategy so far.\n# TYPE thegame_decks_completed_total counter\n";
+    out << "thegame_decks_completed_total{" << players << "} " << totals.decks << "\n";
+    out << "# HELP thegame_wins_total Games won so far, per strategy.\n# TYPE thegame_wins_total counter\n";
+    for (size_t s = 0; s < strategy_names_.size(); ++s)
+    {
+        out << "thegame_wins_total{" << players << ",strategy=\"" << strategy_names_[s] << "\"} " << totals.wins[s] << "\n";
+    }
+    out << "# HELP thegame_games_per_second Games simulated per second since the start of the run.\n# TYPE thegame_games_per_second gauge\n";
+    out << "thegame_games_per_second{" << players << "} " << decks_per_second * strategy_names_.size() << "\n";
+    out << "# HELP thegame_eta_seconds Estimated time until the end of the run.\n# TYPE thegame_eta_seconds gauge\n";
+    out << "thegame_eta_seconds{" << players << "} " << (decks_per_second > 0 ? (total_decks_ - totals.decks) / decks_per_second : 0.0) << "\n";
+    out << "# HELP thegame_run_finished 1 once the run is over.\n# TYPE thegame_run_finished gauge\n";
+    out << "thegame_run_finished{" << players << "} " << (finished ? 1 : 0) << "\n";
+
+    std::string temporary = options_.metrics_filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << out.str();
+        if (!file)
+        {
+            std::cerr << "Warning: cannot write " << temporary << "\n";
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), options_.metrics_filename.c_str()) != 0)
+    {
+        std::cerr << "Warning: cannot rename " << temporary << " to " << options_.metrics_filename << "\n";
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PROGRESS_METRICS_H
+#define PROGRESS_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "win_summary.h"
+
+/**
+ * @brief Counters of one simulation worker.
+ *
+ * Only the owning worker writes them (plain relaxed load + store, no locked
+ * instruction) and only the reporter thread reads them, so counting costs a
+ * few stores per deck. Each worker's block starts on its own cache line.
+ */
+struct alignas(64) WorkerCounters
+{
+    std::atomic<long long> decks{0};
+    std::unique_ptr<std::atomic<long long>[]> wins; // Per strategy
+
+    void add_deck(const std::vector<StrategyOutcome> &outcomes);
+};
+
+// What the reporter prints and exports, and how often
+struct ProgressOptions
+{
+    double progress_interval = 2.0; // Seconds between two progress lines on stderr, 0 = none
+    std::string metrics_filename;   // Prometheus text file, none if empty
+    double metrics_interval = 5.0;  // Seconds between two rewrites of the metrics file
+};
+
+/**
+ * @brief Reports the progress of a run from a background thread.
+ *
+ * The thread wakes up a few times per second, sums the worker counters and,
+ * when due, prints a progress line (games/s, ETA, win rate of every strategy
+ * with a 95% CI) to stderr and rewrites the metrics file atomically (write to
+ * a temporary file, then rename).
+ */
+class ProgressReporter
+{
+public:
+    ProgressReporter(const std::vector<std::string> &strategy_names, int num_players, int num_workers, long long total_decks, const ProgressOptions &options);
+    ~ProgressReporter();
+    ProgressReporter(const ProgressReporter &) = delete;
+    ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+    WorkerCounters &worker(int w);
+    void stop();
+
+private:
+    struct Totals
+    {
+        long long decks = 0;
+        std::vector<long long> wins;
+    };
+
+    void reporter_loop();
+    Totals collect() const;
+    void print_progress(const Totals &totals, double elapsed) const;
+    void write_metrics(const Totals &totals, double elapsed, bool finished) const;
+
+    std::vector<std::string> strategy_names_;
+    int num_players_;
+    long long total_decks_;
+    ProgressOptions options_;
+    std::vector<WorkerCounters> workers_;
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+#endif
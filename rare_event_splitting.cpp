@@ -0,0 +1,272 @@
+#include "rare_event_splitting.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int SPLITTING_REPLICATES = 20;     // Independent runs of the estimator (confidence interval)
+const double LEVEL_SURVIVAL = 0.3;      // Wanted share of the games of a level that reach the next one
+const int TAIL_LEVEL_STEP = 4;          // Cards between levels beyond the longest pilot game
+const double CI_Z = 1.96;
+
+// Result of one run of the splitting estimator
+struct SplittingRun
+{
+    double estimate = 1.0;
+    std::vector<double> level_fractions; // Share of the games of each stage that reached its level
+    long long cards = 0;                 // Cards played by all the games of the run (cost)
+};
+
+/**
+ * @brief Plays a game until it has played level cards or is lost.
+ *
+ * @return True if the level was reached (a won game reaches every level).
+ */
+bool play_to_level(const GameConfig &config, TrackedGame &tracked, int level, StrategyFunction strategy, const StrategyParams &params, long long &cards)
+{
+    while (!tracked.game.finished && tracked.game.turns < level)
+    {
+        apply_snapshot_move(config, tracked.game, decide_snapshot_move(config, tracked.game, strategy, params, &tracked.cards, tracked.plan), &tracked.cards);
+        cards++;
+    }
+    return tracked.game.turns >= level;
+}
+
+// Deals deck number game of a seed, with its seat order (as the simulate mode deals it)
+void deal_tracked(const GameConfig &config, uint64_t seed, int64_t game, TrackedGame &tracked)
+{
+    std::mt19937_64 order_rng = seat_order_rng(seed, game);
+    tracked.start(config, setup_game(config, config.number_of_players, seeded_deck(config.card_max_number, seed, game), order_rng));
+}
+
+/**
+ * @brief Picks the levels (cards played) from the cards played in pilot games.
+ *
+ * Each level is the first number of cards that at most LEVEL_SURVIVAL of the
+ * games of the previous level reach. Beyond the longest pilot game the levels
+ * are TAIL_LEVEL_STEP cards apart. The last level is the win: every card played.
+ */
+std::vector<int> choose_levels(const std::vector<int> &pilot_cards, int total_cards)
+{
+    std::vector<int> reached(total_cards + 2, 0); // reached[x] = pilot games with at least x cards played
+    for (int cards : pilot_cards)
+    {
+        reached[std::min(cards, total_cards)]++;
+    }
+    for (int x = total_cards - 1; x >= 0; --x)
+    {
+        reached[x] += reached[x + 1];
+    }
+
+    std::vector<int> levels;
+    int previous = reached[0];
+    int last = 0;
+    for (int x = 1; x < total_cards; ++x)
+    {
+        if (reached[x] == 0)
+        {
+            break;
+        }
+        if (reached[x] <= previous * LEVEL_SURVIVAL)
+        {
+            levels.push_back(x);
+            previous = reached[x];
+            last = x;
+        }
+    }
+    for (int x = last + TAIL_LEVEL_STEP; x < total_cards; x += TAIL_LEVEL_STEP)
+    {
+        levels.push_back(x);
+    }
+    levels.push_back(total_cards);
+    return levels;
+}
+
+/**
+ * @brief One run of fixed-effort multilevel splitting.
+ *
+ * Stage 0 deals num_particles games and plays them to the first level. Every
+ * later stage draws num_particles games, uniformly with replacement, from the
+ * games that reached the previous level, reshuffles the draw pile of each copy
+ * and plays it to the next level. Nobody has seen the order of the draw pile,
+ * so given everything that happened, every order of it is equally likely and
+ * a reshuffled copy is a fresh sample of how the game goes on (the card
+ * tracker and the turn plan, copied with the game, do not depend on it). The product
+ * of the stage fractions is an unbiased estimate of the win probability.
+ */
+SplittingRun run_splitting(const GameConfig &config, const std::vector<int> &levels, StrategyFunction strategy, const StrategyParams &params, int num_particles, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<TrackedGame> particles(num_particles), survivors;
+    survivors.reserve(num_particles);
+    SplittingRun run;
+
+    for (int p = 0; p < num_particles; ++p)
+    {
+        deal_tracked(config, seed, p, particles[p]);
+    }
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        survivors.clear();
+        for (auto &tracked : particles)
+        {
+            if (play_to_level(config, tracked, levels[level], strategy, params, run.cards))
+            {
+                survivors.push_back(tracked);
+            }
+        }
+        double fraction = static_cast<double>(survivors.size()) / num_particles;
+        run.level_fractions.push_back(fraction);
+        run.estimate *= fraction;
+        if (survivors.empty())
+        {
+            run.level_fractions.resize(levels.size(), 0.0);
+            break;
+        }
+        if (level + 1 == levels.size())
+        {
+            break;
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, survivors.size() - 1);
+        for (auto &tracked : particles)
+        {
+            tracked = survivors[pick(rng)];
+            std::shuffle(tracked.game.deck, tracked.game.deck + tracked.game.deck_size, rng);
+        }
+    }
+    return run;
+}
+
+} // namespace
+
+/**
+ * @brief Estimates a very small win probability with multilevel splitting and compares it to plain sampling.
+ *
+ * Progress is measured in cards played, i.e. cards no longer in the draw pile
+ * or in a hand. Games are played with the card tracker and whole-turn plans,
+ * as the engine plays them. Pilot games (plain Monte Carlo) set the levels and the cost of
+ * a plain game. SPLITTING_REPLICATES independent splitting runs, in parallel,
+ * give the estimate and its 95% confidence interval. The speed-up is the
+ * plain-sampling cost for the same variance divided by the splitting cost,
+ * both counted in cards played.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param strategy_name The strategy played at every seat.
+ * @param num_particles Games per stage of a run (and pilot games).
+ * @param seed The seed of the pilot deals and of every splitting run.
+ * @param num_threads The number of worker threads.
+ */
+void run_splitting_estimate(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &strategy_name, int num_particles, uint64_t seed, int num_threads)
+{
+    auto strategy_it = strategies.find(strategy_name);
+    if (strategy_it == strategies.end())
+    {
+        std::cerr << "Error: Unknown strategy '" << strategy_name << "'\n";
+        return;
+    }
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return;
+    }
+    if (num_particles < 2)
+    {
+        std::cerr << "Error: Splitting needs at least 2 games per stage (NUM_SIMULATIONS)\n";
+        return;
+    }
+    StrategyFunction strategy = strategy_it->second;
+    StrategyParams params = default_strategy_params(config);
+    int total_cards = config.card_max_number - 2;
+    auto start = std::chrono::steady_clock::now();
+
+    // --- Pilot: plain games, for the levels and the cost of a plain game ---
+    std::vector<int> pilot_cards(num_particles);
+    std::vector<char> pilot_won(num_particles);
+    parallel_for_chunks(num_particles, num_threads, [&](int begin, int end, int) {
+        TrackedGame tracked;
+        for (int g = begin; g < end; ++g)
+        {
+            deal_tracked(config, seed, g, tracked);
+            play_tracked_to_end(config, tracked, strategy, params);
+            pilot_cards[g] = tracked.game.turns;
+            pilot_won[g] = tracked.game.won;
+        }
+    });
+    double plain_cost = 0.0;
+    int pilot_wins = 0;
+    for (int g = 0; g < num_particles; ++g)
+    {
+        plain_cost += pilot_cards[g];
+        pilot_wins += pilot_won[g];
+    }
+    plain_cost /= num_particles;
+    std::vector<int> levels = choose_levels(pilot_cards, total_cards);
+
+    // --- Independent splitting runs ---
+    std::vector<SplittingRun> runs(SPLITTING_REPLICATES);
+    parallel_for_chunks(SPLITTING_REPLICATES, num_threads, [&](int begin, int end, int) {
+        for (int r = begin; r < end; ++r)
+        {
+            runs[r] = run_splitting(config, levels, strategy, params, num_particles, seed ^ (0x9e3779b97f4a7c15ULL * (r + 1)));
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double mean = 0.0, run_cost = 0.0;
+    for (const auto &run : runs)
+    {
+        mean += run.estimate;
+        run_cost += run.cards;
+    }
+    mean /= SPLITTING_REPLICATES;
+    run_cost /= SPLITTING_REPLICATES;
+    double variance = 0.0;
+    for (const auto &run : runs)
+    {
+        variance += (run.estimate - mean) * (run.estimate - mean);
+    }
+    variance /= SPLITTING_REPLICATES - 1;
+    double half_width = CI_Z * std::sqrt(variance / SPLITTING_REPLICATES);
+
+    std::cout << "Multilevel splitting, " << strategy_name << ", " << config.number_of_players << " Players: "
+              << levels.size() << " levels, " << num_particles << " games per stage, " << SPLITTING_REPLICATES << " runs, seed " << seed << "\n";
+    std::cout << "Levels (cards played) and share of games reaching them:\n";
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        double fraction = 0.0;
+        for (const auto &run : runs)
+        {
+            fraction += run.level_fractions[level];
+        }
+        std::cout << "  " << levels[level] << ": " << fraction / SPLITTING_REPLICATES << "\n";
+    }
+    std::cout << "Pilot (plain sampling): " << pilot_wins << " wins in " << num_particles << " games, "
+              << plain_cost << " cards per game\n";
+    std::cout << "Win probability: " << mean * 100 << " % (95% CI " << std::max(0.0, mean - half_width) * 100
+              << " - " << (mean + half_width) * 100 << " %)\n";
+    if (mean <= 0.0 || variance <= 0.0)
+    {
+        std::cout << "No run reached a win" << (mean > 0.0 ? " in a different way" : "")
+                  << ": no speed-up can be measured, try more games per stage\n";
+    }
+    else
+    {
+        // Plain sampling needs p(1-p)/V games for the variance V of one run
+        double plain_games = mean * (1.0 - mean) / variance;
+        double speed_up = plain_games * plain_cost / run_cost;
+        std::cout << "Cards per run: " << run_cost << ", plain sampling needs " << plain_games << " games ("
+                  << plain_games * plain_cost << " cards) for the same variance: speed-up x" << speed_up << "\n";
+    }
+    std::cout << "Time: " << seconds << " s\n";
+}
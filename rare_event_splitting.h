@@ -0,0 +1,13 @@
+#ifndef RARE_EVENT_SPLITTING_H
+#define RARE_EVENT_SPLITTING_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+void run_splitting_estimate(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &strategy_name, int num_particles, uint64_t seed, int num_threads);
+
+#endif
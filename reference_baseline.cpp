@@ -0,0 +1,853 @@
+#include "reference_engine.h"
+
+#include <algorithm> // std::remove, std::find
+#include <cmath>
+#include <limits>
+#include <numeric> // std::iota
+
+// Verbatim copy of the first version of the engine and of the strategies it
+// had (A1, A2, E1, E2, H1, H2), the fixed point the optimised code is checked
+// against. The code is kept as it was, warnings included; do not optimise,
+// tidy or fix it. The only changes, each marked "Reference:", are the ones a
+// differential check needs: the config globals are thread-local and set for
+// each game, the seat order is given instead of shuffled, the trace output is
+// gone, and every card played and the draw pile left are reported.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+
+namespace reference {
+
+// Reference: the globals of main.cpp, one set per thread
+thread_local int CARD_MAX_NUMBER;   // Maximum card value
+thread_local int REVERSE_MOVE_DIFF; // Difference for a reverse-10 move
+thread_local int CARD_IN_HANDS;     // Number of cards each player holds
+thread_local int NUM_CARDS_TO_PLAY; // Number of cards to play per turn
+thread_local int NUMBER_OF_ROWS;    // Number of playing rows
+thread_local int GOOD_MOVE_WINDOW;  // Internal for good moves
+
+// --- helper_functions.h / helper_functions.cpp ---
+
+enum class ValidMove {
+    EXCELLENT,
+    YES,
+    REVERSE_MOVE,
+    NO
+};
+
+/**
+ * @brief Deals a specified number of cards from the deck to a player's hand.
+ *
+ * Cards are taken from the back of the deck (LIFO) and added to the hand.
+ * If the deck has fewer than num_cards, all remaining cards are dealt.
+ *
+ * @param deck The deck of cards to deal from. Passed by reference to modify the original.
+ * @param num_cards The number of cards to deal.
+ * @return A vector representing the player's hand after dealing.
+ */
+std::vector<int> deal_cards(std::vector<int> &deck, int num_cards)
+{
+    std::vector<int> hand;
+    // Deal cards from the back of the deck until num_cards is reached or the deck is empty
+    for (int i = 0; i < num_cards && !deck.empty(); ++i)
+    {
+        hand.push_back(deck.back()); // Add the card to the hand
+        deck.pop_back();             // Remove the card from the deck
+    }
+    return hand;
+}
+
+/**
+ * @brief Checks if a move is valid according to the game rules.
+ *
+ * A move is valid if:
+ * - For ascending rows: the card is greater than the top card of the row,
+ * OR the card is equal to the top card minus REVERSE_MOVE_DIFF (reverse move, if allowed).
+ * - For descending rows: the card is less than the top card of the row,
+ * OR the card is equal to the top card plus REVERSE_MOVE_DIFF (reverse move, if allowed).
+ *
+ * @param card The card being played.
+ * @param row_top The value of the top card in the row.
+ * @param is_ascending True if the row is ascending, false if descending.
+ * @param reverse_move_allowed True if reverse moves are allowed, false otherwise.
+ * @return ValidMove enum indicating if the move is valid, invalid, or a reverse move.
+ */
+ValidMove is_valid_move(int card, int row_top, bool is_ascending, bool reverse_move_allowed = true)
+{
+    if (is_ascending)
+    {
+        // Ascending row logic
+        if (card == row_top - REVERSE_MOVE_DIFF && reverse_move_allowed)
+        {
+            return ValidMove::REVERSE_MOVE; // Reverse move is valid
+        }
+        else if (card > row_top && card - row_top < GOOD_MOVE_WINDOW)
+        {
+            return ValidMove::EXCELLENT; // Card is greater than the top card but less than GOOD_MOVE_WINDOW
+        }
+        else if (card > row_top)
+        {
+            return ValidMove::YES; // Card is greater than the top card
+        }
+        else
+        {
+            return ValidMove::NO; // Card is not valid
+        }
+    }
+    else
+    {
+        // Descending row logic
+        if (card == row_top + REVERSE_MOVE_DIFF && reverse_move_allowed)
+        {
+            return ValidMove::REVERSE_MOVE; // Reverse move is valid
+        }
+        else if (card < row_top && row_top - card < GOOD_MOVE_WINDOW)
+        {
+            return ValidMove::EXCELLENT; // Card is less than the top card but less than GOOD_MOVE_WINDOW
+        }
+        else if (card < row_top)
+        {
+            return ValidMove::YES; // Card is less than the top card
+        }
+        else
+        {
+            return ValidMove::NO; // Card is not valid
+        }
+    }
+}
+
+/**
+ * @brief Makes a move by adding a card to the specified row.
+ *
+ * The card is added to the back of the vector representing the row.
+ *
+ * @param card The card to be added to the row.
+ * @param row_index The index of the row to add the card to.
+ * @param playing_rows A 2D vector representing the playing rows. Passed by reference to modify the original.
+ */
+void make_move(int card, int row_index, std::vector<std::vector<int>> &playing_rows)
+{
+    playing_rows[row_index].push_back(card); // Add the card to the specified row
+}
+
+// --- player_strategies.h / player_strategies.cpp ---
+
+struct Communication {
+    int player_id;
+    int row_index;
+    enum CommType {
+        GOOD_CARD,
+        REVERSE_TRICK
+    } type;
+    int relative_value; // -3 = very good, -2 = good, -1 = slightly good,
+                        //  0 = neutral,
+                        // +1 = slightly bad, +2 = bad, +3 = very bad
+};
+
+std::vector<int> get_claimed_rows(const std::vector<Communication> &communications, int player_id)
+{
+    std::vector<int> claimed_rows;
+    for (const auto &comm : communications)
+    {
+        if (comm.player_id != player_id)
+        {                                           // Don't react to your own communication
+            claimed_rows.push_back(comm.row_index); // GOOD MOVE or REVERSE MOVE from another player
+        }
+    }
+    return claimed_rows;
+}
+
+/**
+ * @brief Strategy A: Plays the card closest in value to the top card of a row. Communication among players.
+ *
+ * This strategy considers both ascending and descending rows and allows reverse moves.
+ * It chooses the card that minimizes the absolute difference with the row's top card.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_A1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+    int best_card_index = -1; // Store the *index* of the best card
+    int best_card = -1;
+    int best_row = -1;
+    int min_diff = std::numeric_limits<int>::max(); // Use numeric_limits for max value
+
+    // --- Observation Phase ---
+    std::vector<int> claimed_rows = get_claimed_rows(communications, player_id);
+
+    // --- Decision-Making Phase (with Communication) ---
+    for (int i = 0; i < hand.size(); ++i)
+    {
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            ValidMove valid_move = is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2);
+            if (valid_move != ValidMove::NO)
+            {
+                int diff = (valid_move == ValidMove::REVERSE_MOVE) ? -1 : std::abs(hand[i] - playing_rows[j].back());
+
+                // Check if the row is claimed.  If it is, and our move is "bad", increase the diff
+                // to make it less likely to be chosen.
+                bool row_is_claimed = std::find(claimed_rows.begin(), claimed_rows.end(), j) != claimed_rows.end();
+                if (row_is_claimed && diff > GOOD_MOVE_WINDOW)
+                { // Consider it a less good move if diff > GOOD_MOVE_WINDOW
+                    diff = diff * 100;
+                }
+
+                if (diff < min_diff)
+                {
+                    min_diff = diff;
+                    best_card = hand[i];
+                    best_card_index = i;
+                    best_row = j;
+                }
+            }
+        }
+    }
+
+    return {best_card_index, best_row};
+}
+
+/**
+ * @brief Strategy A2: Plays the card closest in value to the top card of a row. NO COMMUNICATION among players.
+ *
+ * This strategy considers both ascending and descending rows and allows reverse moves.
+ * It chooses the card that minimizes the absolute difference with the row's top card.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_A2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+    int best_card_index = -1; // Store the *index* of the best card
+    int best_card = -1;
+    int best_row = -1;
+    int min_diff = std::numeric_limits<int>::max(); // Use numeric_limits for max value
+
+    // --- Decision-Making Phase (with Communication) ---
+    for (int i = 0; i < hand.size(); ++i)
+    {
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            ValidMove valid_move = is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2);
+            if (valid_move != ValidMove::NO)
+            {
+                int diff = (valid_move == ValidMove::REVERSE_MOVE) ? -1 : std::abs(hand[i] - playing_rows[j].back());
+                if (diff < min_diff)
+                {
+                    min_diff = diff;
+                    best_card = hand[i];
+                    best_card_index = i;
+                    best_row = j;
+                }
+            }
+        }
+    }
+
+    return {best_card_index, best_row};
+}
+
+
+/**
+ * @brief Strategy E: Combination of Strategy C and Strategy A.
+ *
+ * This strategy considers future playability (like Strategy C) but uses
+ * the closest card (like Strategy A) as a tie-breaker.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_E1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+    int best_card_index = -1;
+    int best_card = -1;                 // Initialize the best card to -1 (no card selected yet)
+    int best_row = -1;                  // Initialize the best row to -1 (no row selected yet)
+    int max_playable_after = -1;        // Initialize the maximum playable cards after to -1
+    int min_diff = CARD_MAX_NUMBER * 2; // Initialize the minimum difference to a large value
+
+    // --- Observation Phase ---
+    std::vector<int> claimed_rows = get_claimed_rows(communications, player_id);
+
+    // Iterate through each card in the player's hand
+    for (int i = 0; i < hand.size(); ++i)
+    {
+        // Iterate through each row in the playing area
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            // Check if the current card can be played on the current row
+            if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            {
+                // Simulate the move (create copies of playing rows)
+                std::vector<std::vector<int>> temp_rows = playing_rows;
+                temp_rows[j].push_back(hand[i]);
+
+                int playable_after = 0; // Initialize the count of playable cards after the move
+                // Iterate through the remaining cards in the hand
+                for (int k = 0; k < hand.size(); ++k)
+                {
+                    // Skip the card that was just "played"
+                    if (static_cast<unsigned long long>(i) != k)
+                    {
+                        // Iterate through each row to check playability
+                        for (int l = 0; l < NUMBER_OF_ROWS; ++l)
+                        {
+                            // If the remaining card is playable on any row
+                            if (is_valid_move(hand[k], temp_rows[l].back(), l < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                            {
+                                // Increment the count of playable cards and break the inner loop
+                                playable_after++;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                // Calculate the difference between the card and the row's top card
+                int diff = std::abs(hand[i] - playing_rows[j].back());
+
+                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) == ValidMove::REVERSE_MOVE)
+                    diff = -1;
+
+                // Check if the row is claimed.  If it is, and our move is "bad", increase the diff
+                // to make it less likely to be chosen.
+                bool row_is_claimed = std::find(claimed_rows.begin(), claimed_rows.end(), j) != claimed_rows.end();
+                if (row_is_claimed && diff > GOOD_MOVE_WINDOW)
+                { // Consider it a less good move if diff > GOOD_MOVE_WINDOW
+                    diff = diff * 100;
+                }
+
+                // Tie-breaker logic: If playable_after is the same, choose the smaller diff
+                if (playable_after > max_playable_after)
+                {
+                    // Update the maximum playable cards, best card, best row, and minimum difference
+                    max_playable_after = playable_after;
+                    min_diff = diff;
+                    best_card = hand[i];
+                    best_card_index = i;
+                    best_row = j;
+                }
+                else if (playable_after == max_playable_after && diff < min_diff)
+                {
+                    // Update the minimum difference, best card, and best row
+                    min_diff = diff;
+                    best_card = hand[i];
+                    best_card_index = i;
+                    best_row = j;
+                }
+            }
+        }
+    }
+    // Return the best card and row as a pair
+    return {best_card_index, best_row};
+}
+
+/**
+ * @brief Strategy E: Combination of Strategy C and Strategy A.
+ *
+ * This strategy considers future playability (like Strategy C) but uses
+ * the closest card (like Strategy A) as a tie-breaker.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_E2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+    int best_card_index = -1;
+    int best_card = -1;                 // Initialize the best card to -1 (no card selected yet)
+    int best_row = -1;                  // Initialize the best row to -1 (no row selected yet)
+    int max_playable_after = -1;        // Initialize the maximum playable cards after to -1
+    int min_diff = CARD_MAX_NUMBER * 2; // Initialize the minimum difference to a large value
+
+    // Iterate through each card in the player's hand
+    for (int i = 0; i < hand.size(); ++i)
+    {
+        // Iterate through each row in the playing area
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            // Check if the current card can be played on the current row
+            if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            {
+                // Simulate the move (create copies of playing rows)
+                std::vector<std::vector<int>> temp_rows = playing_rows;
+                temp_rows[j].push_back(hand[i]);
+
+                int playable_after = 0; // Initialize the count of playable cards after the move
+                // Iterate through the remaining cards in the hand
+                for (int k = 0; k < hand.size(); ++k)
+                {
+                    // Skip the card that was just "played"
+                    if (static_cast<unsigned long long>(i) != k)
+                    {
+                        // Iterate through each row to check playability
+                        for (int l = 0; l < NUMBER_OF_ROWS; ++l)
+                        {
+                            // If the remaining card is playable on any row
+                            if (is_valid_move(hand[k], temp_rows[l].back(), l < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                            {
+                                // Increment the count of playable cards and break the inner loop
+                                playable_after++;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                // Calculate the difference between the card and the row's top card
+                int diff = std::abs(hand[i] - playing_rows[j].back());
+                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) == ValidMove::REVERSE_MOVE)
+                    diff = -1;
+
+                // Tie-breaker logic: If playable_after is the same, choose the smaller diff
+                if (playable_after > max_playable_after)
+                {
+                    // Update the maximum playable cards, best card, best row, and minimum difference
+                    max_playable_after = playable_after;
+                    min_diff = diff;
+                    best_card_index = i;
+                    best_card = hand[i];
+                    best_row = j;
+                }
+                else if (playable_after == max_playable_after && diff < min_diff)
+                {
+                    // Update the minimum difference, best card, and best row
+                    min_diff = diff;
+                    best_card_index = i;
+                    best_card = hand[i];
+                    best_row = j;
+                }
+            }
+        }
+    }
+    // Return the best card and row as a pair
+    return {best_card_index, best_row};
+}
+
+/**
+ * @brief Strategy H: "Panic Mode" - If few moves are left, play the largest/smallest possible card.
+ *
+ * This strategy counts the total number of valid moves. If there are very few valid moves left,
+ * it tries to force a play by playing the largest possible card on an ascending row or the
+ * smallest possible card on a descending row. Otherwise, it defaults to Strategy E.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and
+ * the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_H1(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+
+    int total_valid_moves = 0; // Initialize the count of valid moves
+
+    // Iterate through each card in the hand
+    for (int card : hand)
+    {
+        // Iterate through each row in the playing area
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            // If the card can be played on the current row
+            if (is_valid_move(card, playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            {
+                // Increment the count of valid moves
+                total_valid_moves++;
+            }
+        }
+    }
+
+    // If there are very few valid moves left (2 or less)
+    if (total_valid_moves <= 2)
+    {
+        int best_card_index = -1;
+        int best_card = -1; // Initialize the best card to -1 (no card selected yet)
+        int best_row = -1;  // Initialize the best row to -1 (no row selected yet)
+
+        // Try to play the largest possible card on an ascending row, or the smallest on a descending row
+        for (int i = 0; i < hand.size(); ++i)
+        {
+            for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+            {
+                // If the card can be played on the current row
+                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                {
+                    // If it's an ascending row
+                    if (j < NUMBER_OF_ROWS / 2)
+                    {
+                        // Choose the largest card
+                        if (best_card == -1 || hand[i] > best_card)
+                        {
+                            best_card_index = i;
+                            best_card = hand[i];
+                            best_row = j;
+                        }
+                    }
+                    else
+                    { // If it's a descending row
+                        // Choose the smallest card
+                        if (best_card == -1 || hand[i] < best_card)
+                        {
+                            best_card_index = i;
+                            best_card = hand[i];
+                            best_row = j;
+                        }
+                    }
+                }
+            }
+        }
+        // If a move was forced, return it
+        if (best_card_index != -1)
+            return {best_card_index, best_row};
+    }
+
+    // Otherwise, default to Strategy E (a good general-purpose strategy)
+    return get_player_move_E1(hand, playing_rows, communications, player_id);
+}
+
+/**
+ * @brief Strategy H: "Panic Mode" - If few moves are left, play the largest/smallest possible card.
+ *
+ * This strategy counts the total number of valid moves. If there are very few valid moves left,
+ * it tries to force a play by playing the largest possible card on an ascending row or the
+ * smallest possible card on a descending row. Otherwise, it defaults to Strategy E.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @return A pair containing the best card to play and
+ * the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_H2(const std::vector<int> &hand, const std::vector<std::vector<int>> &playing_rows, const std::vector<Communication> &communications, int player_id)
+{
+
+    int total_valid_moves = 0; // Initialize the count of valid moves
+    // Iterate through each card in the hand
+    for (int card : hand)
+    {
+        // Iterate through each row in the playing area
+        for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+        {
+            // If the card can be played on the current row
+            if (is_valid_move(card, playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+            {
+                // Increment the count of valid moves
+                total_valid_moves++;
+            }
+        }
+    }
+
+    // If there are very few valid moves left (2 or less)
+    if (total_valid_moves <= 2)
+    {
+        int best_card_index = -1;
+        int best_card = -1; // Initialize the best card to -1 (no card selected yet)
+        int best_row = -1;  // Initialize the best row to -1 (no row selected yet)
+
+        // Try to play the largest possible card on an ascending row, or the smallest on a descending row
+        for (int i = 0; i < hand.size(); ++i)
+        {
+            for (int j = 0; j < NUMBER_OF_ROWS; ++j)
+            {
+                // If the card can be played on the current row
+                if (is_valid_move(hand[i], playing_rows[j].back(), j < NUMBER_OF_ROWS / 2) != ValidMove::NO)
+                {
+                    // If it's an ascending row
+                    if (j < NUMBER_OF_ROWS / 2)
+                    {
+                        // Choose the largest card
+                        if (best_card == -1 || hand[i] > best_card)
+                        {
+                            best_card_index = i;
+                            best_card = hand[i];
+                            best_row = j;
+                        }
+                    }
+                    else
+                    { // If it's a descending row
+                        // Choose the smallest card
+                        if (best_card == -1 || hand[i] < best_card)
+                        {
+                            best_card = hand[i];
+                            best_card_index = i;
+                            best_row = j;
+                        }
+                    }
+                }
+            }
+        }
+        // If a move was forced, return it
+        if (best_card_index != -1)
+            return {best_card_index, best_row};
+    }
+
+    // Otherwise, default to Strategy E (a good general-purpose strategy)
+    return get_player_move_E2(hand, playing_rows, communications, player_id);
+}
+
+// --- game_logic.cpp ---
+
+// Player struct
+struct Player
+{
+    std::vector<int> hand;  // The cards the player currently holds
+    bool active = true; // Flag to indicate if the player is still in the game
+};
+
+/**
+ * @brief Checks if the game has been won in a multiplayer context.
+ *
+ * The game is won when all players have empty hands and the deck is also empty.
+ *
+ * @param players A vector containing all Player structs.
+ * @param deck_size The current size of the deck.
+ * @return True if the game is won, false otherwise.
+ */
+bool check_win_condition_multiplayer(const std::vector<Player> &players, int deck_size)
+{
+    // Iterate through each player
+    for (const auto &player : players)
+    {
+        // If any player has cards in hand OR the deck is not empty, the game is not won
+        if (!player.hand.empty() || deck_size > 0)
+        {
+            return false;
+        }
+    }
+    // If all players have empty hands and the deck is empty, the game is won
+    return true;
+}
+
+/**
+ * @brief Simulates a single game in a multiplayer setting.
+ *
+ * This function manages the game flow, dealing cards, handling player turns,
+ * checking win conditions, and storing the final game state.
+ *
+ * @param get_player_move A function pointer to the chosen player strategy.
+ * @param num_players The number of players in the game.
+ * @param initial_deck The initial shuffled deck of cards.
+ * @param turns_taken (Output) The total number of turns taken in the game.
+ * @param final_playing_rows (Output) The final state of the playing rows.
+ * @param final_hand (Output) The final hands of all players.
+ * @return True if the game was won, false otherwise.
+ */
+// Reference: seat_order, moves and deck_left added
+bool simulate_game_multiplayer(std::pair<int, int> (*get_player_move)(const std::vector<int> &, const std::vector<std::vector<int>> &, const std::vector<Communication>&, int), int num_players, const std::vector<int> &initial_deck, int &turns_taken, std::vector<std::vector<int>> &final_playing_rows, std::vector<std::vector<int>> &final_hand,
+                               const std::vector<int> &seat_order, std::vector<PlayedMove> &moves, int &deck_left)
+{
+    std::vector<int> deck = initial_deck;
+    std::vector<Player> players(num_players);
+
+    for (auto &player : players)
+    {
+        player.hand = deal_cards(deck, CARD_IN_HANDS);
+    }
+
+    int deck_size = deck.size();
+
+    std::vector<std::vector<int>> playing_rows(NUMBER_OF_ROWS);
+    for (int i = 0; i < NUMBER_OF_ROWS; ++i)
+    {
+        playing_rows[i].push_back(i < NUMBER_OF_ROWS / 2 ? 1 : CARD_MAX_NUMBER);
+    }
+
+    std::vector<int> player_order(num_players);
+    std::iota(player_order.begin(), player_order.end(), 0);
+    player_order = seat_order; // Reference: the given seat order, not shuffle(player_order)
+
+    int current_player_index = 0;
+    int turns = 0;
+
+    std::vector<Communication> communications;
+
+    while (true)
+    {
+        Player current_player = players[player_order[current_player_index]];
+        if (!current_player.active)
+        {
+            current_player_index = (current_player_index + 1) % num_players;
+            continue;
+        }
+
+        // --- Communication Phase ---
+        communications.clear();
+        for (int p_idx = 0; p_idx < num_players; ++p_idx)
+        {
+            if (players[p_idx].active) {
+                for (int card : players[p_idx].hand) {
+                    for (int r_idx = 0; r_idx < NUMBER_OF_ROWS; ++r_idx) {
+                        bool is_ascending = r_idx < NUMBER_OF_ROWS / 2;
+                        ValidMove vm = is_valid_move(card, playing_rows[r_idx].back(), is_ascending);
+                        if (vm == ValidMove::REVERSE_MOVE)
+                        {
+                            communications.push_back({p_idx, r_idx, Communication::REVERSE_TRICK, 0});
+                        }
+                        else if (vm == ValidMove::EXCELLENT){
+                            communications.push_back({p_idx, r_idx, Communication::GOOD_CARD, 0});
+                        }
+                    }
+                }
+            }
+        }
+
+        // --- Action Phase ---
+        // Reference: no trace of the game state before the turn
+
+        int num_cards_to_play_this_turn = (deck_size > 0) ? NUM_CARDS_TO_PLAY : 1;
+
+        bool valid_turn = true;
+        std::vector<int> played_cards;
+        std::vector<int> drawn_cards; // Cards drawn *this* turn
+
+        for (int k = 0; k < num_cards_to_play_this_turn; ++k)
+        {
+            // Create a COPY of the hand for the strategy function.  CRITICAL FIX!
+            std::vector<int> hand_copy = current_player.hand;
+            auto move = get_player_move(hand_copy, playing_rows, communications, player_order[current_player_index]); //Pass the copy
+            int card_index = move.first;
+            int row_index = move.second;
+
+            if (card_index != -1) {
+                int card_to_play = current_player.hand[card_index]; // Use ORIGINAL hand here
+                make_move(card_to_play, row_index, playing_rows);
+                played_cards.push_back(card_to_play);
+                moves.push_back({player_order[current_player_index], card_to_play, row_index}); // Reference: record the card
+
+                // Remove the card by index *immediately* (STILL CORRECT)
+                current_player.hand.erase(current_player.hand.begin() + card_index);
+                turns++; // Increment *after* playing (but before drawing)
+            }
+            else
+            {
+                valid_turn = false;
+            }
+        }
+
+
+        // --- Replenish Hand (AT THE END OF THE TURN) ---
+        while (current_player.hand.size() < CARD_IN_HANDS && deck_size > 0) {
+            current_player.hand.push_back(deck.back());
+            drawn_cards.push_back(deck.back()); // Track drawn cards
+            deck.pop_back();
+            deck_size--;
+        }
+
+        if (!valid_turn)
+        {
+            break;
+        }
+
+        // Reference: no trace of the game state after the turn
+
+        if (current_player.hand.empty() && deck_size == 0)
+        {
+            current_player.active = false;
+        }
+
+        players[player_order[current_player_index]] = current_player;
+
+        current_player_index = (current_player_index + 1) % num_players;
+
+        // Check for game over (all players inactive)
+        bool all_players_done = true;
+        for (const auto &player : players)
+        {
+            if (player.active)
+            {
+                all_players_done = false;
+                break;
+            }
+        }
+        if (all_players_done)
+        {
+            break;
+        }
+    }
+
+    for (const auto &player : players)
+    {
+        final_hand.push_back(player.hand);
+    }
+
+    turns_taken = turns;
+    final_playing_rows = playing_rows;
+    deck_left = deck_size; // Reference: the draw pile left
+    return check_win_condition_multiplayer(players, deck_size);
+}
+
+} // namespace reference
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+using BaselineStrategy = std::pair<int, int> (*)(const std::vector<int> &, const std::vector<std::vector<int>> &, const std::vector<reference::Communication> &, int);
+
+BaselineStrategy baseline_strategy(const std::string &name)
+{
+    if (name == "A1") return reference::get_player_move_A1;
+    if (name == "A2") return reference::get_player_move_A2;
+    if (name == "E1") return reference::get_player_move_E1;
+    if (name == "E2") return reference::get_player_move_E2;
+    if (name == "H1") return reference::get_player_move_H1;
+    if (name == "H2") return reference::get_player_move_H2;
+    return nullptr;
+}
+
+} // namespace
+
+/**
+ * @brief True if the first version of the program had the strategy, with the parameters it hard-coded.
+ *
+ * @param strategy_name The strategy name.
+ * @param params The parameters the live strategy is played with.
+ */
+bool has_baseline_strategy(const std::string &strategy_name, const StrategyParams &params)
+{
+    return baseline_strategy(strategy_name) != nullptr && params.claimed_row_penalty == 100 && params.panic_threshold == 2;
+}
+
+/**
+ * @brief Plays one game with the verbatim copy of the first engine and of the strategy as they were first written.
+ *
+ * The copy deals from the whole deck, so the deck of the setup is rebuilt
+ * from its draw pile and hands. Only for strategies of has_baseline_strategy.
+ *
+ * @param config The game config.
+ * @param strategy_name The strategy of every seat.
+ * @param setup The dealt hands, draw pile and seat order.
+ * @param record (Output) Every card played and the final state.
+ * @return True if the game was won.
+ */
+bool play_baseline_game(const GameConfig &config, const std::string &strategy_name, const GameSetup &setup, GameRecord &record)
+{
+    reference::CARD_MAX_NUMBER = config.card_max_number;
+    reference::REVERSE_MOVE_DIFF = config.reverse_move_diff;
+    reference::CARD_IN_HANDS = config.card_in_hands;
+    reference::NUM_CARDS_TO_PLAY = config.num_cards_to_play;
+    reference::NUMBER_OF_ROWS = config.number_of_rows;
+    reference::GOOD_MOVE_WINDOW = config.good_move_window;
+
+    // Hands are dealt from the back, player 0 first
+    std::vector<int> deck = setup.deck;
+    for (int p = static_cast<int>(setup.hands.size()) - 1; p >= 0; --p)
+    {
+        deck.insert(deck.end(), setup.hands[p].rbegin(), setup.hands[p].rend());
+    }
+
+    std::vector<std::vector<int>> final_rows;
+    record.moves.clear();
+    record.hands.clear();
+    bool won = reference::simulate_game_multiplayer(baseline_strategy(strategy_name), setup.hands.size(), deck, record.turns, final_rows, record.hands,
+                                                    setup.player_order, record.moves, record.deck_size);
+    record.row_tops.clear();
+    for (const auto &row : final_rows)
+    {
+        record.row_tops.push_back(row.back());
+    }
+    record.won = won;
+    return won;
+}
@@ -0,0 +1,196 @@
+#include "reference_engine.h"
+#include "card_tracking.h"
+#include "helper_functions.h"
+
+#include <cstdlib>
+
+/**
+ * @brief Plays one game by the rules, as plainly as possible: the reference of the strategies the first version did not have.
+ *
+ * A frozen copy of the rules of simulate_game_multiplayer, kept apart so
+ * that optimising the live engine cannot change what it is compared with.
+ * It plays the live strategy, so it only checks the engines; strategies of
+ * the first version are checked against their verbatim copy instead
+ * (play_baseline_game).
+ * Nothing is cached or pooled: every container is a fresh vector, moves are
+ * checked with is_valid_move and the strategy gets no move cache. It does
+ * hand over the card tracker and asks for a whole-turn plan on the first
+ * move of a turn, as every engine must. Do not optimise this function; a
+ * rule change goes here first and then into the engines.
+ *
+ * A turn: the communications of every active player against the row tops,
+ * then the cards to play (all of NUM_CARDS_TO_PLAY while the draw pile
+ * lasts, one after). A whole-turn plan is played up to its first illegal
+ * move and fails the turn unless it plays exactly the cards of the turn; a
+ * single-move strategy is asked once per card and a pass fails the turn.
+ * The hand is refilled, and a failed turn ends the game with the hand from
+ * the start of the turn. A player with no cards left once the pile is empty
+ * is done; the game is won when every player is done.
+ *
+ * @param config The game config.
+ * @param strategy The strategy of every seat.
+ * @param setup The dealt hands, draw pile and seat order.
+ * @param params The strategy parameters (also the good-move window of communications).
+ * @param record (Output) Every card played and the final state.
+ * @return True if the game was won.
+ */
+bool play_reference_game(const GameConfig &config, StrategyFunction strategy, const GameSetup &setup, const StrategyParams &params, GameRecord &record)
+{
+    int num_players = setup.hands.size();
+    int half = config.number_of_rows / 2;
+    std::vector<int> deck = setup.deck;
+    std::vector<Hand> hands;
+    for (const auto &hand : setup.hands)
+    {
+        hands.emplace_back(hand.begin(), hand.end());
+    }
+    std::vector<bool> active(num_players, true);
+    PlayingRows playing_rows(config.number_of_rows);
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        playing_rows[r].push_back(r < half ? 1 : config.card_max_number);
+    }
+    CardTracker cards;
+    cards.start_game(config, setup.hands, deck.size());
+
+    record.moves.clear();
+    int played = 0;
+    int seat = 0;
+    while (true)
+    {
+        int player = setup.player_order[seat];
+        if (!active[player])
+        {
+            seat = (seat + 1) % num_players;
+            continue;
+        }
+
+        Communications communications;
+        for (int p = 0; p < num_players; ++p)
+        {
+            if (!active[p])
+            {
+                continue;
+            }
+            for (int card : hands[p])
+            {
+                for (int r = 0; r < config.number_of_rows; ++r)
+                {
+                    int top = playing_rows[r].back();
+                    ValidMove valid = is_valid_move(config, card, top, r < half);
+                    if (valid == ValidMove::REVERSE_MOVE)
+                    {
+                        communications.push_back({p, r, Communication::REVERSE_TRICK, 0});
+                    }
+                    else if (valid != ValidMove::NO && std::abs(card - top) < params.good_move_window)
+                    {
+                        communications.push_back({p, r, Communication::GOOD_CARD, 0});
+                    }
+                }
+            }
+        }
+
+        int cards_this_turn = deck.empty() ? 1 : config.num_cards_to_play;
+        Hand hand_at_turn_start = hands[player];
+        bool valid_turn = true;
+        for (int k = 0; k < cards_this_turn; ++k)
+        {
+            TurnPlan plan;
+            StrategyContext context{config, params, nullptr};
+            context.cards = &cards;
+            context.cards_to_plan = cards_this_turn - k;
+            context.turn_plan = k == 0 ? &plan : nullptr;
+            Hand hand = hands[player];
+            std::pair<int, int> move = strategy(hand, playing_rows, communications, player, context);
+
+            if (!plan.empty())
+            {
+                // Moves refer to the hand at the start of the turn
+                Hand turn_hand = hands[player];
+                std::vector<bool> used(turn_hand.size(), false);
+                valid_turn = static_cast<int>(plan.size()) == cards_this_turn;
+                for (int m = 0; m < static_cast<int>(plan.size()) && m < cards_this_turn; ++m)
+                {
+                    auto [card_index, row] = plan[m];
+                    if (card_index < 0 || card_index >= static_cast<int>(turn_hand.size()) || used[card_index] || row < 0 || row >= config.number_of_rows ||
+                        is_valid_move(config, turn_hand[card_index], playing_rows[row].back(), row < half) == ValidMove::NO)
+                    {
+                        valid_turn = false;
+                        break;
+                    }
+                    used[card_index] = true;
+                    playing_rows[row].push_back(turn_hand[card_index]);
+                    cards.card_played(turn_hand[card_index]);
+                    record.moves.push_back({player, turn_hand[card_index], row});
+                    played++;
+                }
+                hands[player].clear();
+                for (size_t i = 0; i < turn_hand.size(); ++i)
+                {
+                    if (!used[i])
+                    {
+                        hands[player].push_back(turn_hand[i]);
+                    }
+                }
+                break;
+            }
+
+            if (move.first == -1)
+            {
+                valid_turn = false; // The strategy is still asked for the other cards of the turn
+                continue;
+            }
+            int card = hands[player][move.first];
+            playing_rows[move.second].push_back(card);
+            cards.card_played(card);
+            record.moves.push_back({player, card, move.second});
+            hands[player].erase(hands[player].begin() + move.first);
+            played++;
+        }
+
+        while (static_cast<int>(hands[player].size()) < config.card_in_hands && !deck.empty())
+        {
+            hands[player].push_back(deck.back());
+            cards.card_drawn(player, deck.back());
+            deck.pop_back();
+        }
+
+        if (!valid_turn)
+        {
+            hands[player] = hand_at_turn_start;
+            break;
+        }
+        if (hands[player].empty() && deck.empty())
+        {
+            active[player] = false;
+        }
+        seat = (seat + 1) % num_players;
+
+        bool all_done = true;
+        for (bool is_active : active)
+        {
+            all_done = all_done && !is_active;
+        }
+        if (all_done)
+        {
+            break;
+        }
+    }
+
+    bool won = deck.empty();
+    record.hands.assign(num_players, {});
+    for (int p = 0; p < num_players; ++p)
+    {
+        record.hands[p].assign(hands[p].begin(), hands[p].end());
+        won = won && hands[p].empty();
+    }
+    record.row_tops.resize(config.number_of_rows);
+    for (int r = 0; r < config.number_of_rows; ++r)
+    {
+        record.row_tops[r] = playing_rows[r].back();
+    }
+    record.turns = played;
+    record.deck_size = deck.size();
+    record.won = won;
+    return won;
+}
@@ -0,0 +1,16 @@
+#ifndef REFERENCE_ENGINE_H
+#define REFERENCE_ENGINE_H
+
+#include <string>
+
+#include "game_config.h"
+#include "game_logic.h"
+#include "player_strategies.h"
+
+bool play_reference_game(const GameConfig &config, StrategyFunction strategy, const GameSetup &setup, const StrategyParams &params, GameRecord &record);
+
+// Verbatim copy of the first engine and strategies (reference_baseline.cpp)
+bool has_baseline_strategy(const std::string &strategy_name, const StrategyParams &params);
+bool play_baseline_game(const GameConfig &config, const std::string &strategy_name, const GameSetup &setup, GameRecord &record);
+
+#endif
@@ -0,0 +1,290 @@
+#include "result_cache.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'T', 'G', 'R', 'C', 'A', 'C', 'H', '1'};
+const uint32_t CACHE_VERSION = 2;
+
+static_assert(std::is_trivially_copyable<ResultCacheEntry>::value, "cache entries are written as they are in memory");
+
+// Larger states are taken for corruption (a game of 2^24 cards is far beyond any config)
+const uint64_t MAX_STATE_VALUES = 1 << 24;
+
+// First bytes of a cache file, followed by the entries
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size; // sizeof(ResultCacheEntry) of the program that created the file (without the state)
+};
+
+uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t fnv1a(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+uint64_t key_hash(const ResultCacheKey &key)
+{
+    return mix64(key.deck ^ mix64(key.seats ^ mix64(key.config ^ mix64(key.strategy))));
+}
+
+bool same_key(const ResultCacheKey &a, const ResultCacheKey &b)
+{
+    return a.deck == b.deck && a.seats == b.seats && a.config == b.config && a.strategy == b.strategy;
+}
+
+bool write_all(int fd, const void *data, size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Hash of the rules a game outcome depends on (every config value but NUM_SIMULATIONS).
+ */
+uint64_t config_cache_hash(const GameConfig &config)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int value : {config.card_max_number, config.reverse_move_diff, config.card_in_hands, config.num_cards_to_play,
+                      config.number_of_rows, config.number_of_players, config.good_move_window})
+    {
+        hash = fnv1a(hash, static_cast<uint32_t>(value));
+    }
+    return mix64(hash);
+}
+
+/**
+ * @brief Hash of a seat order (GameSetup::player_order).
+ */
+uint64_t seat_order_hash(const std::vector<int> &player_order)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int player : player_order)
+    {
+        hash = fnv1a(hash, static_cast<uint32_t>(player));
+    }
+    return mix64(hash);
+}
+
+/**
+ * @brief Adds an outcome: its key, its record and the state of the record.
+ */
+void ResultCacheBatch::add(const ResultCacheKey &key, const ResultRecord &record, const int32_t *state)
+{
+    ResultCacheEntry entry{key, record};
+    const char *entry_bytes = reinterpret_cast<const char *>(&entry);
+    const char *state_bytes = reinterpret_cast<const char *>(state);
+    bytes_.insert(bytes_.end(), entry_bytes, entry_bytes + sizeof(entry));
+    bytes_.insert(bytes_.end(), state_bytes, state_bytes + result_state_size(record) * sizeof(int32_t));
+}
+
+ResultCache::~ResultCache()
+{
+    std::string error;
+    close(error);
+}
+
+/**
+ * @brief Opens a cache file for lookups and appends, creating it if needed.
+ *
+ * @param filename The cache file.
+ * @param error (Output) Why the file cannot be used.
+ * @return True if the cache is open.
+ */
+bool ResultCache::open(const std::string &filename, std::string &error)
+{
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        error = "cannot open result cache " + filename;
+        return false;
+    }
+
+    CacheHeader header = {};
+    size_t file_size = info.st_size;
+    if (file_size == 0)
+    {
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.entry_size = sizeof(ResultCacheEntry);
+        if (!write_all(fd, &header, sizeof(header)))
+        {
+            ::close(fd);
+            error = "cannot write result cache " + filename;
+            return false;
+        }
+        file_size = sizeof(header);
+    }
+    else if (file_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+             std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+             header.entry_size != sizeof(ResultCacheEntry))
+    {
+        ::close(fd);
+        error = filename + " is not a result cache of this version";
+        return false;
+    }
+
+    void *mapping = nullptr;
+    if (file_size > sizeof(header))
+    {
+        mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd);
+            error = "cannot map result cache " + filename;
+            return false;
+        }
+    }
+
+    // Entries are appended whole; a partial one is what an interrupted run left
+    const char *data = static_cast<const char *>(mapping);
+    std::unordered_map<uint64_t, uint64_t> index;
+    size_t offset = sizeof(header);
+    while (offset + sizeof(ResultCacheEntry) <= file_size)
+    {
+        ResultCacheEntry entry;
+        std::memcpy(&entry, data + offset, sizeof(entry));
+        uint64_t state_size = result_state_size(entry.record);
+        if (state_size > MAX_STATE_VALUES || offset + sizeof(entry) + state_size * sizeof(int32_t) > file_size)
+        {
+            break;
+        }
+        index[key_hash(entry.key)] = offset;
+        offset += sizeof(entry) + state_size * sizeof(int32_t);
+    }
+    if ((offset != file_size && ftruncate(fd, offset) != 0) || lseek(fd, offset, SEEK_SET) < 0)
+    {
+        if (mapping != nullptr)
+        {
+            munmap(mapping, file_size);
+        }
+        ::close(fd);
+        error = "cannot append to result cache " + filename;
+        return false;
+    }
+
+    close(error);
+    fd_ = fd;
+    write_failed_ = false;
+    mapping_ = mapping;
+    mapping_size_ = file_size;
+    data_ = data;
+    index_ = std::move(index);
+    hits_ = 0;
+    misses_ = 0;
+    return true;
+}
+
+/**
+ * @brief Looks up the outcome of a game in the entries that were in the file when it was opened.
+ *
+ * Safe to call from several threads at once.
+ *
+ * @param key The deal, rules and strategy version of the game.
+ * @param record (Output) The cached result record (deck and strategy indices of the run that stored it).
+ * @param state (Output) The state of the record.
+ * @return True on a hit.
+ */
+bool ResultCache::lookup(const ResultCacheKey &key, ResultRecord &record, std::vector<int32_t> &state)
+{
+    auto found = index_.find(key_hash(key));
+    ResultCacheEntry entry;
+    if (found != index_.end())
+    {
+        std::memcpy(&entry, data_ + found->second, sizeof(entry));
+    }
+    if (found == index_.end() || !same_key(entry.key, key))
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    record = entry.record;
+    state.resize(result_state_size(record));
+    std::memcpy(state.data(), data_ + found->second + sizeof(entry), state.size() * sizeof(int32_t));
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Appends outcomes to the file in one write (several threads may append at once).
+ *
+ * Appended entries are found by the next run, not by lookups of this one.
+ *
+ * @param batch The outcomes.
+ */
+void ResultCache::append(const ResultCacheBatch &batch)
+{
+    if (batch.bytes().empty())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(append_mutex_);
+    if (fd_ >= 0 && !write_failed_ && !write_all(fd_, batch.bytes().data(), batch.bytes().size()))
+    {
+        write_failed_ = true; // The next open cuts the partial entry off
+    }
+}
+
+/**
+ * @brief Closes the file.
+ *
+ * @param error (Output) Why not every appended outcome was written.
+ * @return True if every appended outcome is in the file.
+ */
+bool ResultCache::close(std::string &error)
+{
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    data_ = nullptr;
+    index_.clear();
+    bool ok = !write_failed_;
+    if (fd_ >= 0 && ::close(fd_) != 0)
+    {
+        ok = false;
+    }
+    fd_ = -1;
+    write_failed_ = false;
+    if (!ok)
+    {
+        error = "result cache write failed";
+    }
+    return ok;
+}
@@ -0,0 +1,88 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "game_config.h"
+#include "result_output.h"
+
+// What a cached outcome depends on: the deal, the rules and the strategy's code
+struct ResultCacheKey
+{
+    uint64_t deck;     // deck_hash of the shuffled deck
+    uint64_t seats;    // Hash of the seat order
+    uint64_t config;   // config_cache_hash of the rules
+    uint64_t strategy; // strategy_version_hash of the strategy playing every seat
+};
+
+// Start of one outcome in the cache file, followed by the state of the record: a hit prints what the game would have
+struct ResultCacheEntry
+{
+    ResultCacheKey key;
+    ResultRecord record;
+};
+
+/**
+ * @brief Outcomes of one worker waiting to be appended, packed as they are stored in the file.
+ */
+class ResultCacheBatch
+{
+public:
+    void add(const ResultCacheKey &key, const ResultRecord &record, const int32_t *state);
+    void clear() { bytes_.clear(); }
+    const std::vector<char> &bytes() const { return bytes_; }
+
+private:
+    std::vector<char> bytes_;
+};
+
+uint64_t config_cache_hash(const GameConfig &config);
+uint64_t seat_order_hash(const std::vector<int> &player_order);
+
+/**
+ * @brief Persistent per-game outcomes, keyed by deck, seat order, rules and strategy version.
+ *
+ * The file is append-only: a header, then entries in the order they were
+ * simulated, each a ResultCacheEntry and the state of its record. Opening
+ * maps the entries already written and indexes their offsets by key in
+ * memory; lookups read the mapping without locks, new
+ * outcomes are appended in whole entries under a mutex (a tail left by an
+ * interrupted run is cut off on the next open). An entry is never updated:
+ * a new strategy version gives new keys, so stale outcomes are simply no
+ * longer found.
+ */
+class ResultCache
+{
+public:
+    ResultCache() = default;
+    ~ResultCache();
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    bool open(const std::string &filename, std::string &error);
+    bool lookup(const ResultCacheKey &key, ResultRecord &record, std::vector<int32_t> &state);
+    void append(const ResultCacheBatch &batch);
+    bool close(std::string &error);
+
+    size_t size() const { return index_.size(); }
+    long long hits() const { return hits_; }
+    long long misses() const { return misses_; }
+
+private:
+    int fd_ = -1;
+    bool write_failed_ = false;
+    std::mutex append_mutex_;
+    void *mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    const char *data_ = nullptr;
+    std::unordered_map<uint64_t, uint64_t> index_; // Key hash -> file offset of the entry (the latest entry of a key)
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+};
+
+#endif
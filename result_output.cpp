@@ -0,0 +1,470 @@
+#include "result_output.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const size_t SINK_BUFFER_BYTES = 1 << 20; // Size of the writes to the output file
+const size_t WRITER_BATCH = 1024;         // Records taken from a ring at once
+const size_t STATE_VALUES_PER_RECORD = 128; // State ring size per record slot (a 100-card game needs about 110)
+
+/**
+ * @brief Base of the sinks: an output file (or stdout) fed from a large buffer.
+ */
+class BufferedFileSink : public ResultSink
+{
+public:
+    BufferedFileSink(std::FILE *file, bool owns_file, const std::vector<std::string> &strategy_names)
+        : file_(file), owns_file_(owns_file), strategy_names_(strategy_names)
+    {
+        buffer_.reserve(SINK_BUFFER_BYTES + 4096);
+    }
+
+    ~BufferedFileSink() override
+    {
+        if (owns_file_ && file_ != nullptr)
+        {
+            std::fclose(file_);
+        }
+    }
+
+    bool finish(std::string &error) override
+    {
+        flush();
+        bool ok = std::fflush(file_) == 0 && !std::ferror(file_);
+        if (owns_file_)
+        {
+            ok = std::fclose(file_) == 0 && ok;
+            file_ = nullptr;
+        }
+        if (!ok)
+        {
+            error = "writing the results failed";
+        }
+        return ok;
+    }
+
+protected:
+    void append(const char *text)
+    {
+        buffer_.append(text);
+    }
+
+    void append(const std::string &text)
+    {
+        buffer_.append(text);
+    }
+
+    void append(long long value)
+    {
+        char digits[24];
+        char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        buffer_.append(digits, end);
+    }
+
+    void append_raw(const void *data, size_t bytes)
+    {
+        buffer_.append(static_cast<const char *>(data), bytes);
+    }
+
+    void append_shuffle_id(uint64_t shuffle_id)
+    {
+        char digits[17];
+        std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(shuffle_id));
+        buffer_.append(digits);
+    }
+
+    // Writes the buffer out once it is large enough
+    void maybe_flush()
+    {
+        if (buffer_.size() >= SINK_BUFFER_BYTES)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!buffer_.empty())
+        {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            buffer_.clear();
+        }
+    }
+
+    std::FILE *file_;
+    bool owns_file_;
+    std::vector<std::string> strategy_names_;
+    std::string buffer_;
+};
+
+// Same "Game Results:" blocks as the simulate mode always printed (read by csv_generation.py)
+class TextSink : public BufferedFileSink
+{
+public:
+    using BufferedFileSink::BufferedFileSink;
+
+    void write(const ResultRecord &record, const int32_t *state) override
+    {
+        const int32_t *row_lengths = state;
+        const int32_t *hand_lengths = state + record.num_rows;
+        const int32_t *cards = hand_lengths + record.num_players;
+        append("Game Results:\n  Number of Players: ");
+        append(record.num_players);
+        append("\n  Shuffle ID: ");
+        append_shuffle_id(record.shuffle_id);
+        append("\n  Strategy: ");
+        append(strategy_names_[record.strategy_index]);
+        append(record.win ? "\n  Win: true\n  Turns: " : "\n  Win: false\n  Turns: ");
+        append(record.turns);
+        append("\n  Deck Size: ");
+        append(record.deck_size);
+        append("\n  Final Playing Rows:\n");
+        int card = 0;
+        for (int i = 0; i < static_cast<int>(record.num_rows); ++i)
+        {
+            append(i < static_cast<int>(record.num_rows) / 2 ? "    Ascending: " : "    Descending: ");
+            for (int k = 0; k < row_lengths[i]; ++k)
+            {
+                append(cards[card++]);
+                append(" ");
+            }
+            append("\n");
+        }
+        append("  Final Hands:\n");
+        for (int p = 0; p < static_cast<int>(record.num_players); ++p)
+        {
+            append("    Player ");
+            append(p + 1);
+            append(": ");
+            for (int k = 0; k < hand_lengths[p]; ++k)
+            {
+                append(cards[card++]);
+                append(" ");
+            }
+            append("\n");
+        }
+        append("\n");
+        maybe_flush();
+    }
+};
+
+// One line per record, same columns as csv_generation.py (cards of a row or hand separated by spaces)
+class CsvSink : public BufferedFileSink
+{
+public:
+    CsvSink(std::FILE *file, bool owns_file, const std::vector<std::string> &strategy_names)
+        : BufferedFileSink(file, owns_file, strategy_names)
+    {
+        header_pending_ = true;
+    }
+
+    void write(const ResultRecord &record, const int32_t *state) override
+    {
+        int num_rows = record.num_rows;
+        int num_players = record.num_players;
+        if (header_pending_)
+        {
+            append("NumPlayers,ShuffleID,Strategy,Win,Turns,DeckSize");
+            for (int i = 0; i < num_rows; ++i)
+            {
+                append(i < num_rows / 2 ? ",Ascending" : ",Descending");
+                append(i < num_rows / 2 ? i + 1 : i - num_rows / 2 + 1);
+            }
+            for (int p = 0; p < num_players; ++p)
+            {
+                append(",Player");
+                append(p + 1);
+            }
+            append("\n");
+            header_pending_ = false;
+        }
+        append(record.num_players);
+        append(",");
+        append_shuffle_id(record.shuffle_id);
+        append(",");
+        append(strategy_names_[record.strategy_index]);
+        append(record.win ? ",True," : ",False,");
+        append(record.turns);
+        append(",");
+        append(record.deck_size);
+        const int32_t *cards = state + num_rows + num_players;
+        int card = 0;
+        for (int i = 0; i < num_rows + num_players; ++i)
+        {
+            int length = state[i]; // Row lengths, then hand lengths
+            append(",");
+            for (int k = 0; k < length; ++k)
+            {
+                if (k > 0)
+                {
+                    append(" ");
+                }
+                append(cards[card++]);
+            }
+        }
+        append("\n");
+        maybe_flush();
+    }
+
+private:
+    bool header_pending_;
+};
+
+/**
+ * Raw records. File layout: the 8 bytes "TGRESULT", then uint32 format version (2),
+ * uint32 sizeof(ResultRecord), uint32 number of strategies, the strategy names
+ * (each terminated by '\0'), then the records back to back, native endianness.
+ * Each record is a ResultRecord (whose num_rows, num_players and num_cards
+ * give the length of what follows) and its state: num_rows row lengths,
+ * num_players hand lengths and num_cards cards, all int32.
+ */
+class BinarySink : public BufferedFileSink
+{
+public:
+    BinarySink(std::FILE *file, bool owns_file, const std::vector<std::string> &strategy_names)
+        : BufferedFileSink(file, owns_file, strategy_names)
+    {
+        uint32_t header[3] = {2, static_cast<uint32_t>(sizeof(ResultRecord)), static_cast<uint32_t>(strategy_names.size())};
+        append_raw("TGRESULT", 8);
+        append_raw(header, sizeof(header));
+        for (const auto &name : strategy_names)
+        {
+            append_raw(name.c_str(), name.size() + 1);
+        }
+    }
+
+    void write(const ResultRecord &record, const int32_t *state) override
+    {
+        append_raw(&record, sizeof(record));
+        append_raw(state, result_state_size(record) * sizeof(int32_t));
+        maybe_flush();
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Most values in the state of a record of a config (every card in a row or a hand, plus the lengths).
+ *
+ * @param config The game config.
+ * @param num_players The number of players.
+ * @return The bound on result_state_size.
+ */
+size_t max_result_state_size(const GameConfig &config, int num_players)
+{
+    // Every card ends in a row, a hand or the deck; each row also holds its starting card. A failed
+    // turn puts the hand back as it was at the turn start, so the cards already played that turn
+    // (fewer than num_cards_to_play) are in a row and in the hand at once.
+    size_t max_cards = static_cast<size_t>(config.card_max_number) - 2 + config.number_of_rows + config.num_cards_to_play;
+    return config.number_of_rows + num_players + max_cards;
+}
+
+/**
+ * @brief Packs the outcome of one game into a record header and its state.
+ *
+ * @param state (Output) The lengths of the final rows and hands, then their cards.
+ * @return The record header.
+ */
+ResultRecord make_result_record(uint64_t shuffle_id, int deck_index, int strategy_index, bool win, int turns, int deck_size, const std::vector<std::vector<int>> &final_playing_rows, const std::vector<std::vector<int>> &final_hand,
+                                std::vector<int32_t> &state)
+{
+    ResultRecord record;
+    std::memset(&record, 0, sizeof(record)); // Padding included: binary output is deterministic
+    record.shuffle_id = shuffle_id;
+    record.deck_index = deck_index;
+    record.strategy_index = strategy_index;
+    record.num_players = final_hand.size();
+    record.num_rows = final_playing_rows.size();
+    record.win = win;
+    record.turns = turns;
+    record.deck_size = deck_size;
+    state.clear();
+    for (const auto &row : final_playing_rows)
+    {
+        state.push_back(row.size());
+    }
+    for (const auto &hand : final_hand)
+    {
+        state.push_back(hand.size());
+    }
+    for (const auto &row : final_playing_rows)
+    {
+        state.insert(state.end(), row.begin(), row.end());
+    }
+    for (const auto &hand : final_hand)
+    {
+        state.insert(state.end(), hand.begin(), hand.end());
+    }
+    record.num_cards = state.size() - record.num_rows - record.num_players;
+    return record;
+}
+
+/**
+ * @brief Creates the sink for an output format.
+ *
+ * @param format "text", "csv" or "binary".
+ * @param filename The output file, "-" for the standard output.
+ * @param strategy_names The names of the strategy indices of the records.
+ * @param error (Output) Why the sink could not be created.
+ * @return The sink, or nullptr on error.
+ */
+std::unique_ptr<ResultSink> make_result_sink(const std::string &format, const std::string &filename, const std::vector<std::string> &strategy_names, std::string &error)
+{
+    if (format != "text" && format != "csv" && format != "binary")
+    {
+        error = "unknown output format '" + format + "' (text, csv or binary)";
+        return nullptr;
+    }
+    bool to_stdout = filename == "-";
+    std::FILE *file = to_stdout ? stdout : std::fopen(filename.c_str(), format == "binary" ? "wb" : "w");
+    if (file == nullptr)
+    {
+        error = "cannot open " + filename + " for writing";
+        return nullptr;
+    }
+    if (format == "text")
+    {
+        return std::make_unique<TextSink>(file, !to_stdout, strategy_names);
+    }
+    if (format == "csv")
+    {
+        return std::make_unique<CsvSink>(file, !to_stdout, strategy_names);
+    }
+    return std::make_unique<BinarySink>(file, !to_stdout, strategy_names);
+}
+
+/**
+ * @brief Creates one ring per producer and starts the writer thread.
+ *
+ * @param sink Where the records go (only used by the writer thread).
+ * @param num_producers The number of simulation workers.
+ * @param ring_capacity Records each ring can hold (rounded up to a power of two).
+ * @param max_state_size Most values in the state of a record (max_result_state_size).
+ * @param backpressure What push does when a ring is full.
+ */
+ResultPipeline::ResultPipeline(ResultSink &sink, int num_producers, size_t ring_capacity, size_t max_state_size, Backpressure backpressure)
+    : sink_(sink), backpressure_(backpressure), max_state_size_(max_state_size)
+{
+    // Room for the states of a full ring of typical records, and always for a few of the largest
+    size_t state_capacity = std::max(ring_capacity * STATE_VALUES_PER_RECORD, 4 * max_state_size);
+    for (int p = 0; p < num_producers; ++p)
+    {
+        rings_.push_back(std::make_unique<SpscRing<ResultRecord>>(ring_capacity));
+        state_rings_.push_back(std::make_unique<SpscRing<int32_t>>(state_capacity));
+    }
+    writer_ = std::thread(&ResultPipeline::writer_loop, this);
+}
+
+ResultPipeline::~ResultPipeline()
+{
+    finish();
+}
+
+/**
+ * @brief Hands a record and its state to the writer thread. Called by worker `producer` only.
+ *
+ * @return False if the state is larger than max_state_size: the record is rejected (see rejected).
+ */
+bool ResultPipeline::push(int producer, const ResultRecord &record, const int32_t *state)
+{
+    SpscRing<ResultRecord> &ring = *rings_[producer];
+    SpscRing<int32_t> &state_ring = *state_rings_[producer];
+    size_t state_size = result_state_size(record);
+    if (state_size > max_state_size_)
+    {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // The state goes first: the writer finds it complete once it sees the record
+    while (!ring.has_room(1) || !state_ring.try_push(state, state_size))
+    {
+        if (backpressure_ == Backpressure::DROP)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        std::this_thread::yield();
+    }
+    ring.try_push(record); // Room checked above, only the writer frees slots
+    return true;
+}
+
+/**
+ * @brief Waits until every pushed record reached the sink and stops the writer thread.
+ *
+ * Must be called after the workers stopped pushing.
+ */
+void ResultPipeline::finish()
+{
+    if (writer_.joinable())
+    {
+        done_.store(true, std::memory_order_release);
+        writer_.join();
+    }
+}
+
+long long ResultPipeline::written() const
+{
+    return written_;
+}
+
+long long ResultPipeline::dropped() const
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+long long ResultPipeline::rejected() const
+{
+    return rejected_.load(std::memory_order_relaxed);
+}
+
+// Moves one batch from every ring to the sink, returns the number of records moved
+size_t ResultPipeline::drain(std::vector<ResultRecord> &batch, std::vector<int32_t> &state)
+{
+    size_t moved = 0;
+    for (size_t r = 0; r < rings_.size(); ++r)
+    {
+        size_t count = rings_[r]->pop_batch(batch.data(), batch.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t state_size = result_state_size(batch[i]);
+            if (state_size > state.size())
+            {
+                // push rejects such records; never write past the buffer if one got through
+                for (size_t left = state_size; left > 0;)
+                {
+                    left -= state_rings_[r]->pop_batch(state.data(), std::min(left, state.size()));
+                }
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            state_rings_[r]->pop_batch(state.data(), state_size);
+            sink_.write(batch[i], state.data());
+            written_++;
+        }
+        moved += count;
+    }
+    return moved;
+}
+
+void ResultPipeline::writer_loop()
+{
+    std::vector<ResultRecord> batch(WRITER_BATCH);
+    std::vector<int32_t> state(max_state_size_);
+    while (!done_.load(std::memory_order_acquire))
+    {
+        if (drain(batch, state) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    // The producers are done: empty the rings
+    while (drain(batch, state) > 0)
+    {
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef RESULT_OUTPUT_H
+#define RESULT_OUTPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_config.h"
+#include "spsc_ring.h"
+
+// Outcome of one strategy on one deck: a fixed-size, trivially copyable header
+// that goes through the ring buffers as is. The final rows and hands follow
+// it as a state of result_state_size values: the length of each row, the
+// length of each hand, then the cards of the rows and of the hands. Any
+// config fits, whatever its number of rows, players and cards.
+struct ResultRecord
+{
+    uint64_t shuffle_id;     // Hash of the shuffled deck (see deck_hash)
+    uint32_t deck_index;     // Index of the deck in the run
+    uint16_t strategy_index; // Index into the strategy names of the sink
+    uint8_t win;
+    uint8_t reserved;
+    uint32_t num_players;
+    uint32_t num_rows;
+    uint32_t num_cards;      // Cards of the final rows plus the final hands
+    int32_t turns;           // Cards played
+    int32_t deck_size;       // Cards left in the draw pile
+};
+
+inline size_t result_state_size(const ResultRecord &record)
+{
+    return static_cast<size_t>(record.num_rows) + record.num_players + record.num_cards;
+}
+
+// What a simulation worker does when its ring buffer is full
+enum class Backpressure
+{
+    BLOCK, // Wait for the writer thread (no record lost)
+    DROP   // Drop the record and count it
+};
+
+size_t max_result_state_size(const GameConfig &config, int num_players);
+ResultRecord make_result_record(uint64_t shuffle_id, int deck_index, int strategy_index, bool win, int turns, int deck_size, const std::vector<std::vector<int>> &final_playing_rows, const std::vector<std::vector<int>> &final_hand,
+                                std::vector<int32_t> &state);
+
+/**
+ * @brief Destination of the result records, written by the writer thread only.
+ *
+ * Sinks format into a large in-memory buffer and hand it to the file in big
+ * writes, never one write per record.
+ */
+class ResultSink
+{
+public:
+    virtual ~ResultSink() = default;
+    virtual void write(const ResultRecord &record, const int32_t *state) = 0;
+    virtual bool finish(std::string &error) = 0;
+};
+
+std::unique_ptr<ResultSink> make_result_sink(const std::string &format, const std::string &filename, const std::vector<std::string> &strategy_names, std::string &error);
+
+/**
+ * @brief Moves result records from the simulation workers to a sink on a dedicated writer thread.
+ *
+ * Every worker owns one single-producer/single-consumer ring of record
+ * headers and one of their states; the writer thread drains all rings in
+ * batches. Workers never touch the sink.
+ */
+class ResultPipeline
+{
+public:
+    ResultPipeline(ResultSink &sink, int num_producers, size_t ring_capacity, size_t max_state_size, Backpressure backpressure);
+    ~ResultPipeline();
+    ResultPipeline(const ResultPipeline &) = delete;
+    ResultPipeline &operator=(const ResultPipeline &) = delete;
+
+    bool push(int producer, const ResultRecord &record, const int32_t *state);
+    void finish();
+    long long written() const;
+    long long dropped() const;
+    long long rejected() const;
+
+private:
+    void writer_loop();
+    size_t drain(std::vector<ResultRecord> &batch, std::vector<int32_t> &state);
+
+    ResultSink &sink_;
+    Backpressure backpressure_;
+    std::vector<std::unique_ptr<SpscRing<ResultRecord>>> rings_;
+    std::vector<std::unique_ptr<SpscRing<int32_t>>> state_rings_; // The states of the records, in the same order
+    size_t max_state_size_;
+    std::atomic<bool> done_{false};
+    std::atomic<long long> dropped_{0};
+    std::atomic<long long> rejected_{0}; // Records whose state is larger than max_state_size_
+    long long written_ = 0;
+    std::thread writer_;
+};
+
+#endif
@@ -0,0 +1,236 @@
+#include "shared_prefix_tree.h"
+#include "card_tracking.h"
+#include "game_logic.h"
+#include "game_snapshot.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Strategies that still share one game state, and that state
+struct Branch
+{
+    GameSnapshot game;
+    CardTracker cards;
+    std::vector<int> members;            // Indices of the strategies playing this branch
+    std::vector<SnapshotTurnPlan> plans; // Whole-turn plan each strategy is following, by strategy index
+    std::pair<int, int> pending{-2, -2}; // Move already decided by the members when the branch was forked
+};
+
+// Outcome of one strategy on one deck
+struct DeckOutcome
+{
+    bool won = false;
+    int turns = 0;
+};
+
+// Work counters of one deck
+struct TreeCounters
+{
+    long long tree_moves = 0;        // Moves played in the tree
+    long long independent_moves = 0; // Moves the strategies would play one by one
+    long long decisions = 0;         // Decisions of a branch (hand, rows and announcements built once for every member)
+    long long forks = 0;
+    long long first_fork_card = 0;   // Cards played before the first fork (the whole game if none)
+};
+
+/**
+ * @brief Plays every strategy on one deal as a tree of shared game states.
+ *
+ * All strategies start in one branch. At every decision each member of the
+ * branch chooses a move; the members that agree with the first one stay, and
+ * each other group of agreeing members is forked off into a copy of the state
+ * (snapshot, card tracker and the plans of the strategies) to continue on
+ * its own. A move is played once
+ * per branch instead of once per strategy, and what a decision hands to the
+ * strategies (hand, row tops, announcements, move cache) is built once for
+ * all members. Every strategy is still asked at every decision, so the tree
+ * saves the engine's work, not the strategies'. Every strategy sees exactly
+ * the state it would see alone, so the outcomes are those of separate games.
+ */
+void play_tree(const GameConfig &config, const GameSetup &setup, const std::vector<StrategyFunction> &functions, const StrategyParams &params,
+               std::vector<Branch> &stack, std::vector<DeckOutcome> &outcomes, TreeCounters &counters)
+{
+    int num_strategies = functions.size();
+    std::vector<std::pair<int, int>> moves(num_strategies);
+    std::vector<int> stay, others;
+    bool forked = false;
+    static thread_local SnapshotDecision decision; // Hand, rows, announcements and move cache of a decision, built once for all members
+
+    stack.clear();
+    stack.emplace_back();
+    start_snapshot(config, setup, stack.back().game);
+    stack.back().cards.start_game(config, setup.hands, setup.deck.size());
+    stack.back().plans.resize(num_strategies);
+    for (int s = 0; s < num_strategies; ++s)
+    {
+        stack.back().members.push_back(s);
+    }
+
+    while (!stack.empty())
+    {
+        Branch branch = std::move(stack.back());
+        stack.pop_back();
+        while (!branch.game.finished)
+        {
+            std::pair<int, int> move = branch.pending;
+            branch.pending = {-2, -2};
+            if (move.first == -2)
+            {
+                decision.start(config, branch.game, params);
+                for (int s : branch.members)
+                {
+                    moves[s] = decision.decide(functions[s], &branch.cards, branch.plans[s]);
+                }
+                counters.decisions++;
+                move = moves[branch.members[0]];
+                stay.clear();
+                others.clear();
+                for (int s : branch.members)
+                {
+                    (moves[s] == move ? stay : others).push_back(s);
+                }
+                while (!others.empty())
+                {
+                    // Group the members that agree with the first remaining one into a new branch
+                    Branch fork{branch.game, branch.cards, {}, branch.plans, moves[others[0]]};
+                    std::vector<int> rest;
+                    for (int s : others)
+                    {
+                        (moves[s] == fork.pending ? fork.members : rest).push_back(s);
+                    }
+                    stack.push_back(std::move(fork));
+                    others.swap(rest);
+                    counters.forks++;
+                    if (!forked)
+                    {
+                        forked = true;
+                        counters.first_fork_card = branch.game.turns;
+                    }
+                }
+                branch.members = stay;
+            }
+            apply_snapshot_move(config, branch.game, move, &branch.cards);
+            counters.tree_moves++;
+            counters.independent_moves += branch.members.size();
+        }
+        for (int s : branch.members)
+        {
+            outcomes[s] = {branch.game.won, branch.game.turns};
+        }
+        if (!forked)
+        {
+            counters.first_fork_card = branch.game.turns;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Simulates every strategy on the same deals as one tree per deal, and checks it against separate games.
+ *
+ * The strategies share the game state as long as they choose the same moves
+ * (see play_tree). Every deal is then played again with the regular engine,
+ * once per strategy, and the outcomes (won, cards played) are compared. The
+ * report gives the win rates, the moves and decisions of the tree against the
+ * moves of separate games, and the wall-clock time of both: the saving that
+ * counts is the time, since strategies are asked as often in the tree.
+ *
+ * @param config The game config.
+ * @param strategies The strategies to simulate, by name.
+ * @param num_games The number of deals.
+ * @param num_threads The number of worker threads.
+ */
+void run_shared_prefix(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, int num_threads)
+{
+    std::string error;
+    if (!check_snapshot_capacity(config, config.number_of_players, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return;
+    }
+    std::vector<std::string> names;
+    std::vector<StrategyFunction> functions;
+    for (auto const &[name, func] : strategies)
+    {
+        names.push_back(name);
+        functions.push_back(func);
+    }
+    int num_strategies = functions.size();
+
+    std::vector<int> initial_deck = create_deck(config);
+    std::vector<GameSetup> setups(num_games);
+    for (int game = 0; game < num_games; ++game)
+    {
+        std::vector<int> deck = initial_deck;
+        shuffle(deck);
+        setups[game] = setup_game(config, config.number_of_players, deck);
+    }
+    StrategyParams params = default_strategy_params(config);
+
+    // --- Tree of shared prefixes ---
+    std::vector<std::vector<DeckOutcome>> tree_outcomes(num_games, std::vector<DeckOutcome>(num_strategies));
+    std::vector<TreeCounters> counters(num_games);
+    auto start = std::chrono::steady_clock::now();
+    parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+        std::vector<Branch> stack;
+        for (int game = begin; game < end; ++game)
+        {
+            play_tree(config, setups[game], functions, params, stack, tree_outcomes[game], counters[game]);
+        }
+    });
+    double tree_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // --- The same deals, one game per strategy with the regular engine ---
+    std::vector<std::vector<DeckOutcome>> outcomes(num_games, std::vector<DeckOutcome>(num_strategies));
+    start = std::chrono::steady_clock::now();
+    parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+        std::vector<std::vector<int>> final_rows, final_hands;
+        for (int game = begin; game < end; ++game)
+        {
+            for (int s = 0; s < num_strategies; ++s)
+            {
+                std::vector<StrategyFunction> seats(config.number_of_players, functions[s]);
+                DeckOutcome &outcome = outcomes[game][s];
+                outcome.won = simulate_game_multiplayer(config, seats, setups[game], params, outcome.turns, final_rows, final_hands);
+            }
+        }
+    });
+    double independent_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TreeCounters total;
+    int mismatches = 0;
+    std::vector<int> wins(num_strategies, 0);
+    for (int game = 0; game < num_games; ++game)
+    {
+        total.tree_moves += counters[game].tree_moves;
+        total.independent_moves += counters[game].independent_moves;
+        total.decisions += counters[game].decisions;
+        total.forks += counters[game].forks;
+        total.first_fork_card += counters[game].first_fork_card;
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            const DeckOutcome &tree = tree_outcomes[game][s], &alone = outcomes[game][s];
+            wins[s] += tree.won;
+            mismatches += tree.won != alone.won || tree.turns != alone.turns;
+        }
+    }
+
+    std::cout << "Shared-prefix simulation, " << config.number_of_players << " Players, " << num_games << " decks, "
+              << num_strategies << " strategies:\n";
+    for (int s = 0; s < num_strategies; ++s)
+    {
+        std::cout << names[s] << " win rate: " << 100.0 * wins[s] / num_games << " %\n";
+    }
+    std::cout << "Moves: " << total.tree_moves << " in the tree (" << total.decisions << " shared decisions), " << total.independent_moves
+              << " one strategy at a time (every strategy decides every move either way), " << static_cast<double>(total.forks) / num_games
+              << " forks per deck, first fork after " << static_cast<double>(total.first_fork_card) / num_games << " cards on average\n";
+    std::cout << "Time: tree " << tree_seconds << " s, separate games " << independent_seconds << " s (tree "
+              << (tree_seconds > 0 ? independent_seconds / tree_seconds : 0.0) << "x as fast)\n";
+    std::cout << "Outcomes differing from separate games: " << mismatches << " of " << num_games * num_strategies << "\n";
+}
@@ -0,0 +1,12 @@
+#ifndef SHARED_PREFIX_TREE_H
+#define SHARED_PREFIX_TREE_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+void run_shared_prefix(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_games, int num_threads);
+
+#endif
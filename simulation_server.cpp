@@ -0,0 +1,599 @@
+#include "simulation_server.h"
+#include "game_logic.h"
+#include "helper_functions.h"
+#include "job_spec.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int JOB_CHUNK_GAMES = 64;            // Games of a job played by one queued task
+const size_t MAX_CORPUS_ENTRIES = 32;      // (deck size, seed) pairs kept in the deck corpus
+const size_t MAX_JOB_LINE = 1024 * 1024;   // Longest accepted job line
+
+// One client connection. The socket is closed once the reader and every job of the connection are done.
+class Connection
+{
+public:
+    explicit Connection(int fd) : fd_(fd) {}
+    ~Connection() { close(fd_); }
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    int fd() const { return fd_; }
+
+    // Writes one answer line; answers to a client that went away are dropped
+    void send_line(const std::string &line)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t written = send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                return;
+            }
+            sent += written;
+        }
+    }
+
+private:
+    int fd_;
+    std::mutex mutex_; // Answers of different jobs never interleave
+};
+
+using DeckList = std::vector<std::vector<int>>;
+
+/**
+ * @brief Shuffled decks by (deck size, seed), shared by the jobs of the daemon.
+ *
+ * A sweep sends many jobs with one seed (other strategies, other player
+ * counts); they all play the decks shuffled for the first one. At most
+ * max_decks decks of a seed are kept, so a large job cannot fill the memory:
+ * its later decks are shuffled as they are played. The least recently used
+ * seeds are dropped beyond MAX_CORPUS_ENTRIES.
+ */
+class DeckCorpus
+{
+public:
+    explicit DeckCorpus(int max_decks) : max_decks_(max_decks) {}
+
+    // The first min(count, max_decks) decks of a seed
+    std::shared_ptr<const DeckList> decks(int card_max_number, uint64_t seed, int count)
+    {
+        count = std::min(count, max_decks_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry &entry = entries_[{card_max_number, seed}];
+        entry.last_use = ++uses_;
+        if (!entry.decks || static_cast<int>(entry.decks->size()) < count)
+        {
+            // Jobs still playing the shorter list keep their own reference to it
+            auto grown = std::make_shared<DeckList>(entry.decks ? *entry.decks : DeckList());
+            for (int game = grown->size(); game < count; ++game)
+            {
+                grown->push_back(seeded_deck(card_max_number, seed, game));
+            }
+            entry.decks = grown;
+        }
+        std::shared_ptr<const DeckList> found = entry.decks;
+
+        while (entries_.size() > MAX_CORPUS_ENTRIES)
+        {
+            auto oldest = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it)
+            {
+                if (it->second.last_use < oldest->second.last_use)
+                {
+                    oldest = it;
+                }
+            }
+            entries_.erase(oldest);
+        }
+        return found;
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const DeckList> decks;
+        long long last_use = 0;
+    };
+    int max_decks_;
+    std::mutex mutex_;
+    std::map<std::pair<int, uint64_t>, Entry> entries_;
+    long long uses_ = 0;
+};
+
+// A job accepted by the daemon, shared by its queued chunks
+struct ServerJob
+{
+    JobSpec spec;
+    long long sequence = 0; // Arrival order
+    std::vector<std::string> strategy_names;
+    std::vector<std::vector<StrategyFunction>> seat_strategies; // Per strategy, every seat using it
+    std::shared_ptr<const DeckList> decks; // The first decks of the seed (see DeckCorpus), or nullptr
+    std::shared_ptr<Connection> connection;
+    std::chrono::steady_clock::time_point queued_at;
+
+    std::mutex mutex; // Guards the totals below
+    std::vector<long long> wins;
+    std::vector<long long> cards;
+    int chunks_left = 0;
+};
+
+struct QueuedChunk
+{
+    std::shared_ptr<ServerJob> job;
+    int begin;
+    int end;
+};
+
+// Priority queue order: true when a runs after b
+struct ChunkOrder
+{
+    bool operator()(const QueuedChunk &a, const QueuedChunk &b) const
+    {
+        if (a.job->spec.priority != b.job->spec.priority)
+        {
+            return a.job->spec.priority < b.job->spec.priority;
+        }
+        if (a.job->sequence != b.job->sequence)
+        {
+            return a.job->sequence > b.job->sequence;
+        }
+        return a.begin > b.begin;
+    }
+};
+
+/**
+ * @brief The simulation daemon: a socket, a priority queue of job chunks and a pool of warm workers.
+ */
+class SimulationServer
+{
+public:
+    SimulationServer(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, int num_threads)
+        : config_(config), strategies_(strategies), num_threads_(num_threads), corpus_(config.num_simulations)
+    {
+    }
+
+    int run(const std::string &socket_path);
+
+private:
+    const GameConfig &config_;
+    const std::map<std::string, StrategyFunction> &strategies_;
+    int num_threads_;
+    DeckCorpus corpus_;
+    int listen_fd_ = -1;
+
+    std::mutex mutex_; // Guards everything below
+    std::condition_variable changed_;
+    std::priority_queue<QueuedChunk, std::vector<QueuedChunk>, ChunkOrder> queue_;
+    long long next_sequence_ = 0;
+    bool stopping_ = false;
+    int readers_ = 0;
+    std::vector<std::weak_ptr<Connection>> connections_;
+
+    void worker_loop();
+    void reader_loop(std::shared_ptr<Connection> connection);
+    void handle_line(const std::string &line, const std::shared_ptr<Connection> &connection);
+    void play_chunk(const QueuedChunk &chunk);
+    void send_result(ServerJob &job);
+    void stop();
+};
+
+/**
+ * @brief Listens on the socket until a shutdown job, then finishes the queue and returns.
+ */
+int SimulationServer::run(const std::string &socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: Socket path too long: " << socket_path << "\n";
+        return 1;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+    {
+        std::cerr << "Error: Cannot create a socket: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    // A socket file left by a daemon that is gone is replaced; a live daemon is not
+    struct stat status;
+    if (stat(socket_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+    {
+        if (connect(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+        {
+            std::cerr << "Error: A daemon is already listening on " << socket_path << "\n";
+            close(listen_fd_);
+            return 1;
+        }
+        close(listen_fd_);
+        unlink(socket_path.c_str());
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listen_fd_, 64) != 0)
+    {
+        std::cerr << "Error: Cannot listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+        close(listen_fd_);
+        return 1;
+    }
+
+    // Warm-up: the decks of the default config are shuffled before the first job arrives
+    corpus_.decks(config_.card_max_number, 0, config_.num_simulations);
+    std::cout << "Listening on " << socket_path << " with " << num_threads_ << " workers, "
+              << strategies_.size() << " strategies, " << config_.num_simulations << " decks of seed 0 ready\n"
+              << std::flush;
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < num_threads_; ++w)
+    {
+        workers.emplace_back(&SimulationServer::worker_loop, this);
+    }
+
+    while (true)
+    {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break; // The listening socket was shut down by a shutdown job
+        }
+        auto connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_)
+        {
+            break;
+        }
+        connections_.push_back(connection);
+        readers_++;
+        std::thread(&SimulationServer::reader_loop, this, connection).detach();
+    }
+    stop();
+
+    // Workers leave once the queue is empty; readers are woken up by closing their read side
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto &weak : connections_)
+        {
+            if (auto connection = weak.lock())
+            {
+                shutdown(connection->fd(), SHUT_RD);
+            }
+        }
+        changed_.wait(lock, [&] { return readers_ == 0; });
+    }
+    close(listen_fd_);
+    unlink(socket_path.c_str());
+    std::cout << "Daemon stopped\n";
+    return 0;
+}
+
+void SimulationServer::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopping_)
+    {
+        stopping_ = true;
+        shutdown(listen_fd_, SHUT_RDWR); // Wakes up accept
+    }
+    changed_.notify_all();
+}
+
+// Reads job lines from one client until it closes its side
+void SimulationServer::reader_loop(std::shared_ptr<Connection> connection)
+{
+    char buffer[4096];
+    std::string pending;
+    while (true)
+    {
+        ssize_t received = recv(connection->fd(), buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            break;
+        }
+        pending.append(buffer, received);
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos)
+        {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            handle_line(line, connection);
+        }
+        if (pending.size() > MAX_JOB_LINE)
+        {
+            connection->send_line("{\"status\":\"error\",\"message\":\"job line too long\"}");
+            break;
+        }
+    }
+    if (!pending.empty())
+    {
+        handle_line(pending, connection);
+    }
+
+    connection.reset(); // The jobs keep the connection open until their results are sent
+    std::lock_guard<std::mutex> lock(mutex_);
+    readers_--;
+    changed_.notify_all();
+}
+
+void SimulationServer::handle_line(const std::string &line, const std::shared_ptr<Connection> &connection)
+{
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+        return;
+    }
+    auto job = std::make_shared<ServerJob>();
+    std::string error;
+    if (!parse_job_spec(line, config_, job->spec, error))
+    {
+        connection->send_line("{\"id\":\"" + json_escape(job->spec.id) + "\",\"status\":\"error\",\"message\":\"" + json_escape(error) + "\"}");
+        return;
+    }
+    JobSpec &spec = job->spec;
+    if (spec.shutdown)
+    {
+        connection->send_line("{\"id\":\"" + json_escape(spec.id) + "\",\"status\":\"shutting down\"}");
+        stop();
+        return;
+    }
+
+    job->strategy_names = spec.strategies;
+    if (job->strategy_names.empty())
+    {
+        for (auto const &[name, func] : strategies_)
+        {
+            job->strategy_names.push_back(name);
+        }
+    }
+    for (const auto &name : job->strategy_names)
+    {
+        auto it = strategies_.find(name);
+        if (it == strategies_.end())
+        {
+            connection->send_line("{\"id\":\"" + json_escape(spec.id) + "\",\"status\":\"error\",\"message\":\"unknown strategy " + json_escape(name) + "\"}");
+            return;
+        }
+        job->seat_strategies.push_back(std::vector<StrategyFunction>(spec.config.number_of_players, it->second));
+    }
+    if (!spec.seeded)
+    {
+        std::random_device rd;
+        spec.seed = ((static_cast<uint64_t>(rd()) << 32) | rd()) >> 1; // Reported, so the job can be replayed
+    }
+    else
+    {
+        job->decks = corpus_.decks(spec.config.card_max_number, spec.seed, spec.num_games);
+    }
+    job->connection = connection;
+    job->wins.assign(job->strategy_names.size(), 0);
+    job->cards.assign(job->strategy_names.size(), 0);
+    job->chunks_left = (spec.num_games + JOB_CHUNK_GAMES - 1) / JOB_CHUNK_GAMES;
+    job->queued_at = std::chrono::steady_clock::now();
+
+    connection->send_line("{\"id\":\"" + json_escape(spec.id) + "\",\"status\":\"queued\",\"games\":" + std::to_string(spec.num_games) +
+                          ",\"seed\":" + std::to_string(spec.seed) + "}");
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_)
+        {
+            job->sequence = next_sequence_++;
+            for (int begin = 0; begin < spec.num_games; begin += JOB_CHUNK_GAMES)
+            {
+                queue_.push({job, begin, std::min(begin + JOB_CHUNK_GAMES, spec.num_games)});
+            }
+            changed_.notify_all();
+            return;
+        }
+    }
+    connection->send_line("{\"id\":\"" + json_escape(spec.id) + "\",\"status\":\"error\",\"message\":\"the daemon is shutting down\"}");
+}
+
+void SimulationServer::worker_loop()
+{
+    while (true)
+    {
+        QueuedChunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return !queue_.empty() || stopping_; });
+            if (queue_.empty())
+            {
+                return; // Stopping and nothing left to play
+            }
+            chunk = queue_.top();
+            queue_.pop();
+        }
+        play_chunk(chunk);
+    }
+}
+
+void SimulationServer::play_chunk(const QueuedChunk &chunk)
+{
+    ServerJob &job = *chunk.job;
+    const GameConfig &config = job.spec.config;
+    StrategyParams params = default_strategy_params(config);
+    const int num_strategies = job.seat_strategies.size();
+    std::vector<long long> wins(num_strategies, 0), cards(num_strategies, 0);
+    std::vector<std::vector<int>> final_playing_rows;
+    std::vector<std::vector<int>> final_hand;
+
+    for (int game = chunk.begin; game < chunk.end; ++game)
+    {
+        bool kept = job.decks && game < static_cast<int>(job.decks->size());
+        std::vector<int> deck = kept ? (*job.decks)[game] : seeded_deck(config.card_max_number, job.spec.seed, game);
+        std::mt19937_64 order_rng = seat_order_rng(job.spec.seed, game);
+        GameSetup setup = setup_game(config, config.number_of_players, deck, order_rng);
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            int turns = 0;
+            wins[s] += simulate_game_multiplayer(config, job.seat_strategies[s], setup, params, turns, final_playing_rows, final_hand);
+            cards[s] += turns;
+        }
+    }
+
+    bool last_chunk;
+    {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            job.wins[s] += wins[s];
+            job.cards[s] += cards[s];
+        }
+        last_chunk = --job.chunks_left == 0;
+    }
+    if (last_chunk)
+    {
+        send_result(job);
+    }
+}
+
+// One answer line with the win rate and average cards played of every strategy of the job
+void SimulationServer::send_result(ServerJob &job)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.queued_at).count();
+    int games = job.spec.num_games;
+    std::ostringstream line;
+    line << "{\"id\":\"" << json_escape(job.spec.id) << "\",\"status\":\"done\",\"games\":" << games
+         << ",\"players\":" << job.spec.config.number_of_players << ",\"seed\":" << job.spec.seed
+         << ",\"seconds\":" << seconds << ",\"results\":[";
+    for (size_t s = 0; s < job.strategy_names.size(); ++s)
+    {
+        line << (s > 0 ? "," : "") << "{\"strategy\":\"" << json_escape(job.strategy_names[s]) << "\",\"wins\":" << job.wins[s]
+             << ",\"win_rate\":" << 100.0 * job.wins[s] / games << ",\"average_cards\":" << static_cast<double>(job.cards[s]) / games << "}";
+    }
+    line << "]}";
+    job.connection->send_line(line.str());
+    job.connection.reset(); // Last chunk of the job: nothing else will write
+}
+
+} // namespace
+
+/**
+ * @brief Runs the simulation daemon on a Unix domain socket (serve mode).
+ *
+ * Clients send one JSON job per line (see JobSpec) and get JSON lines back:
+ * "queued" when a job is accepted, "done" with the results when its last game
+ * is played, or "error". Jobs are split into chunks of JOB_CHUNK_GAMES games
+ * on one priority queue (higher priority first, then arrival order), played by
+ * a fixed pool of worker threads. The strategies are resolved once, and the
+ * decks of every seed are shuffled once and kept, so a job costs nothing
+ * more than its games. {"shutdown": true} stops the daemon once the queued
+ * jobs are done.
+ *
+ * @param config The default rules of the jobs.
+ * @param strategies The available strategies, by name.
+ * @param socket_path The socket file to listen on.
+ * @param num_threads The number of worker threads.
+ * @return 0 after a shutdown, 1 if the socket cannot be set up.
+ */
+int run_simulation_server(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &socket_path, int num_threads)
+{
+    SimulationServer server(config, strategies, num_threads);
+    return server.run(socket_path);
+}
+
+/**
+ * @brief Sends the job lines of the standard input to the daemon and prints its answers (submit mode).
+ *
+ * Answers are printed as they arrive, while the jobs are still being sent.
+ * Returns once the daemon has answered every job of the connection.
+ *
+ * @param socket_path The socket file of the daemon.
+ * @return 0 if the daemon was reached, 1 otherwise.
+ */
+int run_job_client(const std::string &socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: Socket path too long: " << socket_path << "\n";
+        return 1;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        std::cerr << "Error: Cannot connect to " << socket_path << " (is 'the_game serve' running?)\n";
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return 1;
+    }
+
+    std::thread printer([fd] {
+        char buffer[4096];
+        ssize_t received;
+        while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0 || (received < 0 && errno == EINTR))
+        {
+            if (received > 0)
+            {
+                std::cout.write(buffer, received);
+                std::cout.flush();
+            }
+        }
+    });
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        line += "\n";
+        size_t sent = 0;
+        while (sent < line.size())
+        {
+            ssize_t written = send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                break;
+            }
+            sent += written;
+        }
+    }
+    shutdown(fd, SHUT_WR); // No more jobs: the daemon closes the connection after the last answer
+    printer.join();
+    close(fd);
+    return 0;
+}
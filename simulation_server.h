@@ -0,0 +1,13 @@
+#ifndef SIMULATION_SERVER_H
+#define SIMULATION_SERVER_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+int run_simulation_server(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const std::string &socket_path, int num_threads);
+int run_job_client(const std::string &socket_path);
+
+#endif
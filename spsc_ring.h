@@ -0,0 +1,87 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * The producer only writes head_ and the consumer only writes tail_, so each
+ * side needs a single acquire load of the other's index and a release store
+ * of its own. The indices live on separate cache lines to avoid false sharing.
+ * The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // Producer side: false when the ring is full
+    bool try_push(const T &item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == slots_.size())
+        {
+            return false;
+        }
+        slots_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: pushes all count items, or none (false) when they do not fit
+    bool try_push(const T *items, size_t count)
+    {
+        if (!has_room(count))
+        {
+            return false;
+        }
+        size_t head = head_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots_[(head + i) & mask_] = items[i];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: whether count more items fit (room only grows until the producer pushes)
+    bool has_room(size_t count) const
+    {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire) + count <= slots_.size();
+    }
+
+    // Consumer side: copies up to max_items items to out, returns how many
+    size_t pop_batch(T *out, size_t max_items)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t available = head_.load(std::memory_order_acquire) - tail;
+        size_t count = available < max_items ? available : max_items;
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = slots_[(tail + i) & mask_];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to write (producer)
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to read (consumer)
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef STRATEGY_PLUGIN_H
+#define STRATEGY_PLUGIN_H
+
+/*
+ * C ABI of strategy plugins (shared objects loaded with --strategy-lib).
+ *
+ * A plugin exports one function, thegame_get_plugin, returning a static
+ * thegame_plugin table. The simulator calls init once with the game rules,
+ * then decide_batch with many decision requests at once (from many games
+ * played in lockstep, or a single one from the regular engine), so the call
+ * overhead is spread over the batch.
+ *
+ * Only plain C types cross the boundary; every pointer handed to the plugin
+ * is only valid during the call. Bump THEGAME_PLUGIN_ABI_VERSION on any
+ * change of these structures.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define THEGAME_PLUGIN_ABI_VERSION 1
+
+/* Rules of the game, fixed for the whole run */
+typedef struct
+{
+    int32_t card_max_number;   /* Cards go from 2 to card_max_number - 1 */
+    int32_t reverse_move_diff; /* Difference of a reverse trick */
+    int32_t number_of_rows;    /* Rows 0 .. n/2-1 ascend, the others descend */
+    int32_t card_in_hands;
+    int32_t num_cards_to_play; /* Per turn while the deck is not empty */
+    int32_t good_move_window;  /* GOOD_MOVE_WINDOW of the configuration */
+} thegame_rules;
+
+/* Strategy parameters, same meaning as StrategyParams */
+typedef struct
+{
+    int32_t claimed_row_penalty;
+    int32_t panic_threshold;
+    int32_t good_move_window;
+} thegame_params;
+
+/* What a player announced this turn */
+typedef struct
+{
+    int32_t player_id;
+    int32_t row_index;
+    int32_t type; /* 0 = good card, 1 = reverse trick */
+    int32_t relative_value;
+} thegame_communication;
+
+/* The state a strategy decides on */
+typedef struct
+{
+    const int32_t *hand;
+    int32_t hand_size;
+    const int32_t *row_tops; /* number_of_rows top cards */
+    const thegame_communication *communications;
+    int32_t num_communications;
+    int32_t player_id;
+} thegame_decision_request;
+
+/* Index of the card in the hand and row to play it on, or -1, -1 when no move is valid */
+typedef struct
+{
+    int32_t card_index;
+    int32_t row_index;
+} thegame_decision;
+
+typedef struct
+{
+    uint32_t abi_version; /* THEGAME_PLUGIN_ABI_VERSION the plugin was built with */
+    const char *name;
+    int32_t num_strategies;
+    const char *const *strategy_names;
+    /* Returns 0 on success */
+    int32_t (*init)(const thegame_rules *rules);
+    /* Fills decisions[i] for requests[i], i < count, with strategy number `strategy` */
+    void (*decide_batch)(int32_t strategy, const thegame_params *params, const thegame_decision_request *requests,
+                         int32_t count, thegame_decision *decisions);
+} thegame_plugin;
+
+typedef const thegame_plugin *(*thegame_get_plugin_fn)(void);
+
+#define THEGAME_PLUGIN_ENTRY "thegame_get_plugin"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+#include "strategy_registry.h"
+#include "endgame_tablebase.h"
+#include "learned_policy.h"
+#include "turn_planning.h"
+#include "weighted_strategy.h"
+
+namespace {
+
+// Hashes of the sources behind the moves, set by the Makefile: a change to
+// one of these files gives new result cache keys, with nothing to bump by
+// hand. Every strategy goes through the shared sources (engine, move checks,
+// move features and the strategies of player_strategies.cpp); the others
+// add the file they live in.
+#if !defined(SHARED_SOURCE_HASH) || !defined(WEIGHTED_SOURCE_HASH) || !defined(PLANNING_SOURCE_HASH) || !defined(POLICY_SOURCE_HASH) || !defined(TABLEBASE_SOURCE_HASH)
+#error "build with the Makefile, which hashes the sources of the strategies"
+#endif
+const uint64_t NO_OWN_SOURCES = 0;
+const std::map<std::string, uint64_t> STRATEGY_SOURCE_HASHES = {
+    {"A1", NO_OWN_SOURCES},       {"A2", NO_OWN_SOURCES},       {"B", WEIGHTED_SOURCE_HASH},  {"C", WEIGHTED_SOURCE_HASH},
+    {"D", WEIGHTED_SOURCE_HASH},  {"E1", NO_OWN_SOURCES},       {"E2", NO_OWN_SOURCES},       {"F", WEIGHTED_SOURCE_HASH},
+    {"G", WEIGHTED_SOURCE_HASH},  {"H1", NO_OWN_SOURCES},       {"H2", NO_OWN_SOURCES},       {"I", WEIGHTED_SOURCE_HASH},
+    {"J", NO_OWN_SOURCES},        {"K", PLANNING_SOURCE_HASH},  {"L", POLICY_SOURCE_HASH},    {"T", TABLEBASE_SOURCE_HASH},
+};
+
+uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+/**
+ * @brief The strategies built into the simulator, by the name used on the command line and in reports.
+ *
+ * @return A map from strategy name to strategy function.
+ */
+std::map<std::string, StrategyFunction> builtin_strategies()
+{
+    std::map<std::string, StrategyFunction> strategies;
+    strategies["A1"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_A1(hand, playing_rows, comms, player_id, context);
+    }; // Strategy A: Closest Card
+    strategies["A2"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_A2(hand, playing_rows, comms, player_id, context);
+    }; // Strategy A: Closest Card
+
+    strategies["E1"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_E1(hand, playing_rows, comms, player_id, context);
+    }; // Strategy E: Combination of C and A
+    strategies["E2"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_E2(hand, playing_rows, comms, player_id, context);
+    }; // Strategy E: Combination of C and A
+
+    strategies["H1"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_H1(hand, playing_rows, comms, player_id, context);
+    }; // Strategy H: Panic Mode
+    strategies["H2"] = [](const Hand &hand, const PlayingRows &playing_rows, const Communications &comms, int player_id, const StrategyContext& context) {
+        return get_player_move_H2(hand, playing_rows, comms, player_id, context);
+    }; // Strategy H: Panic Mode
+
+    strategies["J"] = get_player_move_J; // Strategy J: Skip the Fewest Cards Still in Play (card tracker)
+    strategies["K"] = get_player_move_K; // Strategy K: Best Sequence for the Whole Turn
+    strategies["L"] = get_player_move_L; // Strategy L: Learned Linear Policy (weights from --policy)
+    strategies["T"] = get_player_move_T; // Strategy T: Perfect Endgame from the Tablebase (J without one)
+
+    // Feature-weighted presets (see weighted_strategy.cpp)
+    strategies["B"] = get_player_move_B; // Strategy B: Closest Card (No Reverse)
+    strategies["C"] = get_player_move_C; // Strategy C: Maximize Future Playability
+    strategies["D"] = get_player_move_D; // Strategy D: Avoid Blocking Own Cards
+    strategies["F"] = get_player_move_F; // Strategy F: Maximize Minimum Gap
+    strategies["G"] = get_player_move_G; // Strategy G: Weighted Combination of A, C, and F
+    strategies["I"] = get_player_move_I; // Strategy I: Keep Rows Open, Prefer Reverse Tricks
+    return strategies;
+}
+
+/**
+ * @brief Version hash of a built-in strategy: its name, its code version and what it was loaded with.
+ *
+ * The code version is the hash of the sources behind its moves (see
+ * STRATEGY_SOURCE_HASHES). Also covers the weights of L (--policy) and the
+ * checksum of T's tablebase (--tablebase), which change their moves without
+ * a code change.
+ *
+ * @param name The strategy name.
+ * @return The hash, or 0 if the strategy is not built in (plugins are never cached).
+ */
+uint64_t strategy_version_hash(const std::string &name)
+{
+    auto sources = STRATEGY_SOURCE_HASHES.find(name);
+    if (sources == STRATEGY_SOURCE_HASHES.end())
+    {
+        return 0;
+    }
+    uint64_t hash = fnv1a(14695981039346656037ULL, name.data(), name.size());
+    uint64_t source_hashes[2] = {SHARED_SOURCE_HASH, sources->second};
+    hash = fnv1a(hash, source_hashes, sizeof(source_hashes));
+    if (name == "L")
+    {
+        const PolicyWeights &weights = get_strategy_policy();
+        hash = fnv1a(hash, weights.weights, sizeof(weights.weights));
+    }
+    if (name == "T" && get_strategy_tablebase() != nullptr)
+    {
+        uint64_t checksum = get_strategy_tablebase()->checksum();
+        hash = fnv1a(hash, &checksum, sizeof(checksum));
+    }
+    return hash | 1;
+}
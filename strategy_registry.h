@@ -0,0 +1,13 @@
+#ifndef STRATEGY_REGISTRY_H
+#define STRATEGY_REGISTRY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "player_strategies.h"
+
+std::map<std::string, StrategyFunction> builtin_strategies();
+uint64_t strategy_version_hash(const std::string &name);
+
+#endif
@@ -0,0 +1,284 @@
+#include "strategy_tuning.h"
+#include "game_logic.h"
+#include "game_config.h"
+#include "helper_functions.h"
+#include "parallel.h"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+const double CI_Z = 1.96;     // 95% confidence intervals in the report
+const double RACING_Z = 2.58; // 99% one-sided test before dropping a candidate (many comparisons per batch)
+
+// A point of the parameter grid together with its per-deck outcomes.
+struct Candidate
+{
+    StrategyParams params;
+    std::vector<float> outcomes; // One value per shared deck: 1/0 win, or cards played
+    bool alive = true;
+};
+
+double mean_of(const std::vector<float> &values)
+{
+    double sum = 0.0;
+    for (float v : values)
+    {
+        sum += v;
+    }
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+/**
+ * @brief Builds the parameter grid for a strategy, varying only the parameters it reads.
+ *
+ * A1 and E1 read the claimed-row penalty and the good-move window, H1 reads
+ * those plus the panic threshold (it falls back to E1), H2 only reads the
+ * panic threshold. The configured good-move window is always part of the grid
+ * so the current defaults compete too.
+ */
+std::vector<Candidate> build_candidates(const GameConfig &config, const std::string &strategy_name)
+{
+    bool uses_claims = strategy_name == "A1" || strategy_name == "E1" || strategy_name == "H1";
+    bool uses_panic = strategy_name == "H1" || strategy_name == "H2";
+
+    StrategyParams defaults = default_strategy_params(config);
+    std::vector<int> penalties = uses_claims ? std::vector<int>{1, 10, 100, 1000} : std::vector<int>{defaults.claimed_row_penalty};
+    std::vector<int> thresholds = uses_panic ? std::vector<int>{0, 1, 2, 3, 4} : std::vector<int>{defaults.panic_threshold};
+    std::vector<int> windows = {defaults.good_move_window};
+    if (uses_claims)
+    {
+        windows = {2, 3, 5, 7, 10};
+        if (std::find(windows.begin(), windows.end(), config.good_move_window) == windows.end())
+        {
+            windows.push_back(config.good_move_window);
+        }
+    }
+
+    std::vector<Candidate> candidates;
+    for (int penalty : penalties)
+    {
+        for (int threshold : thresholds)
+        {
+            for (int window : windows)
+            {
+                Candidate candidate;
+                candidate.params.claimed_row_penalty = penalty;
+                candidate.params.panic_threshold = threshold;
+                candidate.params.good_move_window = window;
+                candidates.push_back(candidate);
+            }
+        }
+    }
+    return candidates;
+}
+
+void print_params(const StrategyParams &params)
+{
+    std::cout << "penalty=" << params.claimed_row_penalty
+              << " panic=" << params.panic_threshold
+              << " window=" << params.good_move_window;
+}
+
+} // namespace
+
+/**
+ * @brief Searches the strategy parameter grid with racing inside successive-halving rungs.
+ *
+ * All live candidates play the same decks and seat orders, so candidates are
+ * compared on paired outcomes. After every batch, a candidate that has played
+ * at least min_decks decks is dropped when its paired difference to the
+ * current leader is negative with 99% confidence (racing). At the end of each
+ * rung the worse half of the survivors is dropped (successive halving), so the
+ * budget concentrates on the contenders. Batches are simulated in parallel.
+ *
+ * @param config The game config.
+ * @param strategies The available strategies, by name.
+ * @param options The tuning settings.
+ */
+void run_strategy_tuning(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const TuningOptions &options)
+{
+    auto strategy_it = strategies.find(options.strategy_name);
+    if (strategy_it == strategies.end())
+    {
+        std::cerr << "Error: Unknown strategy '" << options.strategy_name << "'\n";
+        return;
+    }
+    std::vector<Candidate> candidates = build_candidates(config, options.strategy_name);
+    if (candidates.size() < 2)
+    {
+        std::cerr << "Error: Strategy " << options.strategy_name << " has no tunable parameters\n";
+        return;
+    }
+
+    std::vector<StrategyFunction> seat_strategies(options.num_players, strategy_it->second);
+    std::vector<int> initial_deck = create_deck(config);
+
+    int rungs = std::max(1, static_cast<int>(std::ceil(std::log2(static_cast<double>(candidates.size())))));
+    long long rung_budget = options.budget / rungs;
+    long long spent = 0;
+    int decks_played = 0;
+
+    std::cout << "Tuning " << options.strategy_name << " for " << options.num_players << " players: "
+              << candidates.size() << " candidates, budget " << options.budget << " games, "
+              << rungs << " rungs, racing on " << (options.race_on_cards ? "cards played" : "wins") << "\n";
+
+    for (int rung = 0; rung < rungs; ++rung)
+    {
+        std::vector<int> alive;
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            if (candidates[c].alive)
+            {
+                alive.push_back(c);
+            }
+        }
+        if (alive.size() < 2)
+        {
+            break;
+        }
+
+        // The last rung gets whatever budget is left
+        long long this_rung_budget = (rung == rungs - 1) ? options.budget - spent : rung_budget;
+        long long rung_decks = this_rung_budget / static_cast<long long>(alive.size());
+        int dropped_by_racing = 0;
+
+        for (long long rung_played = 0; rung_played < rung_decks && alive.size() > 1;)
+        {
+            int batch = static_cast<int>(std::min<long long>(options.batch_size, rung_decks - rung_played));
+
+            // Deal the batch once; every live candidate plays the same setups
+            std::vector<GameSetup> setups;
+            setups.reserve(batch);
+            for (int d = 0; d < batch; ++d)
+            {
+                std::vector<int> game_deck = initial_deck;
+                shuffle(game_deck);
+                setups.push_back(setup_game(config, options.num_players, game_deck));
+            }
+            for (int c : alive)
+            {
+                candidates[c].outcomes.resize(decks_played + batch);
+            }
+
+            parallel_for_chunks(batch, options.num_threads, [&](int begin, int end, int) {
+                std::vector<std::vector<int>> final_playing_rows;
+                std::vector<std::vector<int>> final_hand;
+                for (int d = begin; d < end; ++d)
+                {
+                    for (int c : alive)
+                    {
+                        int turns = 0;
+                        bool won = simulate_game_multiplayer(config, seat_strategies, setups[d], candidates[c].params, turns, final_playing_rows, final_hand);
+                        candidates[c].outcomes[decks_played + d] = options.race_on_cards ? static_cast<float>(turns) : (won ? 1.0f : 0.0f);
+                    }
+                }
+            });
+
+            decks_played += batch;
+            rung_played += batch;
+            spent += static_cast<long long>(batch) * alive.size();
+
+            // --- Racing: drop candidates clearly worse than the leader on the paired decks ---
+            if (decks_played >= options.min_decks)
+            {
+                int leader = alive[0];
+                for (int c : alive)
+                {
+                    if (mean_of(candidates[c].outcomes) > mean_of(candidates[leader].outcomes))
+                    {
+                        leader = c;
+                    }
+                }
+                for (int c : alive)
+                {
+                    if (c == leader)
+                    {
+                        continue;
+                    }
+                    double sum = 0.0, sum_sq = 0.0;
+                    for (int d = 0; d < decks_played; ++d)
+                    {
+                        double diff = candidates[c].outcomes[d] - candidates[leader].outcomes[d];
+                        sum += diff;
+                        sum_sq += diff * diff;
+                    }
+                    double mean = sum / decks_played;
+                    double variance = std::max(0.0, (sum_sq - decks_played * mean * mean) / std::max(1, decks_played - 1));
+                    double standard_error = std::sqrt(variance / decks_played);
+                    if (mean < 0.0 && mean + RACING_Z * standard_error < 0.0)
+                    {
+                        candidates[c].alive = false;
+                        dropped_by_racing++;
+                    }
+                }
+                alive.erase(std::remove_if(alive.begin(), alive.end(), [&](int c) { return !candidates[c].alive; }), alive.end());
+            }
+        }
+
+        // --- Successive halving: keep the better half for the next rung ---
+        int kept_before_halving = alive.size();
+        if (rung < rungs - 1 && alive.size() > 2)
+        {
+            std::sort(alive.begin(), alive.end(), [&](int a, int b) {
+                return mean_of(candidates[a].outcomes) > mean_of(candidates[b].outcomes);
+            });
+            for (size_t k = (alive.size() + 1) / 2; k < alive.size(); ++k)
+            {
+                candidates[alive[k]].alive = false;
+            }
+            alive.resize((alive.size() + 1) / 2);
+        }
+
+        std::cout << "Rung " << rung + 1 << ": " << decks_played << " paired decks, "
+                  << dropped_by_racing << " dropped by racing, "
+                  << kept_before_halving - static_cast<int>(alive.size()) << " by halving, "
+                  << alive.size() << " left\n";
+    }
+
+    // --- Report the best survivor ---
+    int best = -1;
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+        if (candidates[c].alive && (best == -1 || mean_of(candidates[c].outcomes) > mean_of(candidates[best].outcomes)))
+        {
+            best = c;
+        }
+    }
+    if (best == -1 || candidates[best].outcomes.empty())
+    {
+        std::cerr << "Error: Budget too small to evaluate any candidate\n";
+        return;
+    }
+
+    const std::vector<float> &outcomes = candidates[best].outcomes;
+    double n = outcomes.size();
+    double mean = mean_of(outcomes);
+
+    std::cout << "Best parameters for " << options.strategy_name << ": ";
+    print_params(candidates[best].params);
+    std::cout << "\n";
+    if (options.race_on_cards)
+    {
+        double sum_sq = 0.0;
+        for (float v : outcomes)
+        {
+            sum_sq += (v - mean) * (v - mean);
+        }
+        double half_width = CI_Z * std::sqrt(sum_sq / std::max(1.0, n - 1) / n);
+        std::cout << "  average cards played: " << mean << " (95% CI " << mean - half_width << " - " << mean + half_width << ") over " << n << " decks\n";
+    }
+    else
+    {
+        // Wilson score interval, well behaved for win rates close to 0
+        double z2 = CI_Z * CI_Z;
+        double centre = (mean + z2 / (2 * n)) / (1 + z2 / n);
+        double half_width = CI_Z * std::sqrt(mean * (1 - mean) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+        std::cout << "  win rate: " << mean * 100 << " % (95% CI " << std::max(0.0, centre - half_width) * 100
+                  << " - " << std::min(1.0, centre + half_width) * 100 << " %) over " << n << " decks\n";
+    }
+    std::cout << "  games simulated: " << spent << "\n";
+}
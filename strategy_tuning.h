@@ -0,0 +1,24 @@
+#ifndef STRATEGY_TUNING_H
+#define STRATEGY_TUNING_H
+
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "player_strategies.h"
+
+// Settings of the `tune` mode.
+struct TuningOptions
+{
+    std::string strategy_name; // Strategy whose parameters are tuned (A1, E1, H1 or H2)
+    int num_players;           // Players at the table, all using the tuned strategy
+    long long budget;          // Total number of games (candidates x decks) to spend
+    int min_decks;             // Paired decks a candidate plays before racing may drop it
+    int batch_size;            // Decks dealt and simulated between two racing checks
+    int num_threads;           // Worker threads simulating a batch
+    bool race_on_cards;        // Compare cards played instead of wins (useful when win rates are ~0)
+};
+
+void run_strategy_tuning(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, const TuningOptions &options);
+
+#endif
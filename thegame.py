@@ -0,0 +1,119 @@
+"""Python bindings of libthegame.so (see thegame_api.h).
+
+Runs the simulator in-process and returns its results as numpy arrays,
+without going through the text output:
+
+    import thegame
+    results = thegame.simulate(["A1", "K"], games=100000, seed=42, NUMBER_OF_PLAYERS=3)
+    results["won"].mean(axis=0)  # win rate of each strategy
+
+The result arrays are allocated here and the library writes into them
+directly: nothing is parsed or copied. ctypes releases the GIL for the
+duration of the call, so other Python threads keep running while the games
+are played on the library's own threads.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+
+class _Results(ctypes.Structure):
+    _fields_ = [
+        ("won", ctypes.POINTER(ctypes.c_uint8)),
+        ("cards_played", ctypes.POINTER(ctypes.c_int32)),
+        ("deck_left", ctypes.POINTER(ctypes.c_int32)),
+        ("deck_id", ctypes.POINTER(ctypes.c_uint64)),
+    ]
+
+
+API_VERSION = 1
+_library = None
+
+
+def load(path=None):
+    """
+    Loads libthegame.so (once).
+
+    Args:
+        path (str): The library to load. Defaults to $THEGAME_LIB, then the
+            libthegame.so next to this file.
+
+    Returns:
+        ctypes.CDLL: The library.
+    """
+    global _library
+    if _library is not None and path is None:
+        return _library
+    if path is None:
+        path = os.environ.get("THEGAME_LIB", os.path.join(os.path.dirname(os.path.abspath(__file__)), "libthegame.so"))
+    library = ctypes.CDLL(path)
+    library.thegame_api_version.restype = ctypes.c_int32
+    library.thegame_num_strategies.restype = ctypes.c_int32
+    library.thegame_strategy_name.restype = ctypes.c_char_p
+    library.thegame_strategy_name.argtypes = [ctypes.c_int32]
+    library.thegame_simulate.restype = ctypes.c_int32
+    library.thegame_simulate.argtypes = [
+        ctypes.POINTER(ctypes.c_char_p), ctypes.POINTER(ctypes.c_int64), ctypes.c_int32,
+        ctypes.POINTER(ctypes.c_char_p), ctypes.c_int32, ctypes.c_int64, ctypes.c_uint64,
+        ctypes.c_int32, ctypes.POINTER(_Results), ctypes.c_char_p, ctypes.c_int32,
+    ]
+    if library.thegame_api_version() != API_VERSION:
+        raise RuntimeError("%s implements API version %d, thegame.py expects %d" % (path, library.thegame_api_version(), API_VERSION))
+    _library = library
+    return library
+
+
+def strategies():
+    """
+    Returns:
+        list: The names of the built-in strategies.
+    """
+    library = load()
+    return [library.thegame_strategy_name(i).decode() for i in range(library.thegame_num_strategies())]
+
+
+def _column(array, c_type):
+    return array.ctypes.data_as(ctypes.POINTER(c_type))
+
+
+def simulate(strategy_names, games, seed=0, threads=0, **settings):
+    """
+    Plays seeded deals with each strategy at every seat.
+
+    Deal g of a seed is the same for every strategy, every thread count and
+    every call, and the same as deal g of a simulation daemon job with that
+    seed.
+
+    Args:
+        strategy_names (list): The strategies to play (see strategies()).
+        games (int): The number of deals.
+        seed (int): The seed of the deals.
+        threads (int): Worker threads, 0 for one per core.
+        **settings: Config settings by their config file name, e.g.
+            NUMBER_OF_PLAYERS=3, CARD_IN_HANDS=7. The others keep their defaults.
+
+    Returns:
+        dict: numpy arrays "won" (bool), "cards_played" and "deck_left"
+            (int32) of shape (games, len(strategy_names)), and "deck_id"
+            (uint64) of shape (games,).
+    """
+    library = load()
+    strategy_names = list(strategy_names)
+    num_strategies = len(strategy_names)
+    won = np.zeros((games, num_strategies), dtype=np.uint8)
+    cards_played = np.zeros((games, num_strategies), dtype=np.int32)
+    deck_left = np.zeros((games, num_strategies), dtype=np.int32)
+    deck_id = np.zeros(games, dtype=np.uint64)
+    results = _Results(_column(won, ctypes.c_uint8), _column(cards_played, ctypes.c_int32),
+                       _column(deck_left, ctypes.c_int32), _column(deck_id, ctypes.c_uint64))
+
+    names = (ctypes.c_char_p * num_strategies)(*[name.encode() for name in strategy_names])
+    setting_names = (ctypes.c_char_p * len(settings))(*[name.encode() for name in settings])
+    setting_values = (ctypes.c_int64 * len(settings))(*settings.values())
+    error = ctypes.create_string_buffer(256)
+    if library.thegame_simulate(setting_names, setting_values, len(settings), names, num_strategies,
+                                games, seed, threads, ctypes.byref(results), error, len(error)) != 0:
+        raise ValueError(error.value.decode())
+    return {"won": won.view(np.bool_), "cards_played": cards_played, "deck_left": deck_left, "deck_id": deck_id}
@@ -0,0 +1,140 @@
+#include "thegame_api.h"
+#include "game_config.h"
+#include "game_logic.h"
+#include "parallel.h"
+#include "strategy_registry.h"
+
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define THEGAME_EXPORT extern "C" __attribute__((visibility("default")))
+
+bool TRACE_GAMES = false; // The library never prints game traces
+
+namespace {
+
+// Built-in strategies in name order, built once
+const std::vector<std::pair<std::string, StrategyFunction>> &strategy_list()
+{
+    static const std::vector<std::pair<std::string, StrategyFunction>> list = [] {
+        auto strategies = builtin_strategies();
+        return std::vector<std::pair<std::string, StrategyFunction>>(strategies.begin(), strategies.end());
+    }();
+    return list;
+}
+
+int32_t fail(const std::string &message, char *error, int32_t error_size)
+{
+    if (error != nullptr && error_size > 0)
+    {
+        size_t length = std::min<size_t>(message.size(), error_size - 1);
+        std::memcpy(error, message.data(), length);
+        error[length] = '\0';
+    }
+    return 1;
+}
+
+} // namespace
+
+THEGAME_EXPORT int32_t thegame_api_version(void)
+{
+    return THEGAME_API_VERSION;
+}
+
+THEGAME_EXPORT int32_t thegame_num_strategies(void)
+{
+    return strategy_list().size();
+}
+
+THEGAME_EXPORT const char *thegame_strategy_name(int32_t index)
+{
+    if (index < 0 || index >= static_cast<int32_t>(strategy_list().size()))
+    {
+        return nullptr;
+    }
+    return strategy_list()[index].first.c_str();
+}
+
+/**
+ * @brief Plays seeded deals with each strategy and fills the caller's result columns (see thegame_api.h).
+ *
+ * Every deal is played by every strategy, so the strategies are compared on
+ * the same decks and seat orders. Games are split over the threads in
+ * contiguous chunks and every game writes only its own cells.
+ */
+THEGAME_EXPORT int32_t thegame_simulate(const char *const *setting_names, const int64_t *setting_values, int32_t num_settings,
+                                        const char *const *strategy_names, int32_t num_strategies, int64_t num_games, uint64_t seed,
+                                        int32_t num_threads, const thegame_results *results, char *error, int32_t error_size)
+{
+    GameConfig config;
+    for (int32_t i = 0; i < num_settings; ++i)
+    {
+        if (setting_names[i] == nullptr || setting_values[i] < INT_MIN || setting_values[i] > INT_MAX ||
+            !set_game_config_value(config, setting_names[i], static_cast<int>(setting_values[i])))
+        {
+            return fail(std::string("unknown setting or value out of range: ") + (setting_names[i] ? setting_names[i] : "(null)"), error, error_size);
+        }
+    }
+    std::string config_error;
+    if (!validate_game_config(config, config_error))
+    {
+        return fail(config_error, error, error_size);
+    }
+    if (num_games < 0 || num_games > INT_MAX)
+    {
+        return fail("num_games must be between 0 and " + std::to_string(INT_MAX), error, error_size);
+    }
+    if (num_strategies < 1 || results == nullptr)
+    {
+        return fail("at least one strategy and a result structure are needed", error, error_size);
+    }
+
+    std::vector<std::vector<StrategyFunction>> seats;
+    for (int32_t s = 0; s < num_strategies; ++s)
+    {
+        StrategyFunction function = nullptr;
+        for (const auto &[name, candidate] : strategy_list())
+        {
+            if (strategy_names[s] != nullptr && name == strategy_names[s])
+            {
+                function = candidate;
+            }
+        }
+        if (function == nullptr)
+        {
+            return fail(std::string("unknown strategy ") + (strategy_names[s] ? strategy_names[s] : "(null)"), error, error_size);
+        }
+        seats.emplace_back(config.number_of_players, function);
+    }
+
+    StrategyParams params = default_strategy_params(config);
+    int games = static_cast<int>(num_games);
+    parallel_for_chunks(games, num_threads > 0 ? num_threads : default_thread_count(), [&](int begin, int end, int) {
+        std::vector<std::vector<int>> final_playing_rows, final_hand;
+        for (int game = begin; game < end; ++game)
+        {
+            std::vector<int> deck = seeded_deck(config.card_max_number, seed, game);
+            std::mt19937_64 order_rng = seat_order_rng(seed, game);
+            GameSetup setup = setup_game(config, config.number_of_players, deck, order_rng);
+            if (results->deck_id != nullptr)
+            {
+                results->deck_id[game] = deck_hash(deck);
+            }
+            for (int32_t s = 0; s < num_strategies; ++s)
+            {
+                int turns = 0, deck_left = 0;
+                bool won = simulate_game_multiplayer(config, seats[s], setup, params, turns, final_playing_rows, final_hand, &deck_left);
+                size_t cell = static_cast<size_t>(game) * num_strategies + s;
+                if (results->won != nullptr)
+                    results->won[cell] = won;
+                if (results->cards_played != nullptr)
+                    results->cards_played[cell] = turns;
+                if (results->deck_left != nullptr)
+                    results->deck_left[cell] = deck_left;
+            }
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef THEGAME_API_H
+#define THEGAME_API_H
+
+/*
+ * C API of libthegame.so: runs the simulator from other languages without
+ * going through its text output (thegame.py wraps it for Python).
+ *
+ * thegame_simulate plays num_games deals of a seed with every strategy
+ * asked for, each strategy at every seat, and writes the results straight
+ * into columns owned by the caller. Deal g of a seed is the same as deal g
+ * of a simulation daemon job with that seed, whatever the number of
+ * threads. The call blocks until every game is played; it does not touch
+ * any state of the caller besides the result columns and the error buffer.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define THEGAME_API_VERSION 1
+
+/*
+ * Result columns, owned by the caller. Game g of strategy s is at index
+ * g * num_strategies + s; deck_id has one entry per game. A NULL column is
+ * not filled.
+ */
+typedef struct
+{
+    uint8_t *won;          /* 1 if the game was won */
+    int32_t *cards_played; /* Cards played on the rows */
+    int32_t *deck_left;    /* Cards left in the draw pile at the end */
+    uint64_t *deck_id;     /* Hash of the shuffled deck (as in the Shuffle ID of the text output) */
+} thegame_results;
+
+int32_t thegame_api_version(void);
+
+/* Built-in strategies: names for thegame_simulate */
+int32_t thegame_num_strategies(void);
+const char *thegame_strategy_name(int32_t index); /* NULL if index is out of range */
+
+/*
+ * Plays num_games seeded deals with each strategy on num_threads threads
+ * (0 = one per core). The settings use the names of the config files
+ * (CARD_MAX_NUMBER, NUMBER_OF_PLAYERS, ...) and override the defaults.
+ * Returns 0 on success; otherwise nothing is played and error receives a
+ * message (truncated to error_size, always terminated).
+ */
+int32_t thegame_simulate(const char *const *setting_names, const int64_t *setting_values, int32_t num_settings,
+                         const char *const *strategy_names, int32_t num_strategies, int64_t num_games, uint64_t seed,
+                         int32_t num_threads, const thegame_results *results, char *error, int32_t error_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+#include "turn_planning.h"
+#include "game_config.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Evaluates the hand against the row tops and against itself for the sequences of one turn.
+ *
+ * @param hand The player's hand at the start of the turn.
+ * @param playing_rows The playing rows at the start of the turn.
+ * @param context The strategy context (rules and move cache).
+ */
+void TurnSequenceEnumerator::start(const Hand &hand, const PlayingRows &playing_rows, const StrategyContext &context)
+{
+    num_cards_ = hand.size();
+    num_rows_ = context.config.number_of_rows;
+    cards_.assign(hand.begin(), hand.end());
+    row_tops_.resize(num_rows_);
+    top_card_.assign(num_rows_, -1);
+    used_.assign(num_cards_, 0);
+
+    first_.resize(static_cast<size_t>(num_cards_) * num_rows_);
+    for (int r = 0; r < num_rows_; ++r)
+    {
+        row_tops_[r] = playing_rows[r].back();
+        for (int i = 0; i < num_cards_; ++i)
+        {
+            first_[i * num_rows_ + r] = evaluate_move(context, cards_[i], r, row_tops_[r]);
+        }
+    }
+
+    follows_.resize(static_cast<size_t>(num_cards_) * num_cards_ * 2);
+    for (int i = 0; i < num_cards_; ++i)
+    {
+        for (int top = 0; top < num_cards_; ++top)
+        {
+            size_t index = (static_cast<size_t>(i) * num_cards_ + top) * 2;
+            if (i == top)
+            {
+                follows_[index] = follows_[index + 1] = ValidMove::NO;
+                continue;
+            }
+            follows_[index] = is_valid_move(context.config, cards_[i], cards_[top], false);
+            follows_[index + 1] = is_valid_move(context.config, cards_[i], cards_[top], true);
+        }
+    }
+}
+
+/**
+ * @brief Runs a whole-turn planner behind the single-move strategy signature.
+ *
+ * An engine that takes whole-turn plans points context.turn_plan at an empty
+ * plan on the first move of a turn and then plays the plan as a whole. Any
+ * other caller gets the first move of a fresh plan, so the planner replans
+ * the rest of the turn at every move.
+ *
+ * @param planner The whole-turn entry point of the strategy.
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications What the players announced this turn.
+ * @param player_id The id of the deciding player.
+ * @param context The strategy context handed over by the engine.
+ * @return The first move of the plan, or {-1, -1} if the plan is empty.
+ */
+std::pair<int, int> play_turn_plan(TurnStrategyFunction planner, const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    static thread_local TurnPlan scratch_plan; // Used when the engine plays move by move
+    TurnPlan &plan = context.turn_plan != nullptr ? *context.turn_plan : scratch_plan;
+    plan.clear();
+    planner(hand, playing_rows, communications, player_id, context, plan);
+    if (plan.empty())
+    {
+        return {-1, -1};
+    }
+    return plan.front();
+}
+
+namespace {
+
+/**
+ * @brief Appends the cheapest legal sequence of up to `cards` moves to the plan.
+ *
+ * The longest length that has a legal sequence is planned. Card indices are
+ * translated through hand_index (nullptr: the hand is the one of the turn start).
+ *
+ * @return The number of moves appended (0 if no card can be played).
+ */
+int plan_cheapest_sequence(TurnSequenceEnumerator &enumerator, const Hand &hand, int half, int cards, const int *hand_index, TurnPlan &plan)
+{
+    size_t start = plan.size();
+    for (int length = cards; length >= 1; --length)
+    {
+        int best_cost = std::numeric_limits<int>::max();
+        enumerator.for_each_sequence(length, [&](const SequenceMove *moves, int num_moves) {
+            int cost = 0;
+            for (int m = 0; m < num_moves; ++m)
+            {
+                int card = hand[moves[m].card_index];
+                cost += (moves[m].row < half ? card - moves[m].row_top : moves[m].row_top - card) - 1;
+            }
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                plan.resize(start);
+                for (int m = 0; m < num_moves; ++m)
+                {
+                    int card_index = moves[m].card_index;
+                    plan.push_back({hand_index != nullptr ? hand_index[card_index] : card_index, moves[m].row});
+                }
+            }
+        });
+        if (plan.size() > start)
+        {
+            return length;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+/**
+ * @brief Strategy K: plays the sequence of the turn that skips the fewest card values overall.
+ *
+ * A move costs the values it jumps over (a reverse trick, which moves the
+ * row back, has a negative cost). Every legal sequence of the cards to play
+ * is scored as a whole, so a greedy first move that blocks the second one is
+ * avoided. When no sequence of the full length exists, the longest shorter
+ * one is planned (the turn is lost anyway). Turns of more than
+ * MAX_TURN_SEQUENCE cards are planned MAX_TURN_SEQUENCE cards at a time,
+ * each block from the hand and rows the previous blocks leave.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param context The strategy context handed over by the engine.
+ * @param plan (Output) The moves of the turn, in play order.
+ */
+void plan_turn_K(const Hand &hand, const PlayingRows &playing_rows, const Communications &, int, const StrategyContext &context, TurnPlan &plan)
+{
+    static thread_local TurnSequenceEnumerator enumerator; // Tables reused between decisions of this thread
+    enumerator.start(hand, playing_rows, context);
+
+    int cards = context.cards_to_plan > 0 ? context.cards_to_plan : context.config.num_cards_to_play;
+    cards = std::min(cards, static_cast<int>(hand.size()));
+    int half = context.config.number_of_rows / 2;
+
+    int block = std::min(cards, MAX_TURN_SEQUENCE);
+    int planned = plan_cheapest_sequence(enumerator, hand, half, block, nullptr, plan);
+    if (planned == cards || planned < block)
+    {
+        return;
+    }
+
+    // Longer turn: plan the next block on what is left of the hand, against the rows as the plan leaves them
+    static thread_local Hand rest;
+    static thread_local PlayingRows rest_rows;
+    static thread_local std::vector<int> rest_index; // Index of each remaining card in the hand
+    static thread_local std::vector<char> used;
+    StrategyContext rest_context = context;
+    rest_context.cache = nullptr; // The move cache only knows the real row tops
+    while (planned < cards)
+    {
+        used.assign(hand.size(), 0);
+        rest_rows.resize(context.config.number_of_rows);
+        for (int r = 0; r < context.config.number_of_rows; ++r)
+        {
+            rest_rows[r].assign(1, playing_rows[r].back());
+        }
+        for (const auto &[card_index, row] : plan)
+        {
+            used[card_index] = 1;
+            rest_rows[row][0] = hand[card_index];
+        }
+        rest.clear();
+        rest_index.clear();
+        for (int i = 0; i < static_cast<int>(hand.size()); ++i)
+        {
+            if (!used[i])
+            {
+                rest.push_back(hand[i]);
+                rest_index.push_back(i);
+            }
+        }
+
+        enumerator.start(rest, rest_rows, rest_context);
+        block = std::min(cards - planned, MAX_TURN_SEQUENCE);
+        int length = plan_cheapest_sequence(enumerator, rest, half, block, rest_index.data(), plan);
+        planned += length;
+        if (length < block)
+        {
+            return;
+        }
+    }
+}
+
+std::pair<int, int> get_player_move_K(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return play_turn_plan(plan_turn_K, hand, playing_rows, communications, player_id, context);
+}
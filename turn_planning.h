@@ -0,0 +1,133 @@
+#ifndef TURN_PLANNING_H
+#define TURN_PLANNING_H
+
+#include <utility>
+#include <vector>
+
+#include "player_strategies.h"
+
+const int MAX_TURN_SEQUENCE = 4; // Longest move sequence the enumerator builds
+
+// One move of an enumerated sequence
+struct SequenceMove
+{
+    int card_index;  // Index in the hand at the start of the turn
+    int row;
+    int row_top;     // Top of the row just before this move
+    ValidMove valid; // How the card goes on the row (never NO)
+};
+
+/**
+ * @brief Lists the legal move sequences of one turn, reusing evaluations between sequences.
+ *
+ * start() evaluates every (card, row) pair of the hand against the row tops
+ * (through the engine's move cache when there is one) and every card against
+ * every other card of the hand, as the new top of an ascending or of a
+ * descending row. Any later move of a sequence is then a table lookup: its
+ * row either still has its original top or has a hand card on top.
+ *
+ * Moves on different rows can be swapped without changing the result, so
+ * only one order of them is listed: a move never follows a move on a higher
+ * row unless a move on its own row lies in between.
+ */
+class TurnSequenceEnumerator
+{
+public:
+    void start(const Hand &hand, const PlayingRows &playing_rows, const StrategyContext &context);
+
+    /**
+     * @brief Calls visit(moves, length) for every legal sequence of exactly length moves.
+     *
+     * @param length The number of moves of the sequences (at most MAX_TURN_SEQUENCE).
+     * @param visit Callable taking (const SequenceMove *moves, int length).
+     * @return The number of sequences visited.
+     */
+    template <typename Visitor>
+    long long for_each_sequence(int length, Visitor &&visit)
+    {
+        if (length < 1 || length > MAX_TURN_SEQUENCE || length > num_cards_)
+        {
+            return 0;
+        }
+        return extend(0, length, visit);
+    }
+
+private:
+    int num_cards_ = 0;
+    int num_rows_ = 0;
+    std::vector<int> cards_;            // Card values of the hand
+    std::vector<int> row_tops_;         // Row tops at the start of the turn
+    std::vector<ValidMove> first_;      // [card * num_rows + row], against the row tops
+    std::vector<ValidMove> follows_;    // [(card * num_cards + top card) * 2 + ascending]
+    std::vector<int> top_card_;         // Per row: index of the hand card on top, or -1
+    std::vector<char> used_;            // Per card: already in the sequence
+    SequenceMove moves_[MAX_TURN_SEQUENCE];
+
+    ValidMove evaluate(int card, int row) const
+    {
+        int top = top_card_[row];
+        if (top == -1)
+        {
+            return first_[card * num_rows_ + row];
+        }
+        return follows_[(card * num_cards_ + top) * 2 + (row < num_rows_ / 2)];
+    }
+
+    bool in_order(int depth, int row) const
+    {
+        for (int s = depth - 1; s >= 0 && moves_[s].row != row; --s)
+        {
+            if (moves_[s].row > row)
+            {
+                return false; // Same sequence as with this move moved before moves_[s]
+            }
+        }
+        return true;
+    }
+
+    template <typename Visitor>
+    long long extend(int depth, int length, Visitor &visit)
+    {
+        long long count = 0;
+        for (int card = 0; card < num_cards_; ++card)
+        {
+            if (used_[card])
+            {
+                continue;
+            }
+            for (int row = 0; row < num_rows_; ++row)
+            {
+                if (!in_order(depth, row))
+                {
+                    continue;
+                }
+                ValidMove valid = evaluate(card, row);
+                if (valid == ValidMove::NO)
+                {
+                    continue;
+                }
+                int top = top_card_[row];
+                moves_[depth] = {card, row, top == -1 ? row_tops_[row] : cards_[top], valid};
+                if (depth + 1 == length)
+                {
+                    visit(static_cast<const SequenceMove *>(moves_), length);
+                    count++;
+                    continue;
+                }
+                top_card_[row] = card;
+                used_[card] = 1;
+                count += extend(depth + 1, length, visit);
+                top_card_[row] = top;
+                used_[card] = 0;
+            }
+        }
+        return count;
+    }
+};
+
+std::pair<int, int> play_turn_plan(TurnStrategyFunction planner, const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+
+void plan_turn_K(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context, TurnPlan &plan);
+std::pair<int, int> get_player_move_K(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+
+#endif
@@ -0,0 +1,374 @@
+#include "variance_reduction.h"
+#include "deck_stratification.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const int NUM_CONTROLS = 3;
+const double CI_Z = 1.96; // 95% confidence intervals
+
+const char *const CONTROL_NAMES[NUM_CONTROLS] = {"dealt variance", "hand clustering", "reverse pairs"};
+
+// Cheap statistics of a deck (from compute_deck_features) whose means over uniform shuffles are known exactly
+struct ControlStatistics
+{
+    double values[NUM_CONTROLS]; // Variance of the dealt cards, average gap within the dealt hands, early reverse pairs
+};
+
+ControlStatistics control_statistics(const GameConfig &config, const std::vector<int> &deck, int num_players)
+{
+    DeckFeatures features = compute_deck_features(config, deck, num_players);
+    return {{features.early_spread * features.early_spread, features.hand_clustering, features.reverse_pairs}};
+}
+
+/**
+ * @brief Exact means of the control statistics over uniformly shuffled decks of N consecutive cards.
+ *
+ * - The n dealt cards are a sample without replacement: the mean of their
+ *   variance (divided by n) is (n - 1) / n x N (N + 1) / 12.
+ * - The k cards of a hand span (k - 1)(N + 1) / (k + 1) on average, and the
+ *   gaps of a hand add up to its span.
+ * - Each of the early x (early - 1) / 2 pairs of cards is one of the
+ *   N - REVERSE_MOVE_DIFF reverse pairs with probability (N - diff) / C(N, 2).
+ */
+ControlStatistics control_means(const GameConfig &config, int num_players)
+{
+    double n_cards = config.card_max_number - 2;
+    int dealt = std::min<int>(n_cards, num_players * config.card_in_hands);
+    int early = std::min<int>(n_cards, dealt + num_players * config.num_cards_to_play);
+    ControlStatistics means = {{0.0, 0.0, 0.0}};
+    if (dealt == 0)
+    {
+        return means;
+    }
+    means.values[0] = (dealt - 1.0) / dealt * n_cards * (n_cards + 1.0) / 12.0;
+
+    double span = 0.0, gaps = 0.0;
+    for (int p = 0; p * config.card_in_hands < dealt; ++p)
+    {
+        int k = std::min(config.card_in_hands, dealt - p * config.card_in_hands);
+        span += (k - 1.0) * (n_cards + 1.0) / (k + 1.0);
+        gaps += k - 1;
+    }
+    means.values[1] = gaps > 0 ? span / gaps : 0.0;
+
+    double reverse_pairs = std::max(0.0, n_cards - config.reverse_move_diff);
+    means.values[2] = early * (early - 1.0) / 2.0 * reverse_pairs / (n_cards * (n_cards - 1.0) / 2.0);
+    return means;
+}
+
+// Mean and 95% half-width of an estimate, with its gain in effective sample size over the plain estimate
+struct Estimate
+{
+    double mean = 0.0;
+    double half_width = 0.0;
+    double statistic = 0.0; // Antithetic: correlation within the pairs; control: R^2 of the regression
+    double gain = 0.0;      // Variance of the plain estimate / variance of this one, for the same number of games
+};
+
+double variance_of(const std::vector<double> &values, double &mean)
+{
+    mean = 0.0;
+    for (double v : values)
+    {
+        mean += v;
+    }
+    mean = values.empty() ? 0.0 : mean / values.size();
+    double sum = 0.0;
+    for (double v : values)
+    {
+        sum += (v - mean) * (v - mean);
+    }
+    return values.size() > 1 ? sum / (values.size() - 1) : 0.0;
+}
+
+Estimate plain_estimate(const std::vector<double> &y)
+{
+    Estimate e;
+    double variance = variance_of(y, e.mean);
+    e.half_width = CI_Z * std::sqrt(variance / y.size());
+    e.gain = 1.0;
+    return e;
+}
+
+// Pairs (y[i], mirrored[i]): the estimate is the mean of the pair averages
+Estimate antithetic_estimate(const std::vector<double> &y, const std::vector<double> &mirrored)
+{
+    size_t pairs = mirrored.size();
+    std::vector<double> averages(pairs), singles;
+    for (size_t i = 0; i < pairs; ++i)
+    {
+        averages[i] = (y[i] + mirrored[i]) / 2.0;
+        singles.push_back(y[i]);
+        singles.push_back(mirrored[i]);
+    }
+    Estimate e;
+    double single_mean = 0.0, mirrored_mean = 0.0, first_mean = 0.0;
+    double pair_variance = variance_of(averages, e.mean);
+    double single_variance = variance_of(singles, single_mean);
+    std::vector<double> first(y.begin(), y.begin() + pairs);
+    double first_variance = variance_of(first, first_mean);
+    double mirrored_variance = variance_of(mirrored, mirrored_mean);
+    double covariance = 0.0;
+    for (size_t i = 0; i < pairs; ++i)
+    {
+        covariance += (y[i] - first_mean) * (mirrored[i] - mirrored_mean);
+    }
+    covariance = pairs > 1 ? covariance / (pairs - 1) : 0.0;
+    e.half_width = CI_Z * std::sqrt(pair_variance / pairs);
+    e.statistic = first_variance > 0.0 && mirrored_variance > 0.0 ? covariance / std::sqrt(first_variance * mirrored_variance) : 0.0;
+    e.gain = pair_variance > 0.0 ? single_variance / (2.0 * pair_variance) : 0.0;
+    return e;
+}
+
+// y corrected by beta . (mean of x - known mean), beta fitted by least squares on the same games
+Estimate control_estimate(const std::vector<double> &y, const std::vector<ControlStatistics> &x, const ControlStatistics &known)
+{
+    size_t n = y.size();
+    double y_mean = 0.0;
+    double y_variance = variance_of(y, y_mean);
+    double x_mean[NUM_CONTROLS] = {};
+    for (const auto &stats : x)
+    {
+        for (int c = 0; c < NUM_CONTROLS; ++c)
+        {
+            x_mean[c] += stats.values[c] / n;
+        }
+    }
+
+    // Normal equations of the centred regression, solved by Gaussian elimination
+    double a[NUM_CONTROLS][NUM_CONTROLS + 1] = {};
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (int r = 0; r < NUM_CONTROLS; ++r)
+        {
+            double xr = x[i].values[r] - x_mean[r];
+            for (int c = 0; c < NUM_CONTROLS; ++c)
+            {
+                a[r][c] += xr * (x[i].values[c] - x_mean[c]);
+            }
+            a[r][NUM_CONTROLS] += xr * (y[i] - y_mean);
+        }
+    }
+    for (int r = 0; r < NUM_CONTROLS; ++r)
+    {
+        a[r][r] += 1e-9; // Keeps the system solvable when a statistic is constant
+    }
+    for (int col = 0; col < NUM_CONTROLS; ++col)
+    {
+        for (int r = 0; r < NUM_CONTROLS; ++r)
+        {
+            if (r != col)
+            {
+                double factor = a[r][col] / a[col][col];
+                for (int c = col; c <= NUM_CONTROLS; ++c)
+                {
+                    a[r][c] -= factor * a[col][c];
+                }
+            }
+        }
+    }
+    double beta[NUM_CONTROLS];
+    for (int c = 0; c < NUM_CONTROLS; ++c)
+    {
+        beta[c] = a[c][NUM_CONTROLS] / a[c][c];
+    }
+
+    Estimate e;
+    e.mean = y_mean;
+    for (int c = 0; c < NUM_CONTROLS; ++c)
+    {
+        e.mean -= beta[c] * (x_mean[c] - known.values[c]);
+    }
+    double residuals = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double r = y[i] - y_mean;
+        for (int c = 0; c < NUM_CONTROLS; ++c)
+        {
+            r -= beta[c] * (x[i].values[c] - x_mean[c]);
+        }
+        residuals += r * r;
+    }
+    double residual_variance = n > NUM_CONTROLS + 1 ? residuals / (n - NUM_CONTROLS - 1) : 0.0;
+    e.half_width = CI_Z * std::sqrt(residual_variance / n);
+    e.statistic = y_variance > 0.0 ? 1.0 - residuals / (y_variance * (n - 1)) : 0.0;
+    e.gain = residual_variance > 0.0 ? y_variance / residual_variance : 0.0;
+    return e;
+}
+
+std::string format_estimate(const Estimate &e, double scale, int precision)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << e.mean * scale << " +- " << e.half_width * scale;
+    return out.str();
+}
+
+std::string format_gain(const Estimate &e)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << e.statistic << std::setw(8);
+    if (e.gain > 0.0)
+        out << e.gain;
+    else
+        out << "-"; // No variance at all: nothing to reduce
+    return out.str();
+}
+
+} // namespace
+
+/**
+ * @brief The antithetic counterpart of a deal: every card c becomes CARD_MAX_NUMBER + 1 - c and the seat order is reversed.
+ *
+ * Ascending and descending rows swap roles, so the mirrored deal is as likely
+ * as the original one under a uniform shuffle.
+ *
+ * @param config The game config.
+ * @param setup The dealt game.
+ * @return The mirrored deal.
+ */
+GameSetup antithetic_setup(const GameConfig &config, const GameSetup &setup)
+{
+    GameSetup mirrored = setup;
+    auto mirror = [&](std::vector<int> &cards) {
+        for (int &card : cards)
+        {
+            card = config.card_max_number + 1 - card;
+        }
+    };
+    mirror(mirrored.deck);
+    for (auto &hand : mirrored.hands)
+    {
+        mirror(hand);
+    }
+    std::reverse(mirrored.player_order.begin(), mirrored.player_order.end());
+    return mirrored;
+}
+
+/**
+ * @brief Estimates the win rate and the cards played of every strategy, plain and with variance reduction.
+ *
+ * Every strategy plays the same num_games seeded deals (every seat using it).
+ * The antithetic estimate spends the same number of games on num_games / 2
+ * deals and their mirrored counterparts; it only helps if the outcomes of a
+ * pair are negatively correlated, so the correlation is reported. The
+ * control-variate estimate corrects the plain one with a least-squares fit
+ * on the deck statistics, whose exact means are known. The gain is the
+ * effective sample size relative to plain sampling (above 1 = better).
+ *
+ * @param config The game config.
+ * @param strategies The strategies, by name.
+ * @param estimator The estimators to report.
+ * @param num_games Games per strategy and estimator.
+ * @param seed Seed of the deals.
+ * @param num_threads The number of worker threads.
+ * @return 0 on success.
+ */
+int run_variance_estimators(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, VarianceEstimator estimator, int num_games,
+                            uint64_t seed, int num_threads)
+{
+    bool antithetic = estimator != VarianceEstimator::CONTROL;
+    bool control = estimator != VarianceEstimator::ANTITHETIC;
+    std::vector<std::pair<std::string, StrategyFunction>> list(strategies.begin(), strategies.end());
+    const int num_strategies = list.size();
+    const int num_pairs = antithetic ? num_games / 2 : 0;
+    StrategyParams params = default_strategy_params(config);
+
+    // Outcomes [game * strategies + strategy]: won and cards played, plain and mirrored deals
+    std::vector<double> won(static_cast<size_t>(num_games) * num_strategies), cards(won.size());
+    std::vector<double> mirrored_won(static_cast<size_t>(num_pairs) * num_strategies), mirrored_cards(mirrored_won.size());
+    std::vector<ControlStatistics> statistics(num_games);
+    parallel_for_chunks(num_games, num_threads, [&](int begin, int end, int) {
+        std::vector<std::vector<int>> final_rows, final_hands;
+        for (int game = begin; game < end; ++game)
+        {
+            std::vector<int> deck = seeded_deck(config.card_max_number, seed, game);
+            std::mt19937_64 order_rng = seat_order_rng(seed, game);
+            GameSetup setup = setup_game(config, config.number_of_players, deck, order_rng);
+            statistics[game] = control_statistics(config, deck, config.number_of_players);
+            GameSetup mirrored;
+            if (game < num_pairs)
+            {
+                mirrored = antithetic_setup(config, setup);
+            }
+            for (int s = 0; s < num_strategies; ++s)
+            {
+                std::vector<StrategyFunction> seats(config.number_of_players, list[s].second);
+                size_t cell = static_cast<size_t>(game) * num_strategies + s;
+                int turns = 0;
+                won[cell] = simulate_game_multiplayer(config, seats, setup, params, turns, final_rows, final_hands);
+                cards[cell] = turns;
+                if (game < num_pairs)
+                {
+                    mirrored_won[cell] = simulate_game_multiplayer(config, seats, mirrored, params, turns, final_rows, final_hands);
+                    mirrored_cards[cell] = turns;
+                }
+            }
+        }
+    });
+
+    ControlStatistics known = control_means(config, config.number_of_players);
+    std::cout << "\n--- Variance reduction (" << num_games << " games per strategy and estimator, seed " << seed << ") ---\n";
+    if (control)
+    {
+        std::cout << "Control statistics, sample mean / exact mean:";
+        for (int c = 0; c < NUM_CONTROLS; ++c)
+        {
+            double mean = 0.0;
+            for (const auto &stats : statistics)
+            {
+                mean += stats.values[c] / num_games;
+            }
+            std::cout << (c ? "," : "") << " " << CONTROL_NAMES[c] << " " << std::fixed << std::setprecision(3) << mean << " / " << known.values[c];
+        }
+        std::cout << "\n";
+    }
+
+    for (int metric = 0; metric < 2; ++metric)
+    {
+        const std::vector<double> &y_all = metric == 0 ? won : cards;
+        const std::vector<double> &m_all = metric == 0 ? mirrored_won : mirrored_cards;
+        double scale = metric == 0 ? 100.0 : 1.0;
+        int precision = 2;
+        std::cout << "\n" << (metric == 0 ? "Win rate (%)" : "Cards played") << "\n";
+        std::cout << std::left << std::setw(10) << "Strategy" << std::setw(18) << "Plain";
+        if (antithetic)
+            std::cout << std::setw(18) << "Antithetic" << std::right << std::setw(6) << "corr" << std::setw(8) << "gain" << "  " << std::left;
+        if (control)
+            std::cout << std::setw(18) << "Control" << std::right << std::setw(6) << "R2" << std::setw(8) << "gain";
+        std::cout << std::right << "\n";
+
+        for (int s = 0; s < num_strategies; ++s)
+        {
+            std::vector<double> y(num_games), mirrored(num_pairs);
+            for (int g = 0; g < num_games; ++g)
+            {
+                y[g] = y_all[static_cast<size_t>(g) * num_strategies + s];
+            }
+            for (int g = 0; g < num_pairs; ++g)
+            {
+                mirrored[g] = m_all[static_cast<size_t>(g) * num_strategies + s];
+            }
+            std::cout << std::left << std::setw(10) << list[s].first << std::setw(18) << format_estimate(plain_estimate(y), scale, precision);
+            if (antithetic)
+            {
+                Estimate e = antithetic_estimate(y, mirrored);
+                std::cout << std::setw(18) << format_estimate(e, scale, precision) << std::right << std::setw(14) << format_gain(e) << "  " << std::left;
+            }
+            if (control)
+            {
+                Estimate e = control_estimate(y, statistics, known);
+                std::cout << std::setw(18) << format_estimate(e, scale, precision) << std::right << std::setw(14) << format_gain(e);
+            }
+            std::cout << std::right << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef VARIANCE_REDUCTION_H
+#define VARIANCE_REDUCTION_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "game_config.h"
+#include "game_logic.h"
+#include "player_strategies.h"
+
+// Estimators the `variance` mode reports next to the plain Monte Carlo estimate
+enum class VarianceEstimator
+{
+    ANTITHETIC, // Deck pairs: a deck and its value-mirrored counterpart with the seat order reversed
+    CONTROL,    // Regression on deck statistics whose means are known exactly
+    BOTH
+};
+
+GameSetup antithetic_setup(const GameConfig &config, const GameSetup &setup);
+int run_variance_estimators(const GameConfig &config, const std::map<std::string, StrategyFunction> &strategies, VarianceEstimator estimator, int num_games,
+                            uint64_t seed, int num_threads);
+
+#endif
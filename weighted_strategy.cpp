@@ -0,0 +1,239 @@
+#include "weighted_strategy.h"
+#include "helper_functions.h"
+#include "game_config.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+// Strategy B: closest card, reverse tricks never played
+const FeatureWeights WEIGHTS_B = {-1.0, 0.0, 0.0, 0.0, 0.0, 0.0, false};
+// Strategy C: keep as many cards playable as possible
+const FeatureWeights WEIGHTS_C = {0.0, 0.0, 1.0, 0.0, 0.0, 0.0, true};
+// Strategy D: closest card, but keep own cards in front of the row tops (was: ascending rows first, smallest max card left)
+const FeatureWeights WEIGHTS_D = {-1.0, 0.0, 0.0, 0.0, -3.0, 0.0, true};
+// Strategy F: keep the smallest gap between the hand and the rows as large as possible
+const FeatureWeights WEIGHTS_F = {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, true};
+// Strategy G: 0.2 x A (closeness) + 0.5 x C (playability) + 0.3 x F (gap)
+const FeatureWeights WEIGHTS_G = {-0.2, -0.2, 0.5, 0.3, 0.0, 0.0, true};
+// Strategy I: keep as few own cards behind the row tops as possible (was: 1/100 blocking count), prefer reverse tricks
+const FeatureWeights WEIGHTS_I = {-1.0, 20.0, 0.0, 0.0, -1.0, 0.0, true};
+
+namespace {
+
+const int NO_GAP = std::numeric_limits<int>::max(); // Gap of a card that cannot go on a row
+
+// Resizes every array of the grid for a hand x rows decision (storage is reused between calls).
+void prepare_grid(FeatureGrid &grid, int num_cards, int num_rows)
+{
+    size_t size = static_cast<size_t>(num_cards) * num_rows;
+    grid.num_cards = num_cards;
+    grid.num_rows = num_rows;
+    grid.valid_move.resize(size);
+    grid.distance.resize(size);
+    grid.reverse_trick.resize(size);
+    grid.playable_after.assign(size, 0);
+    grid.min_gap.assign(size, 0);
+    grid.blocking.assign(size, 0);
+    grid.claimed_row.resize(size);
+    grid.score.resize(size);
+}
+
+} // namespace
+
+/**
+ * @brief Computes every feature of every (card, row) pair of the hand in one pass over the grid.
+ *
+ * The validity of each pair comes from the engine's per-turn cache. The
+ * lookahead features only need the evaluations of the current rows plus the
+ * hand against the played card (the new top of its row): per row, the two
+ * smallest gaps are kept so that "minimum gap without card i" is O(1).
+ * Features whose weight is zero are skipped.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications What the players announced this turn.
+ * @param player_id The id of the deciding player (own announcements are ignored).
+ * @param context The strategy context handed over by the engine.
+ * @param weights The feature weights (also tell which features are needed).
+ * @param grid (Output) The features and weighted scores.
+ */
+void compute_move_features(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context, const FeatureWeights &weights, FeatureGrid &grid)
+{
+    const int num_cards = hand.size();
+    const int num_rows = context.config.number_of_rows;
+    prepare_grid(grid, num_cards, num_rows);
+
+    uint32_t claimed_rows = 0; // Bit r set = another player announced something on row r
+    for (const auto &comm : communications)
+    {
+        if (comm.player_id != player_id)
+        {
+            claimed_rows |= 1u << comm.row_index;
+        }
+    }
+
+    // --- Pass 1: validity, distance, reverse trick and claims of every pair ---
+    RowMasks playable_rows(num_cards, 0, context.memory);
+    for (int i = 0; i < num_cards; ++i)
+    {
+        for (int j = 0; j < num_rows; ++j)
+        {
+            int index = i * num_rows + j;
+            int row_top = playing_rows[j].back();
+            ValidMove valid_move = evaluate_move(context, hand[i], j, row_top);
+            grid.valid_move[index] = valid_move;
+            grid.reverse_trick[index] = valid_move == ValidMove::REVERSE_MOVE;
+            grid.distance[index] = grid.reverse_trick[index] ? -1 : std::abs(hand[i] - row_top);
+            grid.claimed_row[index] = ((claimed_rows >> j) & 1u) && grid.distance[index] > context.params.good_move_window;
+            if (valid_move != ValidMove::NO)
+            {
+                playable_rows[i] |= 1u << j;
+            }
+        }
+    }
+
+    bool need_lookahead = weights.playable_after != 0.0 || weights.min_gap != 0.0 || weights.blocking != 0.0;
+    if (need_lookahead)
+    {
+        // Two smallest gaps of each row over the hand, to drop the played card in O(1)
+        std::pmr::vector<int> smallest_gap(num_rows, NO_GAP, context.memory), second_gap(num_rows, NO_GAP, context.memory), smallest_card(num_rows, -1, context.memory);
+        for (int j = 0; j < num_rows; ++j)
+        {
+            for (int k = 0; k < num_cards; ++k)
+            {
+                int gap = grid.valid_move[k * num_rows + j] == ValidMove::NO ? NO_GAP : grid.distance[k * num_rows + j];
+                if (gap < smallest_gap[j])
+                {
+                    second_gap[j] = smallest_gap[j];
+                    smallest_gap[j] = gap;
+                    smallest_card[j] = k;
+                }
+                else if (gap < second_gap[j])
+                {
+                    second_gap[j] = gap;
+                }
+            }
+        }
+
+        // --- Pass 2: lookahead features of every legal pair ---
+        for (int i = 0; i < num_cards; ++i)
+        {
+            for (int j = 0; j < num_rows; ++j)
+            {
+                int index = i * num_rows + j;
+                if (grid.valid_move[index] == ValidMove::NO)
+                {
+                    continue;
+                }
+                bool is_ascending = j < num_rows / 2;
+
+                // Rows other than j keep their top: take their best gap without card i
+                int min_gap = context.config.card_max_number * 2;
+                for (int r = 0; r < num_rows; ++r)
+                {
+                    int gap = smallest_card[r] == i ? second_gap[r] : smallest_gap[r];
+                    if (r != j && gap < min_gap)
+                    {
+                        min_gap = gap;
+                    }
+                }
+
+                int playable_after = 0, blocking = 0;
+                for (int k = 0; k < num_cards; ++k)
+                {
+                    if (k == i)
+                    {
+                        continue;
+                    }
+                    // Row j now has hand[i] on top
+                    ValidMove after = is_valid_move(context.config, hand[k], hand[i], is_ascending);
+                    if (after != ValidMove::NO)
+                    {
+                        int gap = after == ValidMove::REVERSE_MOVE ? -1 : std::abs(hand[k] - hand[i]);
+                        min_gap = std::min(min_gap, gap);
+                    }
+                    playable_after += (playable_rows[k] & ~(1u << j)) != 0 || after != ValidMove::NO;
+                    blocking += is_ascending ? hand[k] < hand[i] : hand[k] > hand[i];
+                }
+                grid.playable_after[index] = playable_after;
+                grid.min_gap[index] = min_gap;
+                grid.blocking[index] = blocking;
+            }
+        }
+    }
+
+    // --- Pass 3: weighted score of every pair ---
+    for (int index = 0; index < num_cards * num_rows; ++index)
+    {
+        grid.score[index] = weights.distance * grid.distance[index] + weights.reverse_trick * grid.reverse_trick[index] +
+                            weights.playable_after * grid.playable_after[index] + weights.min_gap * grid.min_gap[index] +
+                            weights.blocking * grid.blocking[index] + weights.claimed_row * grid.claimed_row[index];
+    }
+}
+
+/**
+ * @brief Generic strategy: plays the legal (card, row) pair with the highest weighted feature score.
+ *
+ * @param hand The player's current hand of cards.
+ * @param playing_rows The current state of the playing rows.
+ * @param communications What the players announced this turn.
+ * @param player_id The id of the deciding player.
+ * @param context The strategy context handed over by the engine.
+ * @param weights The feature weights.
+ * @return A pair containing the best card index and the row index, or {-1, -1} if no valid move.
+ */
+std::pair<int, int> get_player_move_weighted(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context, const FeatureWeights &weights)
+{
+    static thread_local FeatureGrid grid; // Reused between decisions of this thread
+    compute_move_features(hand, playing_rows, communications, player_id, context, weights, grid);
+
+    int best_index = -1;
+    for (int index = 0; index < grid.num_cards * grid.num_rows; ++index)
+    {
+        if (grid.valid_move[index] == ValidMove::NO || (!weights.reverse_allowed && grid.reverse_trick[index]))
+        {
+            continue;
+        }
+        if (best_index == -1 || grid.score[index] > grid.score[best_index])
+        {
+            best_index = index;
+        }
+    }
+    if (best_index == -1)
+    {
+        return {-1, -1};
+    }
+    return {best_index / grid.num_rows, best_index % grid.num_rows};
+}
+
+std::pair<int, int> get_player_move_B(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_B);
+}
+
+std::pair<int, int> get_player_move_C(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_C);
+}
+
+std::pair<int, int> get_player_move_D(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_D);
+}
+
+std::pair<int, int> get_player_move_F(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_F);
+}
+
+std::pair<int, int> get_player_move_G(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_G);
+}
+
+std::pair<int, int> get_player_move_I(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context)
+{
+    return get_player_move_weighted(hand, playing_rows, communications, player_id, context, WEIGHTS_I);
+}
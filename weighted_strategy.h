@@ -0,0 +1,55 @@
+#ifndef WEIGHTED_STRATEGY_H
+#define WEIGHTED_STRATEGY_H
+
+#include <utility>
+#include <vector>
+
+#include "player_strategies.h"
+
+// Weights of the per-(card, row) features; the legal move with the highest
+// weighted sum is played (ties go to the first card, then the first row).
+struct FeatureWeights
+{
+    double distance;       // |card - row top|, -1 for a reverse trick
+    double reverse_trick;  // 1 if the move is a reverse trick
+    double playable_after; // Other cards of the hand still playable after the move
+    double min_gap;        // Smallest gap left between a remaining card and any row top (-1 if a reverse trick remains)
+    double blocking;       // Other cards of the hand left behind the new row top (no longer playable on the row)
+    double claimed_row;    // 1 if another player claimed the row and the move is not a good one
+    bool reverse_allowed;  // False to never play reverse tricks
+};
+
+// Per-(card, row) features of one decision, laid out as flat arrays indexed by card * rows + row.
+struct FeatureGrid
+{
+    int num_cards = 0;
+    int num_rows = 0;
+    std::vector<ValidMove> valid_move;
+    std::vector<int> distance;
+    std::vector<int> reverse_trick;
+    std::vector<int> playable_after;
+    std::vector<int> min_gap;
+    std::vector<int> blocking;
+    std::vector<int> claimed_row;
+    std::vector<double> score;
+};
+
+void compute_move_features(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context, const FeatureWeights &weights, FeatureGrid &grid);
+std::pair<int, int> get_player_move_weighted(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context, const FeatureWeights &weights);
+
+// Presets reviving the strategies kept in excluded_strategies.txt
+extern const FeatureWeights WEIGHTS_B;
+extern const FeatureWeights WEIGHTS_C;
+extern const FeatureWeights WEIGHTS_D;
+extern const FeatureWeights WEIGHTS_F;
+extern const FeatureWeights WEIGHTS_G;
+extern const FeatureWeights WEIGHTS_I;
+
+std::pair<int, int> get_player_move_B(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_C(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_D(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_F(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_G(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+std::pair<int, int> get_player_move_I(const Hand &hand, const PlayingRows &playing_rows, const Communications &communications, int player_id, const StrategyContext &context);
+
+#endif
@@ -0,0 +1,129 @@
+#include "win_summary.h"
+
+#include <fstream>
+
+/**
+ * @brief Prepares an empty summary for the given strategies.
+ *
+ * @param summary (Output) The summary to initialise.
+ * @param num_players The number of players of the run.
+ * @param strategy_names The strategies, in the order their outcomes will be added.
+ */
+void init_win_summary(WinSummary &summary, int num_players, const std::vector<std::string> &strategy_names)
+{
+    size_t num_strategies = strategy_names.size();
+    summary = WinSummary();
+    summary.num_players = num_players;
+    summary.strategy_names = strategy_names;
+    summary.wins.assign(num_strategies, 0);
+    summary.lost_games.assign(num_strategies, 0);
+    summary.lost_turns.assign(num_strategies, 0);
+    summary.lost_deck_size.assign(num_strategies, 0);
+}
+
+/**
+ * @brief Adds the outcomes of every strategy on one deck.
+ *
+ * The strategies that won the deck form a bitmask, which is counted in the
+ * combination histogram (all bits clear: no strategy won). Only the masks
+ * that occur get a bin, so any number of strategies can be tracked.
+ *
+ * @param summary The summary to update.
+ * @param outcomes One outcome per strategy, in the order of summary.strategy_names.
+ */
+void add_deck_outcomes(WinSummary &summary, const std::vector<StrategyOutcome> &outcomes)
+{
+    WinnerMask mask((outcomes.size() + 63) / 64, 0);
+    for (size_t s = 0; s < outcomes.size(); ++s)
+    {
+        if (outcomes[s].won)
+        {
+            mask[s / 64] |= uint64_t{1} << (s % 64);
+            summary.wins[s]++;
+        }
+        else
+        {
+            summary.lost_games[s]++;
+            summary.lost_turns[s] += outcomes[s].turns;
+            summary.lost_deck_size[s] += outcomes[s].deck_size;
+        }
+    }
+    summary.combination_counts[mask]++;
+    summary.num_decks++;
+}
+
+/**
+ * @brief Adds the counts of another summary of the same strategies (e.g. another thread's).
+ *
+ * @param summary The summary to update.
+ * @param other The summary to add.
+ */
+void merge_win_summary(WinSummary &summary, const WinSummary &other)
+{
+    for (size_t s = 0; s < summary.strategy_names.size(); ++s)
+    {
+        summary.wins[s] += other.wins[s];
+        summary.lost_games[s] += other.lost_games[s];
+        summary.lost_turns[s] += other.lost_turns[s];
+        summary.lost_deck_size[s] += other.lost_deck_size[s];
+    }
+    for (const auto &[mask, count] : other.combination_counts)
+    {
+        summary.combination_counts[mask] += count;
+    }
+    summary.num_decks += other.num_decks;
+}
+
+/**
+ * @brief Writes the summary as a small text file.
+ *
+ * Format, one record per line:
+ *   players <n>
+ *   decks <n>
+ *   strategy <name> <wins> <lost games> <average turns when losing> <average deck size when losing>
+ *   combination <name+name+...|none> <decks>
+ * Only the combinations that occurred are written.
+ *
+ * @param summary The summary to write.
+ * @param filename The output file.
+ * @param error (Output) Why the file could not be written, if it could not.
+ * @return True on success, false otherwise.
+ */
+bool write_win_summary(const WinSummary &summary, const std::string &filename, std::string &error)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        error = "cannot open " + filename + " for writing";
+        return false;
+    }
+
+    out << "players " << summary.num_players << "\n";
+    out << "decks " << summary.num_decks << "\n";
+    for (size_t s = 0; s < summary.strategy_names.size(); ++s)
+    {
+        long long lost = summary.lost_games[s];
+        out << "strategy " << summary.strategy_names[s] << " " << summary.wins[s] << " " << lost << " "
+            << (lost > 0 ? static_cast<double>(summary.lost_turns[s]) / lost : 0.0) << " "
+            << (lost > 0 ? static_cast<double>(summary.lost_deck_size[s]) / lost : 0.0) << "\n";
+    }
+    for (const auto &[mask, count] : summary.combination_counts)
+    {
+        std::string names;
+        for (size_t s = 0; s < summary.strategy_names.size(); ++s)
+        {
+            if ((mask[s / 64] >> (s % 64)) & 1u)
+            {
+                names += (names.empty() ? "" : "+") + summary.strategy_names[s];
+            }
+        }
+        out << "combination " << (names.empty() ? "none" : names) << " " << count << "\n";
+    }
+
+    if (!out)
+    {
+        error = "write to " + filename + " failed";
+        return false;
+    }
+    return true;
+}
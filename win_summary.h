@@ -0,0 +1,39 @@
+#ifndef WIN_SUMMARY_H
+#define WIN_SUMMARY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Set of strategies that won a deck: bit s (word s / 64) is strategy_names[s]
+using WinnerMask = std::vector<uint64_t>;
+
+// Aggregates of one simulate run (one player count), filled deck by deck.
+// This is what game_analysis.py used to rebuild from the per-game CSV.
+struct WinSummary
+{
+    int num_players = 0;
+    long long num_decks = 0;
+    std::vector<std::string> strategy_names;   // Bit s of a combination mask is strategy_names[s]
+    std::vector<long long> wins;               // Per strategy
+    std::vector<long long> lost_games;         // Per strategy
+    std::vector<long long> lost_turns;         // Per strategy, sum of cards played in lost games
+    std::vector<long long> lost_deck_size;     // Per strategy, sum of cards left in the deck in lost games
+    std::map<WinnerMask, long long> combination_counts; // Decks per exact set of winning strategies (only sets that occurred)
+};
+
+// Outcome of one strategy on one deck
+struct StrategyOutcome
+{
+    bool won;
+    int turns;     // Cards played
+    int deck_size; // Cards left in the draw pile
+};
+
+void init_win_summary(WinSummary &summary, int num_players, const std::vector<std::string> &strategy_names);
+void add_deck_outcomes(WinSummary &summary, const std::vector<StrategyOutcome> &outcomes);
+void merge_win_summary(WinSummary &summary, const WinSummary &other);
+bool write_win_summary(const WinSummary &summary, const std::string &filename, std::string &error);
+
+#endif